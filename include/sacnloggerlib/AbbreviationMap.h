@@ -22,9 +22,12 @@
 #ifndef ABBREVIATIONMAP_H
 #define ABBREVIATIONMAP_H
 
+#include <array>
+#include <cstdint>
+#include <deque>
 #include <etcpal/cpp/uuid.h>
-#include <string>
-#include <unordered_map>
+#include <string_view>
+#include <vector>
 
 namespace sacnlogger
 {
@@ -33,15 +36,49 @@ namespace sacnlogger
      * Store an increasing abbreviation for a given UUID.
      *
      * Starts with `A`, followed by `B`, `C`, ..., `Z`, `AA`, `AB`, ...
+     *
+     * Looking up a UUID that has already been seen never allocates.
      */
     class AbbreviationMap
     {
     public:
-        std::string abbreviationForUuid(const etcpal::Uuid& cid);
+        /** Abbreviation text, with the length stored in the last byte. */
+        using Abbreviation = std::array<char, 8>;
+
+        /**
+         * @return The abbreviation, which stays valid for the lifetime of this map.
+         */
+        std::string_view abbreviationForUuid(const etcpal::Uuid& cid);
+
+        /**
+         * Number of UUIDs that have been assigned an abbreviation.
+         */
+        [[nodiscard]] std::size_t size() const { return abbreviations_.size(); }
+
+        /**
+         * The abbreviation given to the @p index'th UUID (counting from 0).
+         */
+        static Abbreviation abbreviationForIndex(std::size_t index);
 
     private:
-        std::unordered_map<etcpal::Uuid, std::string> abbreviations_;
-        std::string nextAbbreviation_ = "A";
+        static constexpr uint32_t kEmpty = UINT32_MAX;
+
+        struct Slot
+        {
+            etcpal::Uuid cid;
+            uint32_t index = kEmpty;
+        };
+
+        /**
+         * Find the slot holding @p cid, or the empty slot it belongs in.
+         */
+        [[nodiscard]] Slot& findSlot(const etcpal::Uuid& cid);
+        void grow();
+
+        /** Open addressing with linear probing; the size is always a power of 2. */
+        std::vector<Slot> slots_;
+        /** Deque elements don't move, so views into them remain valid. */
+        std::deque<Abbreviation> abbreviations_;
     };
 
 } // namespace sacnlogger
@@ -0,0 +1,100 @@
+/**
+ * @file BufferPool.h
+ *
+ * @author Dan Keenan
+ * @date 10/17/26
+ * @copyright GPL-3.0-or-later
+ * Copyright (C) 2024-2026 Dan Keenan
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef BUFFERPOOL_H
+#define BUFFERPOOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace sacnlogger
+{
+    /**
+     * Fixed number of fixed-size memory blocks, allocated once and recycled.
+     *
+     * Thread-safe.
+     */
+    class BufferPool
+    {
+    public:
+        struct Block
+        {
+            [[nodiscard]] std::size_t available() const { return capacity - size; }
+
+            char* data;
+            std::size_t capacity;
+            /** Number of bytes in use. */
+            std::size_t size = 0;
+        };
+
+        BufferPool(std::size_t blockCount, std::size_t blockSize);
+
+        BufferPool(const BufferPool&) = delete;
+        BufferPool& operator=(const BufferPool&) = delete;
+
+        [[nodiscard]] std::size_t blockCount() const { return blocks_.size(); }
+        [[nodiscard]] std::size_t blockSize() const { return blockSize_; }
+
+        /**
+         * The memory all of the blocks are in, e.g. to register it with the kernel.
+         */
+        [[nodiscard]] char* storage() const { return storage_.get(); }
+        [[nodiscard]] std::size_t storageSize() const { return blocks_.size() * blockSize_; }
+
+        /**
+         * Take an empty block, waiting for one to be released if none are free.
+         *
+         * @param reserve Leave at least this many blocks free for other callers.
+         */
+        [[nodiscard]] Block* acquire(std::size_t reserve = 0);
+
+        /**
+         * Take an empty block.
+         *
+         * @param reserve Leave at least this many blocks free for other callers.
+         * @return The block, or nullptr if none are free.
+         */
+        [[nodiscard]] Block* tryAcquire(std::size_t reserve = 0);
+
+        /**
+         * Return a block taken with acquire() or tryAcquire().
+         */
+        void release(Block* block);
+
+        /**
+         * Number of blocks that are not in use.
+         */
+        [[nodiscard]] std::size_t freeCount() const;
+
+    private:
+        std::size_t blockSize_;
+        std::unique_ptr<char[]> storage_;
+        std::vector<Block> blocks_;
+        mutable std::mutex mutex_;
+        std::condition_variable blockReleased_;
+        std::vector<Block*> free_;
+    };
+} // namespace sacnlogger
+
+#endif // BUFFERPOOL_H
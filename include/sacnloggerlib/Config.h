@@ -30,6 +30,7 @@
 #include <nlohmann/json_fwd.hpp>
 #include <string>
 #include <vector>
+#include "LogConfig.h"
 #ifdef SACNLOGGER_SYSTEM_CONFIG
 #include "SystemConfig.h"
 #endif
@@ -50,6 +51,7 @@ namespace sacnlogger
 #ifdef SACNLOGGER_SYSTEM_CONFIG
         SystemConfig systemConfig;
 #endif
+        LogConfig logConfig;
 
         static Config loadFromFile(const std::string& filename);
         void saveToFile(const std::string& filename) const;
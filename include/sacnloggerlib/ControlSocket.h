@@ -0,0 +1,82 @@
+/**
+ * @file ControlSocket.h
+ *
+ * @author Dan Keenan
+ * @date 10/17/26
+ * @copyright GPL-3.0-or-later
+ * Copyright (C) 2024-2026 Dan Keenan
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef CONTROLSOCKET_H
+#define CONTROLSOCKET_H
+
+#include <boost/signals2/signal.hpp>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string_view>
+#include <thread>
+
+namespace sacnlogger
+{
+    /**
+     * Take commands from a Unix datagram socket, one per datagram, e.g.
+     * `echo dump 3 | socat - UNIX-SENDTO:/run/sacnlogger/control`.
+     *
+     * Commands:
+     * - `dump [universe]`: Write out the flight recorder for @p universe, or for every universe.
+     */
+    class ControlSocket
+    {
+    public:
+        /**
+         * Listen at @p path, replacing anything already there.
+         *
+         * Failing to listen is logged, and leaves the socket without commands.
+         */
+        explicit ControlSocket(std::filesystem::path path);
+
+        /**
+         * Stop listening, and remove the socket.
+         */
+        ~ControlSocket();
+
+        ControlSocket(const ControlSocket&) = delete;
+        ControlSocket& operator=(const ControlSocket&) = delete;
+
+        [[nodiscard]] const std::filesystem::path& path() const { return path_; }
+        [[nodiscard]] bool listening() const { return fd_ >= 0; }
+
+        /**
+         * Parse and act on @p command. Called from the worker thread for each datagram.
+         */
+        void handle(std::string_view command);
+
+        /**
+         * Emitted from the worker thread for `dump`, with the universe if one was given.
+         */
+        boost::signals2::signal<void(std::optional<uint16_t> universe)> sigDump;
+
+    private:
+        void run(std::stop_token stopToken);
+
+        std::filesystem::path path_;
+        int fd_ = -1;
+        /** Must be last, so everything above exists while it runs. */
+        std::jthread worker_;
+    };
+} // namespace sacnlogger
+
+#endif // CONTROLSOCKET_H
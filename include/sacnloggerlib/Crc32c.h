@@ -0,0 +1,38 @@
+/**
+ * @file Crc32c.h
+ *
+ * @author Dan Keenan
+ * @date 10/17/26
+ * @copyright GPL-3.0-or-later
+ * Copyright (C) 2024-2026 Dan Keenan
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef CRC32C_H
+#define CRC32C_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace sacnlogger
+{
+    /**
+     * CRC-32C (Castagnoli) of @p size bytes at @p data.
+     *
+     * @param crc Result for the data before this, to checksum something written in pieces.
+     */
+    [[nodiscard]] uint32_t crc32c(const void* data, std::size_t size, uint32_t crc = 0);
+} // namespace sacnlogger
+
+#endif // CRC32C_H
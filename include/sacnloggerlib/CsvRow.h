@@ -21,29 +21,103 @@
 
 #ifndef CSVROW_H
 #define CSVROW_H
-#include <sstream>
+
+#include <array>
+#include <charconv>
+#include <concepts>
+#include <cstdint>
+#include <string>
+#include <string_view>
 
 namespace sacnlogger
 {
     /**
      * Store data in CSV format.
+     *
+     * The row is built in a single buffer that keeps its capacity across clear(), so a row that is reused does not
+     * allocate once it has grown to its working size.
      */
     class CsvRow
     {
     public:
-        CsvRow& operator<<(const std::string& val);
+        /**
+         * @param capacity Bytes to reserve up front.
+         */
+        explicit CsvRow(std::size_t capacity = 0) { buffer_.reserve(capacity); }
+
+        CsvRow& operator<<(std::string_view val);
+
+        CsvRow& operator<<(uint8_t val)
+        {
+            const auto& text = kByteText[val];
+            buffer_.append(text.data(), text.back());
+            buffer_.push_back(',');
+            return *this;
+        }
 
         template <std::integral T>
         CsvRow& operator<<(T val)
         {
-            stream_ << val << ',';
+            if constexpr (std::same_as<T, bool>)
+            {
+                buffer_.push_back(val ? '1' : '0');
+            }
+            else if constexpr (std::same_as<T, char>)
+            {
+                buffer_.push_back(val);
+            }
+            else
+            {
+                std::array<char, 24> text;
+                const auto result = std::to_chars(text.data(), text.data() + text.size(), val);
+                buffer_.append(text.data(), result.ptr);
+            }
+            buffer_.push_back(',');
             return *this;
         }
 
-        std::string string() const;
+        /**
+         * The row contents, valid until the row is next modified.
+         */
+        [[nodiscard]] std::string_view view() const
+        {
+            // Drop the trailing separator.
+            return buffer_.empty() ? std::string_view() : std::string_view(buffer_.data(), buffer_.size() - 1);
+        }
+
+        [[nodiscard]] std::string string() const { return std::string(view()); }
+
+        /**
+         * Remove all fields, keeping the allocated buffer.
+         */
+        void clear() { buffer_.clear(); }
 
     private:
-        std::stringstream stream_;
+        /**
+         * Decimal text for every byte value. The last element holds the text length.
+         */
+        static constexpr auto kByteText = []()
+        {
+            std::array<std::array<char, 4>, 256> r{};
+            for (unsigned int val = 0; val < r.size(); ++val)
+            {
+                auto& text = r[val];
+                char len = 0;
+                if (val >= 100)
+                {
+                    text[len++] = static_cast<char>('0' + val / 100);
+                }
+                if (val >= 10)
+                {
+                    text[len++] = static_cast<char>('0' + (val / 10) % 10);
+                }
+                text[len++] = static_cast<char>('0' + val % 10);
+                text.back() = len;
+            }
+            return r;
+        }();
+
+        std::string buffer_;
     };
 } // namespace sacnlogger
 
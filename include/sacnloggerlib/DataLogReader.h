@@ -0,0 +1,62 @@
+/**
+ * @file DataLogReader.h
+ *
+ * @author Dan Keenan
+ * @date 10/17/26
+ * @copyright GPL-3.0-or-later
+ * Copyright (C) 2024-2026 Dan Keenan
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATALOGREADER_H
+#define DATALOGREADER_H
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <spdlog/common.h>
+#include <string>
+#include <vector>
+
+namespace sacnlogger
+{
+    /**
+     * Levels, priorities, and owners of a universe, as recorded in a CSV data log.
+     */
+    struct UniverseState
+    {
+        /** Time of the last row that applies. */
+        spdlog::log_clock::time_point time;
+        std::vector<uint8_t> levels;
+        std::vector<uint8_t> priorities;
+        /** Owner abbreviations, as in the source log. */
+        std::vector<std::string> owners;
+        /** Source names by abbreviation. Every keyframe restates the active sources, so these cover all owners. */
+        std::map<std::string, std::string> sourceNames;
+    };
+
+    /**
+     * Find what a universe was doing at @p time from its CSV data log.
+     *
+     * The time index is used to jump to the last keyframe before @p time, so only the delta rows after it are read.
+     * Logs without an index are read from the start. Compressed (`.zst`) logs are supported.
+     *
+     * @return The state, or std::nullopt if @p time is before the first row in the file.
+     */
+    [[nodiscard]] std::optional<UniverseState> readDataLogState(const std::filesystem::path& path,
+                                                                spdlog::log_clock::time_point time);
+} // namespace sacnlogger
+
+#endif // DATALOGREADER_H
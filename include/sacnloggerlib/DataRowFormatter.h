@@ -0,0 +1,136 @@
+/**
+ * @file DataRowFormatter.h
+ *
+ * @author Dan Keenan
+ * @date 10/17/26
+ * @copyright GPL-3.0-or-later
+ * Copyright (C) 2024-2026 Dan Keenan
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATAROWFORMATTER_H
+#define DATAROWFORMATTER_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include "CsvRow.h"
+#include "FrameDiff.h"
+#include "LogConfig.h"
+#include "OwnerTable.h"
+
+namespace sacnlogger
+{
+    /**
+     * Format universe data as rows for the data log.
+     *
+     * Full rows contain the level, priority, and owner of every slot up to the highest slot seen so far. Delta rows
+     * contain one `address:level:priority:owner` field for each slot that has changed since the previous row.
+     *
+     * Source rows give the details of the source behind an owner abbreviation, so each file can be read on its own.
+     * Recovery rows note that logging restarted after a torn end of the file was removed. Dropped rows note that
+     * OverflowPolicy::DropOldest discarded whole rows since the row before. These three are only written with
+     * LogConfig::selfContained.
+     */
+    class DataRowFormatter
+    {
+    public:
+        /** First field of a source row. */
+        static constexpr std::string_view kSourceMarker = "Source";
+        /** First field of a recovery row. */
+        static constexpr std::string_view kRecoveryMarker = "Recovered";
+        /** First field of a dropped row. */
+        static constexpr std::string_view kDroppedMarker = "Dropped";
+
+        explicit DataRowFormatter(const LogConfig& logConfig = {}) :
+            deltaRows_(logConfig.deltaRows), checkpointInterval_(logConfig.checkpointInterval)
+        {
+        }
+
+        /**
+         * Column names for full rows covering the first @p slotCount slots.
+         */
+        [[nodiscard]] static std::string header(std::size_t slotCount);
+
+        /**
+         * Column names for the rows currently being formatted.
+         */
+        [[nodiscard]] std::string header() const { return header(slotCount_); }
+
+        /**
+         * Source row for the source abbreviated @p abbreviation.
+         */
+        [[nodiscard]] static std::string sourceRow(std::string_view abbreviation, std::string_view cid,
+                                                   std::string_view ipAddr, std::string_view name);
+
+        /**
+         * Recovery row for @p removedBytes cut off the end of the file.
+         */
+        [[nodiscard]] static std::string recoveryRow(std::uintmax_t removedBytes);
+
+        /**
+         * Dropped row for @p droppedBytes discarded by the overflow policy.
+         */
+        [[nodiscard]] static std::string droppedRow(std::uintmax_t droppedBytes);
+
+        /**
+         * Number of slots in a full row.
+         */
+        [[nodiscard]] std::size_t slotCount() const { return slotCount_; }
+
+        /**
+         * Make full rows cover at least @p slotCount slots.
+         *
+         * @return TRUE if the rows were widened, in which case a new header must be logged. The next row will be a full
+         * row.
+         */
+        bool widen(std::size_t slotCount);
+
+        /**
+         * Format a row for @p data.
+         *
+         * @param changedSlots Slots that have changed since the previous row.
+         * @param owners Abbreviations for each active source handle.
+         * @return The formatted row, valid until the next call.
+         */
+        [[nodiscard]] std::string_view format(const ComparableData& data, const SlotMask& changedSlots,
+                                              const OwnerTable& owners);
+
+        /**
+         * Make the next row a full row.
+         */
+        void requestFullRow() { fullRowRequested_ = true; }
+
+        /**
+         * Check if the next row will be a full row.
+         */
+        [[nodiscard]] bool fullRowNext() const
+        {
+            return !deltaRows_ || fullRowRequested_ || deltaRowsSinceFull_ >= checkpointInterval_;
+        }
+
+        [[nodiscard]] bool deltaRows() const { return deltaRows_; }
+
+    private:
+        bool deltaRows_;
+        unsigned int checkpointInterval_;
+        unsigned int deltaRowsSinceFull_ = 0;
+        bool fullRowRequested_ = true;
+        std::size_t slotCount_ = 0;
+        /** Reused between rows; a full row is a little over 6kB. */
+        CsvRow row_{8192};
+    };
+} // namespace sacnlogger
+
+#endif // DATAROWFORMATTER_H
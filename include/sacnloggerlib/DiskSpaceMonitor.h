@@ -22,27 +22,71 @@
 #ifndef DISKSPACEMONITOR_H
 #define DISKSPACEMONITOR_H
 
+#include <atomic>
 #include <boost/signals2/signal.hpp>
+#include <chrono>
+#include <condition_variable>
 #include <filesystem>
 #include <mutex>
+#include <optional>
 #include <thread>
 
 namespace sacnlogger
 {
+    /**
+     * How long the space on a drive will last.
+     */
+    struct DiskSpaceForecast
+    {
+        /** Bytes available. */
+        std::uintmax_t available = 0;
+        /** Bytes per second being used by the logs, less what compressing and removing them frees. */
+        double writeRate = 0;
+        /** Time until the drive is full at writeRate, or nullopt if it isn't filling. */
+        std::optional<std::chrono::seconds> timeToFull;
+
+        /**
+         * Forecast for @p available bytes used at @p writeRate bytes per second.
+         */
+        [[nodiscard]] static DiskSpaceForecast make(std::uintmax_t available, double writeRate);
+    };
 
     /**
      * Monitor a path for available space.
+     *
+     * Writers report the bytes they write with addWritten(), and those that free space report it with addReclaimed()
+     * or addRemoved(). Each poll folds what was used since the last one into a moving average of the write rate, which
+     * gives how long the space will last. Signals are emitted when that falls below a time threshold, or when the space
+     * itself falls below a byte threshold, e.g. because something else filled the drive.
      */
     class DiskSpaceMonitor
     {
     public:
         explicit DiskSpaceMonitor(const std::filesystem::path& path = {});
 
+        /**
+         * Stop polling, without waiting for the next poll.
+         */
+        ~DiskSpaceMonitor();
+
+        /**
+         * Stop polling and wait for any signal being emitted to return, so nothing is signalled afterwards. Must not be
+         * called from a signal handler.
+         */
+        void stop();
+
+        DiskSpaceMonitor(const DiskSpaceMonitor&) = delete;
+        DiskSpaceMonitor& operator=(const DiskSpaceMonitor&) = delete;
+
         [[nodiscard]] const std::filesystem::path& path() const { return path_; }
         void setPath(const std::filesystem::path& path)
         {
-            std::scoped_lock lock(configMx_);
-            path_ = path;
+            {
+                std::scoped_lock lock(configMx_);
+                path_ = path;
+                pollNow_ = true;
+            }
+            configChanged_.notify_all();
         }
         [[nodiscard]] const std::uintmax_t& lowSpaceThreshold() const { return lowSpaceThreshold_; }
         void setLowSpaceThreshold(const std::uintmax_t& lowSpaceThreshold)
@@ -56,33 +100,99 @@ namespace sacnlogger
             std::scoped_lock lock(configMx_);
             criticalSpaceThreshold_ = criticalSpaceThreshold;
         }
-        [[nodiscard]] const std::chrono::seconds& pollPeriod() const { return pollPeriod_; }
-        void setPollPeriod(const std::chrono::seconds& pollPeriod)
+        [[nodiscard]] const std::chrono::minutes& lowTimeThreshold() const { return lowTimeThreshold_; }
+        void setLowTimeThreshold(const std::chrono::minutes& lowTimeThreshold)
+        {
+            std::scoped_lock lock(configMx_);
+            lowTimeThreshold_ = lowTimeThreshold;
+        }
+        [[nodiscard]] const std::chrono::minutes& criticalTimeThreshold() const { return criticalTimeThreshold_; }
+        void setCriticalTimeThreshold(const std::chrono::minutes& criticalTimeThreshold)
+        {
+            std::scoped_lock lock(configMx_);
+            criticalTimeThreshold_ = criticalTimeThreshold;
+        }
+        [[nodiscard]] const std::chrono::milliseconds& pollPeriod() const { return pollPeriod_; }
+        void setPollPeriod(const std::chrono::milliseconds& pollPeriod)
+        {
+            {
+                std::scoped_lock lock(configMx_);
+                pollPeriod_ = pollPeriod;
+                pollNow_ = true;
+            }
+            configChanged_.notify_all();
+        }
+        /**
+         * Roughly how far back the write rate looks.
+         */
+        [[nodiscard]] const std::chrono::seconds& rateWindow() const { return rateWindow_; }
+        void setRateWindow(const std::chrono::seconds& rateWindow)
         {
             std::scoped_lock lock(configMx_);
-            pollPeriod_ = pollPeriod;
+            rateWindow_ = rateWindow;
         }
 
-        using SigLowSpace = boost::signals2::signal<void(std::uintmax_t)>;
         /**
-         * Emitted when available space is between lowSpaceThreshold() and criticalSpaceThreshold().
+         * Count @p bytes written to logs. Safe to call from any thread.
+         */
+        void addWritten(std::uintmax_t bytes) { writtenBytes_.fetch_add(bytes, std::memory_order_relaxed); }
+        /**
+         * Total bytes written to logs.
+         */
+        [[nodiscard]] std::uintmax_t writtenBytes() const { return writtenBytes_.load(std::memory_order_relaxed); }
+        /**
+         * Count @p bytes freed by compressing logs. Safe to call from any thread.
+         */
+        void addReclaimed(std::uintmax_t bytes) { reclaimedBytes_.fetch_add(bytes, std::memory_order_relaxed); }
+        /**
+         * Total bytes freed by compressing logs.
+         */
+        [[nodiscard]] std::uintmax_t reclaimedBytes() const { return reclaimedBytes_.load(std::memory_order_relaxed); }
+        /**
+         * Count @p bytes freed by removing old logs. Safe to call from any thread.
+         */
+        void addRemoved(std::uintmax_t bytes) { removedBytes_.fetch_add(bytes, std::memory_order_relaxed); }
+
+        /**
+         * Forecast from the last poll. Safe to call from any thread.
+         */
+        [[nodiscard]] DiskSpaceForecast forecast() const;
+
+        using SigLowSpace = boost::signals2::signal<void(const DiskSpaceForecast&)>;
+        /**
+         * Emitted when the space will last less than lowTimeThreshold(), or is below lowSpaceThreshold(), but isn't
+         * critical.
          */
         SigLowSpace sigLowSpace;
 
-        using SigCriticalSpace = boost::signals2::signal<void(std::uintmax_t)>;
+        using SigCriticalSpace = boost::signals2::signal<void(const DiskSpaceForecast&)>;
         /**
-         * Emitted when available space is below criticalSpaceThreshold().
+         * Emitted when the space will last less than criticalTimeThreshold(), or is below criticalSpaceThreshold().
          */
         SigCriticalSpace sigCriticalSpace;
 
     private:
-        std::mutex configMx_;
+        void run(std::stop_token stopToken);
+
+        /** Guards the settings, which the worker copies each poll. */
+        mutable std::mutex configMx_;
+        std::condition_variable_any configChanged_;
+        /** Poll without waiting for the poll period, e.g. because the path has changed. */
+        bool pollNow_ = false;
         std::filesystem::path path_;
         std::uintmax_t lowSpaceThreshold_{1073741824}; // 1GiB
-        std::atomic<bool> lowSpaceMet_{false};
         std::uintmax_t criticalSpaceThreshold_{104857600}; // 100MiB;
+        std::chrono::minutes lowTimeThreshold_{60};
+        std::chrono::minutes criticalTimeThreshold_{10};
+        std::chrono::milliseconds pollPeriod_{10000};
+        std::chrono::seconds rateWindow_{60};
+        std::atomic<bool> lowSpaceMet_{false};
         std::atomic<bool> criticalSpaceMet_{false};
-        std::chrono::seconds pollPeriod_{10};
+        std::atomic<std::uintmax_t> writtenBytes_{0};
+        std::atomic<std::uintmax_t> reclaimedBytes_{0};
+        std::atomic<std::uintmax_t> removedBytes_{0};
+        DiskSpaceForecast forecast_;
+        /** Must be last, so everything above exists while it runs. */
         std::jthread worker_;
     };
 
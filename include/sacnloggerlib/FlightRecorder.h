@@ -0,0 +1,176 @@
+/**
+ * @file FlightRecorder.h
+ *
+ * @author Dan Keenan
+ * @date 10/17/26
+ * @copyright GPL-3.0-or-later
+ * Copyright (C) 2024-2026 Dan Keenan
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef FLIGHTRECORDER_H
+#define FLIGHTRECORDER_H
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <spdlog/common.h>
+#include <vector>
+#include "FrameDiff.h"
+#include "SacnLogEncoder.h"
+#include "SacnLogFormat.h"
+
+namespace sacnlogger
+{
+    /**
+     * Keep the last few minutes of a universe in memory, and write them out only when asked.
+     *
+     * Frames are kept in a ring buffer that is allocated up front, so memory use never changes. The oldest frames are
+     * dropped when the buffer is full, or once they are older than the window. Every frame holds the whole universe,
+     * so the oldest one kept always says what the universe looked like at the start of the window, even if nothing
+     * has changed since.
+     *
+     * dump() writes what is in the buffer as a `.sacnlog` file that can be read on its own.
+     */
+    class FlightRecorder
+    {
+    public:
+        static constexpr std::size_t kRecordHeaderSize = 16;
+        /** Level, priority and owner. */
+        static constexpr std::size_t kBytesPerSlot = 2 * sizeof(uint8_t) + sizeof(uint16_t);
+        /** Smallest buffer, which holds one full universe. */
+        static constexpr std::size_t kMinCapacity =
+            sacnlog::padded(kRecordHeaderSize + SACN_MERGE_RECEIVER_MAX_SLOTS * kBytesPerSlot);
+
+        /**
+         * Bytes that a frame of @p slotCount slots uses in the buffer.
+         */
+        static constexpr std::size_t recordSize(std::size_t slotCount)
+        {
+            return sacnlog::padded(kRecordHeaderSize + slotCount * kBytesPerSlot);
+        }
+
+        /**
+         * @param capacity Bytes to keep frames in, raised to kMinCapacity if needed.
+         * @param window Drop frames older than this.
+         */
+        FlightRecorder(uint16_t universe, std::size_t capacity, std::chrono::seconds window);
+
+        [[nodiscard]] uint16_t universe() const { return universe_; }
+        [[nodiscard]] std::size_t capacity() const { return buffer_.size(); }
+        [[nodiscard]] std::chrono::seconds window() const { return window_; }
+        [[nodiscard]] std::size_t frameCount() const { return frameCount_; }
+
+        /**
+         * Sources for owners in added frames.
+         */
+        [[nodiscard]] SourceDictionary& sources() { return sources_; }
+
+        /**
+         * Add the first @p slotCount slots of @p data as a frame, dropping the oldest frames to make room.
+         */
+        void addFrame(spdlog::log_clock::time_point time, const ComparableData& data, std::size_t slotCount);
+
+        /**
+         * Time of the oldest frame, if any.
+         */
+        [[nodiscard]] std::optional<spdlog::log_clock::time_point> oldest() const;
+
+        /**
+         * Write every frame to @p path, replacing it.
+         *
+         * The file is written next to @p path and renamed once it is complete and synced, so there is never a partial
+         * dump.
+         *
+         * @return FALSE if the file couldn't be written. The error is logged.
+         */
+        bool dump(const std::filesystem::path& path);
+
+        /**
+         * Write the frames from @p from to @p until to @p path, like dump(). The last frame from before @p from is
+         * included, as it is what the universe looked like at @p from.
+         */
+        bool dump(const std::filesystem::path& path, spdlog::log_clock::time_point from,
+                  spdlog::log_clock::time_point until);
+
+    private:
+        /**
+         * Each record is this header, then `uint8_t levels[slotCount]`, `uint8_t priorities[slotCount]` and
+         * `uint16_t owners[slotCount]` as owner column values.
+         */
+        struct RecordHeader
+        {
+            /** Nanoseconds since the Unix epoch. */
+            int64_t time;
+            /** Record size, including this header and padding. */
+            uint32_t size;
+            uint16_t slotCount;
+            uint16_t reserved;
+        };
+        static_assert(sizeof(RecordHeader) == kRecordHeaderSize);
+
+        [[nodiscard]] const RecordHeader& header(std::size_t offset) const
+        {
+            return *reinterpret_cast<const RecordHeader*>(buffer_.data() + offset);
+        }
+
+        /**
+         * Offset of the record after the one at @p offset.
+         */
+        [[nodiscard]] std::size_t next(std::size_t offset) const;
+
+        /**
+         * Find room for @p size bytes after the newest record without dropping anything.
+         *
+         * @return Offset to write at, if there is room.
+         */
+        [[nodiscard]] std::optional<std::size_t> room(std::size_t size) const;
+
+        void dropOldest();
+
+        /**
+         * Write the frames from @p from to @p until, in nanoseconds since the Unix epoch.
+         */
+        bool dump(const std::filesystem::path& path, int64_t from, int64_t until);
+
+        /**
+         * Write @p frameCount records of @p slotCount slots, starting with the one at @p offset, as one frame chunk.
+         *
+         * @return Offset of the record after the last one written, or std::nullopt if writing failed.
+         */
+        std::optional<std::size_t> writeBlock(int fd, std::size_t offset, std::size_t frameCount,
+                                              std::size_t slotCount);
+
+        uint16_t universe_;
+        std::chrono::seconds window_;
+        SourceDictionary sources_;
+        /** Records, kept 8-byte aligned. */
+        std::vector<uint64_t> bufferStorage_;
+        std::span<std::byte> buffer_;
+        /** Offset of the oldest record. */
+        std::size_t head_ = 0;
+        /** Offset to write the next record at. */
+        std::size_t tail_ = 0;
+        /** Once records have wrapped around to the start, where the ones before the wrap end; otherwise 0. */
+        std::size_t wrapEnd_ = 0;
+        std::size_t frameCount_ = 0;
+
+        /** Frame chunk for dump(), allocated up front. */
+        std::vector<uint64_t> chunk_;
+    };
+} // namespace sacnlogger
+
+#endif // FLIGHTRECORDER_H
@@ -0,0 +1,205 @@
+/**
+ * @file FrameDiff.h
+ *
+ * @author Dan Keenan
+ * @date 10/17/26
+ * @copyright GPL-3.0-or-later
+ * Copyright (C) 2024-2026 Dan Keenan
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef FRAMEDIFF_H
+#define FRAMEDIFF_H
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <sacn/cpp/common.h>
+#include <sacn/merge_receiver.h>
+
+namespace sacnlogger
+{
+    /**
+     * One bit per slot in a universe, set when that slot has changed.
+     */
+    class SlotMask
+    {
+    public:
+        static constexpr std::size_t kSize = SACN_MERGE_RECEIVER_MAX_SLOTS;
+        static constexpr std::size_t kWordBits = 64;
+        static constexpr std::size_t kWordCount = (kSize + kWordBits - 1) / kWordBits;
+
+        bool operator==(const SlotMask&) const = default;
+
+        [[nodiscard]] bool any() const
+        {
+            for (const auto word : words_)
+            {
+                if (word != 0)
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        [[nodiscard]] std::size_t count() const
+        {
+            std::size_t r = 0;
+            for (const auto word : words_)
+            {
+                r += std::popcount(word);
+            }
+            return r;
+        }
+
+        [[nodiscard]] bool test(std::size_t slot) const { return (words_[slot / kWordBits] >> (slot % kWordBits)) & 1; }
+        void set(std::size_t slot) { words_[slot / kWordBits] |= uint64_t(1) << (slot % kWordBits); }
+        void reset() { words_.fill(0); }
+
+        /**
+         * Set @p count slots starting at @p first.
+         */
+        void setRange(std::size_t first, std::size_t count)
+        {
+            for (auto slot = first; slot < first + count; ++slot)
+            {
+                set(slot);
+            }
+        }
+
+        /**
+         * Merge up to 64 bits into the mask, with bit 0 of @p bits landing on slot @p pos.
+         *
+         * Bits above @p count must be clear.
+         */
+        void orBits(std::size_t pos, uint64_t bits, std::size_t count)
+        {
+            const auto word = pos / kWordBits;
+            const auto shift = pos % kWordBits;
+            words_[word] |= bits << shift;
+            if (shift + count > kWordBits)
+            {
+                words_[word + 1] |= bits >> (kWordBits - shift);
+            }
+        }
+
+        /**
+         * Call @p f with the index of every set slot, in ascending order.
+         */
+        template <typename F>
+        void forEach(F&& f) const
+        {
+            for (std::size_t ix = 0; ix < kWordCount; ++ix)
+            {
+                auto word = words_[ix];
+                while (word != 0)
+                {
+                    f(ix * kWordBits + std::countr_zero(word));
+                    word &= word - 1;
+                }
+            }
+        }
+
+        SlotMask& operator|=(const SlotMask& rhs)
+        {
+            for (std::size_t ix = 0; ix < kWordCount; ++ix)
+            {
+                words_[ix] |= rhs.words_[ix];
+            }
+            return *this;
+        }
+
+        [[nodiscard]] const std::array<uint64_t, kWordCount>& words() const { return words_; }
+
+    private:
+        std::array<uint64_t, kWordCount> words_{};
+    };
+
+    /**
+     * Compare @p count slot values, marking each slot that differs in @p mask.
+     *
+     * Uses the widest SIMD instruction set available at compile time.
+     *
+     * @param offset Slot index of the first value.
+     */
+    void diffSlots(const uint8_t* lhs, const uint8_t* rhs, std::size_t count, std::size_t offset, SlotMask& mask);
+
+    /**
+     * @copydoc diffSlots(const uint8_t*, const uint8_t*, std::size_t, std::size_t, SlotMask&)
+     */
+    void diffSlots(const sacn_remote_source_t* lhs, const sacn_remote_source_t* rhs, std::size_t count,
+                   std::size_t offset, SlotMask& mask);
+
+    /**
+     * Name of the instruction set used by diffSlots().
+     */
+    const char* diffSlotsKernel();
+
+    /**
+     * Collection of incoming sACN data.
+     *
+     * Contains levels, priorities, and owners for comparison to determine if data has changed from the previous packet.
+     */
+    struct ComparableData
+    {
+        auto operator<=>(const ComparableData&) const = default;
+        ComparableData() = default;
+        explicit ComparableData(const SacnRecvMergedData& mergedData);
+
+        /** Owners of slots that no source has sent. */
+        static constexpr std::array<sacn_remote_source_t, SACN_MERGE_RECEIVER_MAX_SLOTS> kNoOwners = []()
+        {
+            std::array<sacn_remote_source_t, SACN_MERGE_RECEIVER_MAX_SLOTS> owners{};
+            owners.fill(sacn::kInvalidRemoteSourceHandle);
+            return owners;
+        }();
+
+        /**
+         * Find the slots in @p mergedData that differ from this data.
+         *
+         * Slots outside of the received slot range count as level and priority 0 with no owner, so they are marked as
+         * changed if this data has anything there.
+         */
+        [[nodiscard]] SlotMask diff(const SacnRecvMergedData& mergedData) const;
+
+        /**
+         * Like diff(), but only for owners.
+         */
+        [[nodiscard]] SlotMask diffOwners(const SacnRecvMergedData& mergedData) const;
+
+        /**
+         * Copy the received slot range from @p mergedData, and clear the slots outside of it.
+         */
+        void assign(const SacnRecvMergedData& mergedData);
+
+        std::array<uint8_t, SACN_MERGE_RECEIVER_MAX_SLOTS> levels_{};
+        std::array<uint8_t, SACN_MERGE_RECEIVER_MAX_SLOTS> priorities_{};
+        std::array<sacn_remote_source_t, SACN_MERGE_RECEIVER_MAX_SLOTS> owners_ = kNoOwners;
+    };
+
+    namespace detail
+    {
+        /**
+         * Portable implementations of diffSlots(), used for the tails of SIMD runs.
+         */
+        void diffSlotsScalar(const uint8_t* lhs, const uint8_t* rhs, std::size_t count, std::size_t offset,
+                             SlotMask& mask);
+        void diffSlotsScalar(const sacn_remote_source_t* lhs, const sacn_remote_source_t* rhs, std::size_t count,
+                             std::size_t offset, SlotMask& mask);
+    } // namespace detail
+} // namespace sacnlogger
+
+#endif // FRAMEDIFF_H
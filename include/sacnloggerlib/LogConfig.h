@@ -0,0 +1,239 @@
+/**
+ * @file LogConfig.h
+ *
+ * @author Dan Keenan
+ * @date 10/17/26
+ * @copyright GPL-3.0-or-later
+ * Copyright (C) 2024-2026 Dan Keenan
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LOGCONFIG_H
+#define LOGCONFIG_H
+
+#include <cstdint>
+#include <map>
+#include <nlohmann/json_fwd.hpp>
+#include <vector>
+
+namespace sacnlogger
+{
+    /**
+     * What to do when data can't be written as fast as it arrives.
+     */
+    enum class OverflowPolicy
+    {
+        /** Wait for the writer. Packets that arrive while the queue is full are dropped. */
+        Block,
+        /** Discard the oldest data that hasn't been written yet, then continue with a full row. */
+        DropOldest,
+        /** Log changes at most once per second until the writer catches up. */
+        Degrade,
+    };
+
+    /**
+     * Data log file format.
+     */
+    enum class DataFormat
+    {
+        /** Text, one row per change. */
+        Csv,
+        /** Binary, see SacnLogFormat.h. */
+        SacnLog,
+    };
+
+    /**
+     * Data log compression.
+     */
+    enum class Compression
+    {
+        None,
+        /** Streaming zstd, see ZstdCompressor. */
+        Zstd,
+    };
+
+    /**
+     * Buffering for a universe's data log.
+     */
+    class QueueConfig
+    {
+    public:
+        bool operator==(const QueueConfig&) const = default;
+
+        /**
+         * Number of received packets that can wait to be logged.
+         */
+        unsigned int queueSize = 64;
+        OverflowPolicy overflowPolicy = OverflowPolicy::Block;
+    };
+
+    /**
+     * What a Trigger watches for.
+     */
+    enum class TriggerEvent
+    {
+        /** The level at an address changes to a value. */
+        Level,
+        /** The source that owns an address changes. */
+        OwnerChange,
+        /** A source is lost. */
+        SourceLost,
+    };
+
+    /**
+     * Write out the flight recorder around the time something happens.
+     */
+    class Trigger
+    {
+    public:
+        bool operator==(const Trigger&) const = default;
+
+        TriggerEvent event = TriggerEvent::SourceLost;
+        /**
+         * Universe to watch, or 0 for every universe.
+         */
+        uint16_t universe = 0;
+        /**
+         * 1 to 512, or 0 for every address. Level triggers need an address.
+         */
+        uint16_t address = 0;
+        /**
+         * Level for TriggerEvent::Level.
+         */
+        uint8_t level = 0;
+        /**
+         * Seconds of data to write from before the trigger.
+         */
+        unsigned int pre = 60;
+        /**
+         * Seconds of data to write from after the trigger.
+         */
+        unsigned int post = 10;
+    };
+
+    /**
+     * Keep recent data in memory instead of logging it, see FlightRecorder.
+     */
+    class FlightRecorderConfig
+    {
+    public:
+        bool operator==(const FlightRecorderConfig&) const = default;
+
+        /**
+         * MiB of memory to keep each universe's data in, or 0 to log data to the drive as usual.
+         */
+        unsigned int size = 0;
+        /**
+         * Seconds of data to keep, raised to fit the longest trigger.
+         */
+        unsigned int window = 600;
+        std::vector<Trigger> triggers{Trigger{}};
+    };
+
+    /**
+     * Log file output configuration.
+     */
+    class LogConfig
+    {
+    public:
+        bool operator==(const LogConfig&) const = default;
+
+        DataFormat dataFormat = DataFormat::Csv;
+        Compression compression = Compression::None;
+        /**
+         * zstd level, from 1 (fastest) to 19 (smallest).
+         */
+        int compressionLevel = 3;
+        /**
+         * Compress data logs in the background once they have been rotated, see SegmentCompressor.
+         */
+        bool compressRotated = false;
+        /**
+         * Most KiB of rotated logs to compress per second.
+         */
+        unsigned int compressRotatedRate = 4096;
+        /**
+         * Write only the changed slots instead of the whole universe.
+         */
+        bool deltaRows = false;
+        /**
+         * When writing delta rows, write a full row after this many delta rows.
+         */
+        unsigned int checkpointInterval = 100;
+        /**
+         * Seconds between keyframes, full rows that are added to the time index.
+         */
+        unsigned int checkpointSeconds = 10;
+        /**
+         * Also write source rows at each keyframe, and rows noting lost data, to CSV data logs, so each file can be read
+         * on its own.
+         */
+        bool selfContained = false;
+        /**
+         * Longest that logged data waits before it is written and synced to the disk, in milliseconds. 0 writes data as
+         * soon as it is ready and leaves syncing to the system.
+         */
+        unsigned int commitInterval = 0;
+        /**
+         * When commitInterval is set, also commit once this many KiB are waiting.
+         */
+        unsigned int commitSize = 1024;
+        /**
+         * Write logs through io_uring, if the kernel has it.
+         */
+        bool ioUring = false;
+        /**
+         * Most MiB all logs may use together, or 0 to use the drive, less some room for other things.
+         */
+        unsigned int retentionBudget = 0;
+        /**
+         * Most MiB of logs to stage in memory before they are moved to the drive, see StagingArea, or 0 to write them
+         * to the drive directly.
+         */
+        unsigned int stagingSize = 0;
+        /**
+         * Longest that staged logs wait to be moved to the drive, in milliseconds.
+         */
+        unsigned int stagingAge = 10000;
+        FlightRecorderConfig flightRecorder;
+        /**
+         * Buffering for universes that aren't in universeQueues.
+         */
+        QueueConfig queue;
+        /**
+         * Buffering for individual universes.
+         */
+        std::map<uint16_t, QueueConfig> universeQueues;
+
+        [[nodiscard]] const QueueConfig& queueFor(uint16_t universe) const
+        {
+            const auto it = universeQueues.find(universe);
+            return it == universeQueues.end() ? queue : it->second;
+        }
+    };
+
+    void to_json(nlohmann::json& j, const QueueConfig& value);
+    void from_json(const nlohmann::json& j, QueueConfig& value);
+
+    void to_json(nlohmann::json& j, const Trigger& value);
+    void from_json(const nlohmann::json& j, Trigger& value);
+
+    void to_json(nlohmann::json& j, const FlightRecorderConfig& value);
+    void from_json(const nlohmann::json& j, FlightRecorderConfig& value);
+
+    void to_json(nlohmann::json& j, const LogConfig& value);
+    void from_json(const nlohmann::json& j, LogConfig& value);
+} // namespace sacnlogger
+
+#endif // LOGCONFIG_H
@@ -0,0 +1,495 @@
+/**
+ * @file LogWriter.h
+ *
+ * @author Dan Keenan
+ * @date 10/17/26
+ * @copyright GPL-3.0-or-later
+ * Copyright (C) 2024-2026 Dan Keenan
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LOGWRITER_H
+#define LOGWRITER_H
+
+#include <array>
+#include <atomic>
+#include <boost/signals2/signal.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <spdlog/common.h>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "BufferPool.h"
+#include "LogConfig.h"
+#include "SegmentCompressor.h"
+#include "SegmentManifest.h"
+#include "StagingArea.h"
+#include "TimestampFormatter.h"
+#include "UringQueue.h"
+#include "ZstdStream.h"
+
+namespace sacnlogger
+{
+    /**
+     * When LogWriter commits data to the disk.
+     *
+     * With an interval, data is collected in memory and committed in groups, with one write and one `fdatasync()` for
+     * each file. This suits drives that are worn by small writes or mounted with `sync`, like the USB drive on the
+     * appliance. A commit is due once the oldest data has waited for the interval, which bounds what a power cut can
+     * lose, or once enough data is waiting; those commits only write whole clusters and leave the rest for next time.
+     */
+    struct CommitPolicy
+    {
+        /** Longest that data waits before it is written and synced, or 0 to write it as soon as it is flushed. */
+        std::chrono::milliseconds interval{0};
+        /** Also commit once this many bytes are waiting. */
+        std::size_t bytes = 1024 * 1024;
+    };
+
+    /**
+     * Write log files from a background thread.
+     *
+     * Producers fill blocks from a shared BufferPool through a Stream, and the writer thread writes each block straight
+     * to its file, so log lines are neither allocated nor copied after being formatted. Files are written as numbered
+     * segments (see SegmentManifest.h) that are never renamed, so rotation costs the same however many there are.
+     */
+    class LogWriter
+    {
+        struct File
+        {
+            /**
+             * Path of segment @p sequence.
+             */
+            [[nodiscard]] std::filesystem::path pathFor(uint64_t sequence) const;
+            /**
+             * Path of the segment being written.
+             */
+            [[nodiscard]] std::filesystem::path currentPath() const { return pathFor(segments.back()); }
+
+            std::filesystem::path path;
+            unsigned int maxFileCount = 0;
+            /** Sequence numbers of the segments on disk, oldest first. The last one is being written. */
+            std::deque<uint64_t> segments;
+            int manifestFd = -1;
+            int fd = -1;
+            /** Bytes in the current file. */
+            std::uintmax_t size = 0;
+            /** Data waiting for the next commit, which is also counted in size. */
+            std::vector<char> staged;
+            /** Bytes at the start of staged that are being committed. */
+            std::size_t committing = 0;
+            /** When the oldest staged data was staged. */
+            std::chrono::steady_clock::time_point stagedSince;
+            /** Filesystem cluster size, which size-triggered commits are aligned to. */
+            std::size_t clusterSize = 4096;
+            /** Space to reserve for each segment, or 0 to let it grow as it is written. */
+            std::uintmax_t preallocateSize = 0;
+            bool preallocated = false;
+            /** Time index; only opened once there is a keyframe to add. */
+            int indexFd = -1;
+            bool failed = false;
+            /** io_uring operations that haven't finished. */
+            unsigned int inFlight = 0;
+            std::unique_ptr<ZstdCompressor> compressor;
+            /** Compressor output, reused between blocks. */
+            std::vector<char> compressed;
+            /** Bytes given to and written by the compressor for the current file. */
+            std::uintmax_t fileRawBytes = 0;
+            std::uintmax_t fileStoredBytes = 0;
+            /** Totals for all files. */
+            std::atomic<uint64_t> rawBytes{0};
+            std::atomic<uint64_t> storedBytes{0};
+        };
+
+    public:
+        static constexpr std::size_t kDefaultBlockCount = 128;
+        static constexpr std::size_t kDefaultBlockSize = 65536;
+        /**
+         * Blocks each stream may hold at once: one being filled, and more waiting for rotation, compression or the
+         * disk.
+         */
+        static constexpr std::size_t kBlocksPerStream = 4;
+        /** Never remove old segments, e.g. because a RetentionManager does. */
+        static constexpr unsigned int kKeepAllSegments = std::numeric_limits<unsigned int>::max();
+
+        /**
+         * Producer's handle to one log file.
+         *
+         * Not thread-safe; each stream must only be used from one thread.
+         */
+        class Stream
+        {
+        public:
+            /** Longest that a partly filled block collects lines before flushDue() says to hand it over. */
+            static constexpr std::chrono::milliseconds kMaxBlockAge{100};
+
+            /**
+             * How often the overflow policy has been applied. Safe to read from any thread.
+             */
+            struct Counters
+            {
+                /** Times the stream had to wait for a free block. */
+                std::atomic<uint64_t> waits{0};
+                /** Blocks discarded by OverflowPolicy::DropOldest. */
+                std::atomic<uint64_t> droppedBlocks{0};
+            };
+
+            Stream(LogWriter& writer, File& file, std::uintmax_t fileSize, std::uintmax_t maxFileSize,
+                   OverflowPolicy overflowPolicy, bool priority, std::uintmax_t recoveredBytes = 0);
+            ~Stream();
+
+            Stream(const Stream&) = delete;
+            Stream& operator=(const Stream&) = delete;
+
+            /**
+             * Write @p line, prefixed by @p time and followed by a newline.
+             */
+            void write(spdlog::log_clock::time_point time, std::string_view line);
+
+            /**
+             * Write @p size bytes of binary data as-is.
+             */
+            void writeBytes(const void* data, std::size_t size);
+
+            /**
+             * Start a record of @p size bytes, made of the next writeBytes() calls. write() makes each line a record.
+             *
+             * OverflowPolicy::DropOldest only ever drops whole records, so readers can carry on after the gap. With
+             * that policy, records start a new block when they don't fit in what is left of the current one.
+             */
+            void beginRecord(std::size_t size);
+
+            /**
+             * Add the next line to the file's time index as a keyframe at @p time.
+             *
+             * The index is kept next to each segment (see TimeIndex.h). In compressed files, each keyframe also starts
+             * a new zstd frame, so index offsets point to where decompression can begin.
+             */
+            void markKeyframe(spdlog::log_clock::time_point time);
+
+            /**
+             * Hand everything written so far to the writer thread.
+             *
+             * Full blocks are handed over as they fill, so only call this when the rest is needed, e.g. once
+             * flushDue(). Each flush costs a whole block and a write, however little is in it.
+             */
+            void flush();
+
+            /**
+             * Check if a partly filled block is waiting for more lines.
+             */
+            [[nodiscard]] bool pending() const { return block_ != nullptr; }
+
+            /**
+             * Check if the partly filled block has been collecting lines for kMaxBlockAge.
+             */
+            [[nodiscard]] bool flushDue(std::chrono::steady_clock::time_point now) const
+            {
+                return block_ != nullptr && now - blockStartedAt_ >= kMaxBlockAge;
+            }
+
+            /**
+             * Start a new file before the next line.
+             */
+            void rotate();
+
+            /**
+             * Check if @p bytes more would make the current file larger than the maximum file size.
+             */
+            [[nodiscard]] bool wouldOverflow(std::uintmax_t bytes) const
+            {
+                return fileSize_ > 0 && fileSize_ + bytes > maxFileSize_;
+            }
+
+            /**
+             * Check if a new file has been started since the last call.
+             *
+             * This is TRUE for the first call, so the first file gets the same treatment as those after rotation.
+             */
+            [[nodiscard]] bool takeFileStarted() { return std::exchange(fileStarted_, false); }
+
+            /**
+             * Bytes discarded by the overflow policy since the last call.
+             */
+            [[nodiscard]] std::uintmax_t takeDroppedBytes() { return std::exchange(droppedBytes_, 0); }
+
+            /**
+             * Bytes cut off the end of the file being appended to when it was opened, or 0 after the first call.
+             *
+             * @see recoverTail()
+             */
+            [[nodiscard]] std::uintmax_t takeRecoveredBytes() { return std::exchange(recoveredBytes_, 0); }
+
+            [[nodiscard]] OverflowPolicy overflowPolicy() const { return overflowPolicy_; }
+
+            /**
+             * Fraction of the writer's blocks that are free, from 0 to 1.
+             */
+            [[nodiscard]] double freeBlockRatio() const
+            {
+                return double(writer_.pool_.freeCount()) / double(writer_.pool_.blockCount());
+            }
+
+            [[nodiscard]] const Counters& counters() const { return counters_; }
+
+            [[nodiscard]] bool compressed() const { return file_.compressor != nullptr; }
+
+            /**
+             * Bytes written per byte stored so far, or 1 if nothing has been written. Safe to call from any thread.
+             */
+            [[nodiscard]] double compressionRatio() const
+            {
+                const auto storedBytes = file_.storedBytes.load(std::memory_order_relaxed);
+                return storedBytes == 0 ? 1.0 : double(file_.rawBytes.load(std::memory_order_relaxed)) / storedBytes;
+            }
+
+        private:
+            void append(std::string_view bytes);
+            BufferPool::Block* acquireBlock();
+
+            LogWriter& writer_;
+            File& file_;
+            OverflowPolicy overflowPolicy_;
+            /** Blocks to leave for priority streams. */
+            std::size_t reserve_;
+            Counters counters_;
+            BufferPool::Block* block_ = nullptr;
+            std::chrono::steady_clock::time_point blockStartedAt_;
+            /** block_ starts partway through a record. */
+            bool blockContinues_ = false;
+            /** Bytes of the current record that haven't been written yet. */
+            std::size_t recordRemaining_ = 0;
+            /** Part of the current record has been written, and the rest hasn't. */
+            bool midRecord_ = false;
+            std::optional<spdlog::log_clock::time_point> keyframe_;
+            bool rotatePending_ = false;
+            bool fileStarted_ = true;
+            std::uintmax_t droppedBytes_ = 0;
+            std::uintmax_t recoveredBytes_;
+            std::uintmax_t fileSize_;
+            std::uintmax_t maxFileSize_;
+            TimestampFormatter timestampFormatter_;
+        };
+
+        /**
+         * @param segmentCompressor Compresses uncompressed files once they have been rotated, including any left from
+         * before, if given.
+         * @param ioUring Write through io_uring (see UringQueue.h), if the kernel has it.
+         * @param stagingArea Stages segments and time indexes before they reach the drive, if given. Manifests are
+         * still written directly, as they only change when a segment is started.
+         */
+        explicit LogWriter(std::size_t blockCount = kDefaultBlockCount, std::size_t blockSize = kDefaultBlockSize,
+                           std::shared_ptr<SegmentCompressor> segmentCompressor = nullptr,
+                           CommitPolicy commitPolicy = {}, bool ioUring = false,
+                           std::shared_ptr<StagingArea> stagingArea = nullptr);
+
+        /**
+         * Write everything that has been flushed, then stop.
+         */
+        ~LogWriter();
+
+        LogWriter(const LogWriter&) = delete;
+        LogWriter& operator=(const LogWriter&) = delete;
+
+        /**
+         * Pool size for @p streamCount streams, so every stream can hold kBlocksPerStream blocks with the default
+         * count to spare.
+         */
+        [[nodiscard]] static std::size_t blockCountFor(std::size_t streamCount);
+
+        /**
+         * Open the log @p path, appending to its newest segment once anything torn from its end has been removed (see
+         * TailRecovery.h).
+         *
+         * @param maxFileSize Size to rotate at. Uncompressed segments reserve this much when they are opened, where the
+         * filesystem supports it, so appending doesn't have to allocate space every few KiB; the unused space is given
+         * back when the segment is closed.
+         * @param maxFileCount Finished segments to keep, besides the one being written, or kKeepAllSegments.
+         * @param overflowPolicy What to do when no blocks are free. OverflowPolicy::Degrade is left to the caller, and
+         * otherwise behaves like OverflowPolicy::Block.
+         * @param priority Allow the stream to use the few blocks held back for priority streams, so it can still be
+         * written when other streams have used up the rest. These streams never drop data.
+         * @param compressionLevel zstd compression level, or 0 to write the file as-is. Compressed files have `.zst`
+         * appended to their name, and are never appended to, so a new one is started instead. @p maxFileSize applies
+         * before compression.
+         */
+        [[nodiscard]] std::unique_ptr<Stream> openStream(const std::filesystem::path& path, std::uintmax_t maxFileSize,
+                                                         unsigned int maxFileCount,
+                                                         OverflowPolicy overflowPolicy = OverflowPolicy::Block,
+                                                         bool priority = false, int compressionLevel = 0);
+
+        [[nodiscard]] const BufferPool& pool() const { return pool_; }
+
+        [[nodiscard]] const CommitPolicy& commitPolicy() const { return commitPolicy_; }
+
+        /**
+         * Check if files are being written through io_uring, which may not be the case even if it was asked for.
+         */
+        [[nodiscard]] bool usingIoUring() const { return uring_ != nullptr; }
+
+        /**
+         * Longest that data has waited to be committed so far, including the time to write and sync it. This is how
+         * much logging a power cut could have lost. Safe to call from any thread.
+         */
+        [[nodiscard]] std::chrono::milliseconds longestCommitWait() const
+        {
+            return std::chrono::milliseconds(longestCommitWait_.load(std::memory_order_relaxed));
+        }
+
+        using SigWritten = boost::signals2::signal<void(std::uintmax_t)>;
+        /**
+         * Emitted from the writer thread with the bytes written to log files since it was last emitted, after each
+         * batch of blocks.
+         */
+        SigWritten sigWritten;
+
+    private:
+        static constexpr unsigned int kUringDepth = 32;
+
+        struct Request
+        {
+            File* file;
+            BufferPool::Block* block;
+            /** Rotate the file before writing the block. */
+            bool rotate;
+            /** The block starts with a keyframe at this time. */
+            std::optional<spdlog::log_clock::time_point> keyframe;
+            /** The block starts partway through a record from the one before it. */
+            bool continuation = false;
+        };
+
+        /**
+         * Blocks taken back from the queue by reclaim().
+         */
+        struct Reclaimed
+        {
+            /** An emptied block for the caller, or nullptr if nothing could be dropped. */
+            BufferPool::Block* block = nullptr;
+            std::size_t blockCount = 0;
+            std::uintmax_t bytes = 0;
+            /** The caller must rotate the file before its next block. */
+            bool rotate = false;
+        };
+
+        /**
+         * Write in flight through io_uring, which is kept until all of its operations have finished.
+         */
+        struct UringWrite
+        {
+            File* file;
+            std::string_view data;
+            std::uintmax_t offset;
+            /** The write hasn't finished. */
+            bool writing;
+            /** A sync follows the write. */
+            bool sync;
+        };
+
+        void submit(const Request& request);
+        /**
+         * Take back the oldest whole records queued for @p file that haven't started being written: a block that
+         * starts a record, and any blocks after it that continue one.
+         *
+         * @param midRecord The stream is partway through a record, so the last blocks queued can't be dropped.
+         */
+        Reclaimed reclaim(const File& file, bool midRecord);
+        void run(std::stop_token stopToken);
+        void write(const Request& request);
+        void writeIndex(File& file, spdlog::log_clock::time_point keyframe);
+        /**
+         * Write @p data, or stage it for the next commit.
+         */
+        void writeData(File& file, std::string_view data);
+        /**
+         * Write @p data to the file at @p offset, then sync it if @p sync is set.
+         *
+         * With io_uring this only starts the write, and @p data must stay in place until waitFor() the file.
+         */
+        void writeAt(File& file, std::string_view data, std::uintmax_t offset, bool sync);
+        /**
+         * Write @p data to the file at @p offset now.
+         */
+        static void writeAll(File& file, std::string_view data, std::uintmax_t offset);
+        static void syncData(File& file);
+        /**
+         * Finish handling an io_uring operation.
+         */
+        void complete(const UringQueue::Completion& completion);
+        /**
+         * Wait for everything in flight through io_uring for @p file, or for all files if it is nullptr.
+         */
+        void waitFor(const File* file);
+        /**
+         * Compress and write @p data, or with empty @p data, finish the current zstd frame.
+         */
+        void writeCompressed(File& file, std::string_view data);
+        /**
+         * Commit whatever staged data is due.
+         */
+        void commitDue();
+        /**
+         * Write and sync @p file's staged data.
+         *
+         * @param whole Write everything, instead of stopping at the last cluster boundary.
+         */
+        void commit(File& file, bool whole);
+        /**
+         * Start commit() without waiting for it to finish.
+         */
+        void startCommit(File& file, bool whole);
+        /**
+         * Drop the staged data committed by startCommit(), once it has been written.
+         */
+        void finishCommit(File& file);
+        void openFile(File& file, bool truncate);
+        /**
+         * Start the next segment, then remove the oldest ones past the maximum file count.
+         */
+        void rotateFile(File& file);
+        void removeOldSegments(File& file);
+        void closeFile(File& file);
+
+        BufferPool pool_;
+        std::size_t reservedBlocks_;
+        std::mutex mutex_;
+        std::condition_variable_any requestSubmitted_;
+        /** Never holds more than one request per block, so it doesn't need to grow past its initial capacity. */
+        std::vector<Request> requests_;
+        std::deque<File> files_;
+        std::shared_ptr<SegmentCompressor> segmentCompressor_;
+        std::shared_ptr<StagingArea> stagingArea_;
+        CommitPolicy commitPolicy_;
+        /** Files with staged data, oldest first. Only used by the writer thread. */
+        std::vector<File*> stagedFiles_;
+        std::size_t stagedBytes_ = 0;
+        std::atomic<int64_t> longestCommitWait_{0};
+        /** Bytes written since sigWritten was last emitted. Only used by the writer thread. */
+        std::uintmax_t unreportedBytes_ = 0;
+        std::unique_ptr<UringQueue> uring_;
+        /** Indexed by io_uring tag. */
+        std::vector<UringWrite> uringWrites_;
+        std::vector<uint64_t> freeUringWrites_;
+        /** Must be last, so everything above exists while it runs. */
+        std::jthread worker_;
+    };
+} // namespace sacnlogger
+
+#endif // LOGWRITER_H
@@ -0,0 +1,74 @@
+/**
+ * @file OwnerTable.h
+ *
+ * @author Dan Keenan
+ * @date 10/17/26
+ * @copyright GPL-3.0-or-later
+ * Copyright (C) 2024-2026 Dan Keenan
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef OWNERTABLE_H
+#define OWNERTABLE_H
+
+#include <sacn/cpp/common.h>
+#include <string_view>
+#include <vector>
+
+namespace sacnlogger
+{
+    /**
+     * Source abbreviations indexed directly by source handle.
+     *
+     * Names are views, so the strings they refer to must outlive the table (e.g. those held by an AbbreviationMap).
+     */
+    class OwnerTable
+    {
+    public:
+        static constexpr std::string_view kNoOwner = "-";
+        static constexpr std::string_view kUnknownOwner = "?";
+
+        /**
+         * Abbreviation for the source with @p handle.
+         */
+        [[nodiscard]] std::string_view operator[](sacn_remote_source_t handle) const
+        {
+            if (handle == sacn::kInvalidRemoteSourceHandle)
+            {
+                return kNoOwner;
+            }
+            if (handle >= names_.size() || names_[handle].empty())
+            {
+                return kUnknownOwner;
+            }
+            return names_[handle];
+        }
+
+        void set(sacn_remote_source_t handle, std::string_view name)
+        {
+            if (handle >= names_.size())
+            {
+                names_.resize(handle + 1);
+            }
+            names_[handle] = name;
+        }
+
+        void clear() { names_.clear(); }
+
+    private:
+        std::vector<std::string_view> names_;
+    };
+} // namespace sacnlogger
+
+#endif // OWNERTABLE_H
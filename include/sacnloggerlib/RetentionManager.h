@@ -0,0 +1,166 @@
+/**
+ * @file RetentionManager.h
+ *
+ * @author Dan Keenan
+ * @date 10/17/26
+ * @copyright GPL-3.0-or-later
+ * Copyright (C) 2024-2026 Dan Keenan
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef RETENTIONMANAGER_H
+#define RETENTIONMANAGER_H
+
+#include <atomic>
+#include <boost/signals2/signal.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <spdlog/common.h>
+#include <thread>
+#include "SegmentCompressor.h"
+
+namespace sacnlogger
+{
+    /**
+     * Keep the logs in a directory within a byte budget, removing the oldest finished segments as needed.
+     *
+     * All logs with a manifest (see SegmentManifest.h) in the directory count towards the budget, including those of
+     * universes that are no longer logged. Each universe, i.e. logs whose names start with the same `U00001_`, gets an
+     * equal share of the budget as its quota. Segments are removed oldest first from universes over their quota, so a
+     * busy universe can't push out a quiet one's history, and only then from any universe. The segment each log is
+     * writing is never removed.
+     *
+     * Segments compressed by a SegmentCompressor count at their compressed size, so compression lets more history fit.
+     *
+     * Checks the logs when created, and then periodically from a background thread. Each check lists the directory
+     * once, and only rereads manifests that have changed.
+     */
+    class RetentionManager
+    {
+    public:
+        static constexpr std::chrono::milliseconds kDefaultPollPeriod{10000};
+        /** Space left free when the budget is worked out from the drive, at least, on drives of 8 GiB or more. */
+        static constexpr std::uintmax_t kMinReserve = 2ULL * 1024 * 1024 * 1024;
+        /** Budgets worked out from the drive below this are warned about, as they keep little history. */
+        static constexpr std::uintmax_t kSmallBudget = 256ULL * 1024 * 1024;
+
+        /**
+         * @param directory Where the logs are.
+         * @param budget Most bytes the logs may use, or 0 to work it out from the drive (see budgetFor()).
+         * @param segmentCompressor Segments are removed while holding its SegmentCompressor::renameMutex(), if given.
+         */
+        explicit RetentionManager(std::filesystem::path directory, std::uintmax_t budget = 0,
+                                  std::shared_ptr<SegmentCompressor> segmentCompressor = nullptr,
+                                  std::chrono::milliseconds pollPeriod = kDefaultPollPeriod);
+
+        ~RetentionManager();
+
+        RetentionManager(const RetentionManager&) = delete;
+        RetentionManager& operator=(const RetentionManager&) = delete;
+
+        /**
+         * Most bytes the logs may use now. Safe to call from any thread.
+         */
+        [[nodiscard]] std::uintmax_t budget() const;
+
+        /**
+         * Budget for logs using @p logBytes on a drive of @p capacity bytes with @p available bytes free.
+         *
+         * That is what the logs use plus what is free, less a reserve for everything else: 5% of the drive or
+         * kMinReserve, whichever is larger, but never more than a quarter of the drive, so small drives (e.g. SD cards)
+         * still keep logs. If other files leave less than that, the logs still get half of what they could use, so
+         * some history is kept.
+         */
+        [[nodiscard]] static std::uintmax_t budgetFor(std::uintmax_t logBytes, std::uintmax_t capacity,
+                                                      std::uintmax_t available);
+
+        /**
+         * Size for new segments, so about 20 of them fit in @p quota and removing one gives up little history.
+         *
+         * @return Between 1 MiB and 20 MiB.
+         */
+        [[nodiscard]] static std::uintmax_t segmentSizeFor(std::uintmax_t quota);
+
+        /**
+         * Remove segments until the logs are within the budget. Safe to call from any thread.
+         *
+         * @return Bytes removed.
+         */
+        std::uintmax_t enforce();
+
+        /**
+         * Remove segments until @p bytes have been freed, whatever the budget, e.g. when the drive is nearly full. Safe
+         * to call from any thread.
+         *
+         * @return Bytes removed, which may be less than @p bytes if there were no more segments to remove.
+         */
+        std::uintmax_t reclaim(std::uintmax_t bytes);
+
+        /**
+         * Bytes removed so far. Safe to call from any thread.
+         */
+        [[nodiscard]] std::uintmax_t removedBytes() const { return removedBytes_.load(std::memory_order_relaxed); }
+
+        using SigRemoved = boost::signals2::signal<void(std::uintmax_t)>;
+        /**
+         * Emitted with the bytes freed after each pass that removed something.
+         */
+        SigRemoved sigRemoved;
+
+    private:
+        struct Scan;
+
+        /**
+         * Start times read from a manifest, with what it looked like when they were read. Manifests are only appended
+         * to, and FAT drives only keep times to 2 s, so the size tells of changes the time might not.
+         */
+        struct CachedManifest
+        {
+            std::filesystem::file_time_type writtenAt;
+            std::uintmax_t size = 0;
+            std::map<uint64_t, spdlog::log_clock::time_point> startTimes;
+        };
+
+        [[nodiscard]] Scan scan() const;
+        [[nodiscard]] std::uintmax_t budget(const Scan& scan) const;
+        /**
+         * Remove segments from @p scan until @p bytes have been freed.
+         */
+        std::uintmax_t remove(Scan& scan, std::uintmax_t bytes);
+        void run(std::stop_token stopToken);
+
+        std::filesystem::path directory_;
+        std::uintmax_t budget_;
+        std::shared_ptr<SegmentCompressor> segmentCompressor_;
+        std::chrono::milliseconds pollPeriod_;
+        /** Only one pass at a time. */
+        std::mutex mutex_;
+        std::mutex waitMutex_;
+        std::condition_variable_any stopped_;
+        std::atomic<std::uintmax_t> removedBytes_{0};
+        mutable std::mutex manifestCacheMutex_;
+        /** By manifest path. */
+        mutable std::map<std::filesystem::path, CachedManifest> manifestCache_;
+        mutable std::atomic<bool> warnedSmallBudget_{false};
+        /** Must be last, so everything above exists while it runs. */
+        std::jthread worker_;
+    };
+} // namespace sacnlogger
+
+#endif // RETENTIONMANAGER_H
@@ -23,9 +23,14 @@
 #define RUNNER_H
 
 #include <future>
+#include <mutex>
 #include <vector>
 #include "Config.h"
+#include "ControlSocket.h"
 #include "DiskSpaceMonitor.h"
+#include "RetentionManager.h"
+#include "SegmentCompressor.h"
+#include "StagingArea.h"
 #include "UniverseMonitor.h"
 
 namespace sacnlogger
@@ -36,8 +41,22 @@ namespace sacnlogger
     class Runner
     {
     public:
+        /**
+         * When disk space is critical, make this much more room than it takes to get out of low space, so the space
+         * isn't low again straight away.
+         */
+        static constexpr double kReclaimMargin = 1.25;
+
         explicit Runner(const Config& config = {}) : config_(config) {}
 
+        /**
+         * Stop the application, if it is running.
+         */
+        ~Runner();
+
+        Runner(const Runner&) = delete;
+        Runner& operator=(const Runner&) = delete;
+
         /**
          * Start the application (blocking).
          */
@@ -65,14 +84,40 @@ namespace sacnlogger
          */
         void setConfig(const Config& config);
 
+        /**
+         * Dump the flight recorder for @p universe, or for every universe, if the flight recorder is enabled.
+         *
+         * @param reason Logged with the dump.
+         */
+        void requestDump(std::string_view reason, std::optional<uint16_t> universe = std::nullopt);
+
     private:
         Config config_;
+        /**
+         * Guards running_, the monitors and the control socket. The disk space monitor stops the runner from its own
+         * thread, and dumps are requested from the control socket's and the signal handler's.
+         */
+        std::mutex mutex_;
         bool running_ = false;
-        std::vector<UniverseMonitor> universeMonitors_;
+        /**
+         * Before everything that reports to it, so it outlives them. As it can also call stop(), ~Runner() stops its
+         * thread before anything is destroyed.
+         */
         DiskSpaceMonitor diskSpaceMonitor_;
+        /** Compresses rotated data logs, if enabled. */
+        std::shared_ptr<SegmentCompressor> segmentCompressor_;
+        /** Keeps the logs within their budget. */
+        std::unique_ptr<RetentionManager> retentionManager_;
+        /** Stages logs in memory, if enabled. */
+        std::shared_ptr<StagingArea> stagingArea_;
+        /** Writes data logs for all universes. */
+        std::shared_ptr<LogWriter> logWriter_;
+        std::vector<UniverseMonitor> universeMonitors_;
+        /** Takes commands while the flight recorder is enabled. After the monitors, as it uses them. */
+        std::unique_ptr<ControlSocket> controlSocket_;
 
-        void onLowDiskSpace(std::uintmax_t space);
-        void onCriticalDiskSpace(std::uintmax_t space);
+        void onLowDiskSpace(const DiskSpaceForecast& forecast);
+        void onCriticalDiskSpace(const DiskSpaceForecast& forecast);
     };
 } // namespace sacnlogger
 
@@ -0,0 +1,138 @@
+/**
+ * @file SacnLogEncoder.h
+ *
+ * @author Dan Keenan
+ * @date 10/17/26
+ * @copyright GPL-3.0-or-later
+ * Copyright (C) 2024-2026 Dan Keenan
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef SACNLOGENCODER_H
+#define SACNLOGENCODER_H
+
+#include <array>
+#include <chrono>
+#include <etcpal/cpp/uuid.h>
+#include <string_view>
+#include <vector>
+#include "FrameDiff.h"
+#include "LogWriter.h"
+#include "SacnLogFormat.h"
+
+namespace sacnlogger
+{
+    /**
+     * Sources that `.sacnlog` owner columns refer to.
+     *
+     * Records are only ever added, so an owner index stays valid for as long as the dictionary does.
+     */
+    class SourceDictionary
+    {
+    public:
+        /**
+         * Forget which sources are using which handles.
+         */
+        void clearHandles();
+
+        /**
+         * Note that @p handle refers to the given source, adding it to the dictionary if needed.
+         */
+        void setSource(sacn_remote_source_t handle, const etcpal::Uuid& cid, std::string_view abbreviation,
+                       std::string_view name);
+
+        /**
+         * Owner column value for @p handle.
+         */
+        [[nodiscard]] uint16_t ownerIndex(sacn_remote_source_t handle) const;
+
+        [[nodiscard]] const std::vector<sacnlog::SourceRecord>& records() const { return records_; }
+
+    private:
+        std::vector<sacnlog::SourceRecord> records_;
+        /** Dictionary index for each source handle. */
+        std::vector<uint16_t> handleIndexes_;
+    };
+
+    /**
+     * Write universe data in the binary `.sacnlog` format.
+     *
+     * Frames are collected into column blocks, which are written when they fill up or get old.
+     *
+     * @see SacnLogFormat.h
+     */
+    class SacnLogEncoder
+    {
+    public:
+        static constexpr std::size_t kFramesPerBlock = 64;
+        /** Write a block that has been collecting frames for this long, even if it isn't full. */
+        static constexpr std::chrono::seconds kMaxBlockAge{1};
+        /** Add a block to the time index at least this often. */
+        static constexpr std::chrono::seconds kKeyframeInterval{10};
+
+        explicit SacnLogEncoder(uint16_t universe);
+
+        /**
+         * Forget which sources are using which handles.
+         */
+        void clearHandles() { dictionary_.clearHandles(); }
+
+        /**
+         * Note that @p handle refers to the given source, adding it to the dictionary if needed.
+         */
+        void setSource(sacn_remote_source_t handle, const etcpal::Uuid& cid, std::string_view abbreviation,
+                       std::string_view name)
+        {
+            dictionary_.setSource(handle, cid, abbreviation, name);
+        }
+
+        /**
+         * Add the first @p slotCount slots of @p data as a frame, writing the block to @p stream if it is full.
+         */
+        void addFrame(LogWriter::Stream& stream, spdlog::log_clock::time_point time, const ComparableData& data,
+                      std::size_t slotCount);
+
+        /**
+         * Check if the current block has been collecting frames for too long.
+         */
+        [[nodiscard]] bool flushDue(spdlog::log_clock::time_point now) const
+        {
+            return frameCount_ > 0 && now - blockStartedAt_ >= kMaxBlockAge;
+        }
+
+        /**
+         * Write the current block and any new sources to @p stream.
+         */
+        void flush(LogWriter::Stream& stream);
+
+    private:
+        void writeChunk(LogWriter::Stream& stream, uint32_t type, std::size_t size, const void* payload);
+
+        uint16_t universe_;
+        SourceDictionary dictionary_;
+        /** Number of dictionary entries already in the current file. */
+        std::size_t writtenSources_ = 0;
+
+        std::size_t frameCount_ = 0;
+        std::size_t slotCount_ = 0;
+        spdlog::log_clock::time_point blockStartedAt_;
+        spdlog::log_clock::time_point lastKeyframeAt_;
+        std::array<int64_t, kFramesPerBlock> timestamps_{};
+        std::vector<uint8_t> levels_;
+        std::vector<uint8_t> priorities_;
+        std::vector<uint16_t> owners_;
+    };
+} // namespace sacnlogger
+
+#endif // SACNLOGENCODER_H
@@ -0,0 +1,138 @@
+/**
+ * @file SacnLogFormat.h
+ *
+ * @author Dan Keenan
+ * @date 10/17/26
+ * @copyright GPL-3.0-or-later
+ * Copyright (C) 2024-2026 Dan Keenan
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef SACNLOGFORMAT_H
+#define SACNLOGFORMAT_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Layout of `.sacnlog` files.
+ *
+ * A file is a sequence of chunks, each a 16-byte ChunkHeader followed by its payload. Payloads are padded to a multiple
+ * of 8 bytes, so every chunk and every column inside one is naturally aligned and can be used straight from a memory
+ * map. All values are little-endian. Each header has the CRC-32C of its payload, so a chunk that was only partly
+ * written before a power cut can be told apart from a good one.
+ *
+ * - A FileHeader chunk starts the file, and is repeated whenever logging restarts (e.g. appending to an existing file).
+ *   It also clears the source dictionary.
+ * - Source chunks hold SourceRecord entries, adding to the dictionary that owner columns refer to. The complete
+ *   dictionary is repeated at the start of each file.
+ * - Frame chunks hold a FrameBlockHeader followed by the columns for up to FrameBlockHeader::frameCount packets:
+ *   `int64_t timestamps[frameCount]` (nanoseconds since the Unix epoch), then `uint8_t levels[frameCount][slotCount]`,
+ *   `uint8_t priorities[frameCount][slotCount]`, and `uint16_t owners[frameCount][slotCount]`.
+ * - A Recovery chunk holds a RecoveryRecord, and follows the FileHeader when logging restarted after a torn end of the
+ *   file was removed.
+ * - A Dropped chunk holds a DroppedRecord, and follows the FileHeader when logging restarted after whole chunks were
+ *   discarded because the logger couldn't keep up.
+ */
+namespace sacnlogger::sacnlog
+{
+    constexpr uint32_t chunkType(const char (&name)[5])
+    {
+        return uint32_t(uint8_t(name[0])) | uint32_t(uint8_t(name[1])) << 8 | uint32_t(uint8_t(name[2])) << 16 |
+               uint32_t(uint8_t(name[3])) << 24;
+    }
+
+    constexpr uint32_t kFileHeaderChunk = chunkType("SLOG");
+    constexpr uint32_t kSourceChunk = chunkType("SRCE");
+    constexpr uint32_t kFrameChunk = chunkType("FRMS");
+    constexpr uint32_t kRecoveryChunk = chunkType("RCVR");
+    constexpr uint32_t kDroppedChunk = chunkType("DROP");
+
+    constexpr uint16_t kVersion = 2;
+    /** Owner column value for slots without an owner. */
+    constexpr uint16_t kNoOwner = 0xFFFF;
+    /** Owner column value for slots owned by a source that isn't in the dictionary. */
+    constexpr uint16_t kUnknownOwner = 0xFFFE;
+    constexpr std::size_t kAlignment = 8;
+
+    constexpr std::size_t padded(std::size_t size) { return (size + kAlignment - 1) / kAlignment * kAlignment; }
+
+    struct ChunkHeader
+    {
+        uint32_t type;
+        /** Payload size, excluding this header and including padding. */
+        uint32_t size;
+        /** CRC-32C of the payload. */
+        uint32_t crc;
+        uint32_t reserved;
+    };
+    static_assert(sizeof(ChunkHeader) == 16);
+
+    struct FileHeader
+    {
+        uint16_t version;
+        uint16_t universe;
+        uint32_t reserved;
+    };
+    static_assert(sizeof(FileHeader) == 8);
+
+    struct SourceRecord
+    {
+        /** Value used in owner columns. */
+        uint16_t index;
+        uint8_t abbreviationLength;
+        uint8_t nameLength;
+        uint8_t cid[16];
+        char abbreviation[8];
+        char name[64];
+        uint32_t reserved;
+    };
+    static_assert(sizeof(SourceRecord) % kAlignment == 0);
+
+    struct RecoveryRecord
+    {
+        /** When logging restarted, in nanoseconds since the Unix epoch. */
+        int64_t time;
+        /** Bytes removed from the end of the file. */
+        uint64_t removedBytes;
+    };
+    static_assert(sizeof(RecoveryRecord) % kAlignment == 0);
+
+    struct DroppedRecord
+    {
+        /** When logging restarted, in nanoseconds since the Unix epoch. */
+        int64_t time;
+        /** Bytes discarded since the chunk before. */
+        uint64_t droppedBytes;
+    };
+    static_assert(sizeof(DroppedRecord) % kAlignment == 0);
+
+    struct FrameBlockHeader
+    {
+        uint32_t frameCount;
+        uint16_t slotCount;
+        uint16_t reserved;
+    };
+    static_assert(sizeof(FrameBlockHeader) == 8);
+
+    /**
+     * Payload size of a frame chunk.
+     */
+    constexpr std::size_t frameChunkSize(std::size_t frameCount, std::size_t slotCount)
+    {
+        return padded(sizeof(FrameBlockHeader) + frameCount * (sizeof(int64_t) + slotCount * 4));
+    }
+} // namespace sacnlogger::sacnlog
+
+#endif // SACNLOGFORMAT_H
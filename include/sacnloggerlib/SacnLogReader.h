@@ -0,0 +1,136 @@
+/**
+ * @file SacnLogReader.h
+ *
+ * @author Dan Keenan
+ * @date 10/17/26
+ * @copyright GPL-3.0-or-later
+ * Copyright (C) 2024-2026 Dan Keenan
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef SACNLOGREADER_H
+#define SACNLOGREADER_H
+
+#include <etcpal/cpp/uuid.h>
+#include <filesystem>
+#include <optional>
+#include <ostream>
+#include <span>
+#include <spdlog/common.h>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+#include "SacnLogFormat.h"
+
+namespace sacnlogger
+{
+    /**
+     * Thrown when a `.sacnlog` file can't be read.
+     */
+    class SacnLogException : public std::runtime_error
+    {
+    public:
+        using std::runtime_error::runtime_error;
+    };
+
+    /**
+     * Read `.sacnlog` files.
+     *
+     * The file is memory-mapped and frames point straight into it, so nothing is copied or parsed. Compressed (`.zst`)
+     * files are decompressed into memory instead.
+     */
+    class SacnLogReader
+    {
+    public:
+        struct Source
+        {
+            etcpal::Uuid cid;
+            std::string_view abbreviation;
+            std::string_view name;
+        };
+
+        /**
+         * One received packet.
+         *
+         * Views are valid for the lifetime of the reader.
+         */
+        struct Frame
+        {
+            spdlog::log_clock::time_point time;
+            std::span<const uint8_t> levels;
+            std::span<const uint8_t> priorities;
+            /** Indexes for source(), or one of sacnlog::kNoOwner and sacnlog::kUnknownOwner. */
+            std::span<const uint16_t> owners;
+        };
+
+        /**
+         * @throws SacnLogException if the file can't be opened or isn't a `.sacnlog` file.
+         */
+        explicit SacnLogReader(const std::filesystem::path& path);
+        ~SacnLogReader();
+
+        SacnLogReader(const SacnLogReader&) = delete;
+        SacnLogReader& operator=(const SacnLogReader&) = delete;
+
+        [[nodiscard]] uint16_t universe() const { return universe_; }
+
+        /**
+         * Read the next frame into @p frame.
+         *
+         * Reading stops at the end of the file or at the first incomplete chunk.
+         *
+         * @return FALSE when there are no more frames.
+         */
+        bool next(Frame& frame);
+
+        /**
+         * Go back to the first frame.
+         */
+        void rewind();
+
+        /**
+         * Look up an owner from Frame::owners in the dictionary as of the last frame read.
+         *
+         * @return The source, or nullptr if there is no such source.
+         */
+        [[nodiscard]] const Source* source(uint16_t ownerIndex) const;
+
+    private:
+        void map(const std::filesystem::path& path);
+        void unmap();
+
+        /**
+         * Move to the next frame chunk, reading any other chunks on the way.
+         */
+        bool nextBlock();
+
+        const uint8_t* data_ = nullptr;
+        std::size_t size_ = 0;
+        bool mapped_ = false;
+        std::vector<char> decompressed_;
+        uint16_t universe_ = 0;
+        /** Offset of the next chunk. */
+        std::size_t offset_ = 0;
+        const sacnlog::FrameBlockHeader* block_ = nullptr;
+        std::size_t frameInBlock_ = 0;
+        std::vector<std::optional<Source>> sources_;
+    };
+
+    /**
+     * Write everything in @p reader as CSV, in the same format as the CSV data log.
+     */
+    void exportCsv(SacnLogReader& reader, std::ostream& out);
+} // namespace sacnlogger
+
+#endif // SACNLOGREADER_H
@@ -0,0 +1,127 @@
+/**
+ * @file SegmentCompressor.h
+ *
+ * @author Dan Keenan
+ * @date 10/17/26
+ * @copyright GPL-3.0-or-later
+ * Copyright (C) 2024-2026 Dan Keenan
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef SEGMENTCOMPRESSOR_H
+#define SEGMENTCOMPRESSOR_H
+
+#include <atomic>
+#include <boost/signals2/signal.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+#include "ZstdStream.h"
+
+namespace sacnlogger
+{
+    /**
+     * Compress closed log segments in the background.
+     *
+     * Each segment is compressed to a temporary file next to it, read back and compared with the original, and only
+     * then renamed to `name.000001.csv.zst` and the original deleted. Time indexes are rewritten so their offsets point
+     * to zstd frames in the compressed file.
+     *
+     * The worker runs at the lowest CPU and I/O priority and is rate-limited, so it doesn't get in the way of live
+     * writes. Segments can be renamed or removed while they are being compressed; anything that does either must
+     * hold renameMutex().
+     */
+    class SegmentCompressor
+    {
+    public:
+        static constexpr std::uintmax_t kDefaultBytesPerSecond = 4 * 1024 * 1024;
+
+        /**
+         * @param level zstd compression level.
+         * @param bytesPerSecond Most bytes of segment to read per second, or 0 for no limit.
+         */
+        explicit SegmentCompressor(int level = ZstdCompressor::kDefaultLevel,
+                                   std::uintmax_t bytesPerSecond = kDefaultBytesPerSecond);
+
+        /**
+         * Stop, abandoning the segment being compressed and any still waiting.
+         */
+        ~SegmentCompressor();
+
+        SegmentCompressor(const SegmentCompressor&) = delete;
+        SegmentCompressor& operator=(const SegmentCompressor&) = delete;
+
+        /**
+         * Compress @p path once everything queued before it is done.
+         *
+         * The segment is followed if it is renamed later, so hold renameMutex() if it could be renamed meanwhile.
+         */
+        void enqueue(const std::filesystem::path& path);
+
+        /**
+         * Wait until every queued segment has been dealt with.
+         */
+        void waitIdle();
+
+        [[nodiscard]] std::mutex& renameMutex() { return renameMutex_; }
+
+        /**
+         * Bytes freed by compression so far. Safe to call from any thread.
+         */
+        [[nodiscard]] std::uintmax_t reclaimedBytes() const { return reclaimedBytes_.load(std::memory_order_relaxed); }
+
+        using SigReclaimed = boost::signals2::signal<void(std::uintmax_t)>;
+        /**
+         * Emitted from the worker thread with the bytes freed after each segment is replaced.
+         */
+        SigReclaimed sigReclaimed;
+
+    private:
+        struct Segment
+        {
+            std::filesystem::path path;
+            std::uintmax_t device;
+            std::uintmax_t inode;
+        };
+
+        void run(std::stop_token stopToken);
+        /**
+         * @return Bytes freed, or 0 if the segment was left alone.
+         */
+        std::uintmax_t compress(const Segment& segment, const std::stop_token& stopToken);
+        /**
+         * Wait long enough that @p bytes since @p start stay under the rate limit.
+         *
+         * @return FALSE if stopped while waiting.
+         */
+        bool pace(std::chrono::steady_clock::time_point start, std::uintmax_t bytes, const std::stop_token& stopToken);
+
+        int level_;
+        std::uintmax_t bytesPerSecond_;
+        std::mutex renameMutex_;
+        std::mutex mutex_;
+        std::condition_variable_any changed_;
+        std::deque<Segment> queue_;
+        bool busy_ = false;
+        std::atomic<std::uintmax_t> reclaimedBytes_{0};
+        /** Must be last, so everything above exists while it runs. */
+        std::jthread worker_;
+    };
+} // namespace sacnlogger
+
+#endif // SEGMENTCOMPRESSOR_H
@@ -0,0 +1,133 @@
+/**
+ * @file SegmentManifest.h
+ *
+ * @author Dan Keenan
+ * @date 10/17/26
+ * @copyright GPL-3.0-or-later
+ * Copyright (C) 2024-2026 Dan Keenan
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef SEGMENTMANIFEST_H
+#define SEGMENTMANIFEST_H
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <spdlog/common.h>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace sacnlogger
+{
+    /**
+     * Path of the manifest for the log @p logPath, e.g. `U00001_data.csv.manifest`.
+     */
+    [[nodiscard]] std::filesystem::path segmentManifestPath(const std::filesystem::path& logPath);
+
+    /**
+     * Path of segment @p sequence of the log @p logPath, e.g. `U00001_data.000001.csv`.
+     */
+    [[nodiscard]] std::filesystem::path segmentPath(const std::filesystem::path& logPath, uint64_t sequence);
+
+    /**
+     * Sequence number of the segment of @p logPath called @p filename, compressed or not.
+     *
+     * @return The sequence number, or std::nullopt if @p filename isn't a segment of @p logPath.
+     */
+    [[nodiscard]] std::optional<uint64_t> segmentSequence(const std::filesystem::path& logPath,
+                                                          std::string_view filename);
+
+    /**
+     * Remove segment @p sequence of the log @p logPath, whether it has been compressed or not, and its time index.
+     *
+     * Hold SegmentCompressor::renameMutex() while calling this if segments could be being compressed.
+     */
+    void removeSegment(const std::filesystem::path& logPath, uint64_t sequence);
+
+    /**
+     * Start times from the manifest of @p logPath, by sequence number.
+     */
+    [[nodiscard]] std::map<uint64_t, spdlog::log_clock::time_point> readSegmentStartTimes(
+        const std::filesystem::path& logPath);
+
+    /**
+     * The segments of a log.
+     *
+     * Logs are written as numbered segments that are never renamed: `U00001_data.000001.csv`, `U00001_data.000002.csv`,
+     * and so on. The manifest is a CSV file next to them with the time each segment was started and its name. A line is
+     * appended for each new segment, so lines for segments that have since been removed are only dropped by rewrite().
+     */
+    class SegmentManifest
+    {
+    public:
+        struct Segment
+        {
+            uint64_t sequence;
+            /** Where the segment is now, including `.zst` if it is compressed. */
+            std::filesystem::path path;
+            /** When the segment was started, if it is in the manifest. */
+            std::optional<spdlog::log_clock::time_point> startedAt;
+        };
+
+        /**
+         * Find the segments of @p logPath that exist, with their start times from the manifest.
+         */
+        explicit SegmentManifest(const std::filesystem::path& logPath);
+
+        /**
+         * Find the segments of @p logPath among @p files, with @p startTimes from readSegmentStartTimes(), so that
+         * looking at many logs only lists their directory once.
+         *
+         * @param files Regular files in the log's directory. Those that aren't segments of @p logPath are ignored.
+         */
+        SegmentManifest(const std::filesystem::path& logPath,
+                        const std::map<uint64_t, spdlog::log_clock::time_point>& startTimes,
+                        const std::vector<std::filesystem::path>& files);
+
+        /**
+         * Segments, oldest first.
+         */
+        [[nodiscard]] const std::vector<Segment>& segments() const { return segments_; }
+
+        /**
+         * Find the segment that was being written at @p time.
+         *
+         * @return The segment, or nullptr if @p time is before the first segment with a start time.
+         */
+        [[nodiscard]] const Segment* segmentAt(spdlog::log_clock::time_point time) const;
+
+        /**
+         * Replace the manifest with one that only lists segments().
+         */
+        void rewrite() const;
+
+        /**
+         * Manifest line for the segment at @p segmentPath.
+         */
+        [[nodiscard]] static std::string line(std::optional<spdlog::log_clock::time_point> startedAt,
+                                              const std::filesystem::path& segmentPath);
+
+    private:
+        void addSegments(const std::map<uint64_t, spdlog::log_clock::time_point>& startTimes,
+                         const std::vector<std::filesystem::path>& files);
+
+        std::filesystem::path logPath_;
+        std::vector<Segment> segments_;
+    };
+} // namespace sacnlogger
+
+#endif // SEGMENTMANIFEST_H
@@ -0,0 +1,153 @@
+/**
+ * @file SpscRing.h
+ *
+ * @author Dan Keenan
+ * @date 10/17/26
+ * @copyright GPL-3.0-or-later
+ * Copyright (C) 2024-2026 Dan Keenan
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef SPSCRING_H
+#define SPSCRING_H
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace sacnlogger
+{
+    /**
+     * Fixed-size, lock-free queue with one producer thread and one consumer thread.
+     *
+     * Elements are allocated up front and reused, so they are filled in place instead of being copied in:
+     * @code
+     * if (auto* item = ring.beginPush())
+     * {
+     *     // Fill *item...
+     *     ring.commitPush();
+     * }
+     * @endcode
+     */
+    template <typename T>
+    class SpscRing
+    {
+    public:
+        /**
+         * @param capacity Number of elements, rounded up to a power of 2.
+         */
+        explicit SpscRing(std::size_t capacity) :
+            slots_(std::bit_ceil(std::max<std::size_t>(capacity, 2))), mask_(slots_.size() - 1)
+        {
+        }
+
+        SpscRing(const SpscRing&) = delete;
+        SpscRing& operator=(const SpscRing&) = delete;
+
+        [[nodiscard]] std::size_t capacity() const { return slots_.size(); }
+
+        /**
+         * Producer: get the next free element.
+         *
+         * @return The element to fill, or nullptr (counted as an overrun) when the ring is full.
+         */
+        T* beginPush()
+        {
+            const auto head = head_.load(std::memory_order_relaxed);
+            if (head - cachedTail_ >= slots_.size())
+            {
+                cachedTail_ = tail_.load(std::memory_order_acquire);
+                if (head - cachedTail_ >= slots_.size())
+                {
+                    overruns_.fetch_add(1, std::memory_order_relaxed);
+                    return nullptr;
+                }
+            }
+            return &slots_[head & mask_];
+        }
+
+        /**
+         * Producer: publish the element returned by beginPush().
+         */
+        void commitPush()
+        {
+            const auto head = head_.load(std::memory_order_relaxed) + 1;
+            head_.store(head, std::memory_order_release);
+            const auto occupancy = head - tail_.load(std::memory_order_relaxed);
+            if (occupancy > highWater_.load(std::memory_order_relaxed))
+            {
+                highWater_.store(occupancy, std::memory_order_relaxed);
+            }
+        }
+
+        /**
+         * Consumer: get the oldest element.
+         *
+         * @return The element, or nullptr if the ring is empty.
+         */
+        T* front()
+        {
+            const auto tail = tail_.load(std::memory_order_relaxed);
+            if (tail == cachedHead_)
+            {
+                cachedHead_ = head_.load(std::memory_order_acquire);
+                if (tail == cachedHead_)
+                {
+                    return nullptr;
+                }
+            }
+            return &slots_[tail & mask_];
+        }
+
+        /**
+         * Consumer: release the element returned by front().
+         */
+        void pop() { tail_.store(tail_.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+        /**
+         * Number of elements waiting to be consumed.
+         */
+        [[nodiscard]] std::size_t occupancy() const
+        {
+            const auto tail = tail_.load(std::memory_order_acquire);
+            return head_.load(std::memory_order_acquire) - tail;
+        }
+
+        /**
+         * Highest occupancy seen.
+         */
+        [[nodiscard]] std::size_t highWater() const { return highWater_.load(std::memory_order_relaxed); }
+
+        /**
+         * Number of elements that could not be pushed because the ring was full.
+         */
+        [[nodiscard]] uint64_t overruns() const { return overruns_.load(std::memory_order_relaxed); }
+
+    private:
+        std::vector<T> slots_;
+        const std::size_t mask_;
+        // Keep each side's indices on their own cache line.
+        alignas(64) std::atomic<uint64_t> head_{0};
+        uint64_t cachedTail_ = 0;
+        std::atomic<uint64_t> highWater_{0};
+        std::atomic<uint64_t> overruns_{0};
+        alignas(64) std::atomic<uint64_t> tail_{0};
+        uint64_t cachedHead_ = 0;
+    };
+} // namespace sacnlogger
+
+#endif // SPSCRING_H
@@ -0,0 +1,173 @@
+/**
+ * @file StagingArea.h
+ *
+ * @author Dan Keenan
+ * @date 10/17/26
+ * @copyright GPL-3.0-or-later
+ * Copyright (C) 2024-2026 Dan Keenan
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef STAGINGAREA_H
+#define STAGINGAREA_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace sacnlogger
+{
+    /**
+     * Stage files in a directory in memory (e.g. a tmpfs), and move them to where they belong in the background.
+     *
+     * Writers write to the staged file in place of the real one, at the same offsets. Once the oldest data that hasn't
+     * been moved is older than the maximum age, or half the staging area is used, everything staged is copied to the
+     * real files in large writes and synced, so the drive sees a few big writes instead of many small ones, and
+     * writers never wait for it. What has been moved is punched out of the staged file, so it no longer uses memory.
+     *
+     * A crash of the logger loses nothing: what is left in the directory is moved when the next StagingArea starts. A
+     * power cut loses at most the maximum age.
+     *
+     * Staged files are kept under the directory by their absolute path, e.g. `/media/disk/U00001_data.000001.csv` is
+     * staged as `directory/media/disk/U00001_data.000001.csv`.
+     */
+    class StagingArea
+    {
+    public:
+        static constexpr std::uintmax_t kDefaultMaxBytes = 64 * 1024 * 1024;
+        static constexpr std::chrono::milliseconds kDefaultMaxAge{10000};
+
+        /**
+         * @param directory Where to stage files. Anything left there from before is moved first.
+         * @param maxBytes Most bytes waiting to be moved. Writers wait in reserve() beyond this.
+         * @param maxAge Longest that data waits to be moved.
+         */
+        explicit StagingArea(std::filesystem::path directory, std::uintmax_t maxBytes = kDefaultMaxBytes,
+                             std::chrono::milliseconds maxAge = kDefaultMaxAge);
+
+        /**
+         * Move everything that has been staged, then stop.
+         */
+        ~StagingArea();
+
+        StagingArea(const StagingArea&) = delete;
+        StagingArea& operator=(const StagingArea&) = delete;
+
+        [[nodiscard]] const std::filesystem::path& directory() const { return directory_; }
+
+        /**
+         * Start staging @p path, which is created if needed.
+         *
+         * @param truncate Empty @p path first. Otherwise, the staged file starts out as large as @p path, without
+         * using any memory, so it can be appended to.
+         * @param preallocateSize Space to reserve for @p path when it is created, where the filesystem supports it.
+         * What isn't used is given back by finish().
+         * @return Where to write instead of @p path.
+         */
+        [[nodiscard]] std::filesystem::path stage(const std::filesystem::path& path, bool truncate,
+                                                  std::uintmax_t preallocateSize = 0);
+
+        /**
+         * Wait until there is room for @p bytes more, then count them as waiting to be moved. Call before writing to
+         * a staged file.
+         */
+        void reserve(std::uintmax_t bytes);
+
+        /**
+         * Stop staging @p path, which won't be written to any more. The staged file is removed once the rest of it has
+         * been moved.
+         */
+        void finish(const std::filesystem::path& path);
+
+        /**
+         * Call @p callback from the mover thread once @p path has been finished and moved, or straight away if it isn't
+         * staged.
+         */
+        void whenMoved(const std::filesystem::path& path, std::function<void()> callback);
+
+        /**
+         * Move everything staged so far, and wait until it has been.
+         */
+        void flush();
+
+        /**
+         * Bytes moved so far. Safe to call from any thread.
+         */
+        [[nodiscard]] std::uintmax_t movedBytes() const { return movedBytes_.load(std::memory_order_relaxed); }
+
+    private:
+        struct Entry
+        {
+            std::filesystem::path path;
+            std::filesystem::path stagedPath;
+            int stagedFd = -1;
+            int fd = -1;
+            /** Bytes of the staged file that are already in the real one. */
+            std::uintmax_t moved = 0;
+            bool preallocated = false;
+            bool finished = false;
+            bool failed = false;
+            std::vector<std::function<void()>> whenMoved;
+        };
+
+        [[nodiscard]] std::filesystem::path stagedPathFor(const std::filesystem::path& path) const;
+        /**
+         * Move anything left from before.
+         */
+        void recover();
+        void run(std::stop_token stopToken);
+        /**
+         * Copy what has been written to @p entry since the last time.
+         *
+         * @return Bytes moved.
+         */
+        static std::uintmax_t move(Entry& entry, std::vector<char>& buffer);
+        /**
+         * Close @p entry and, unless moving it failed, remove its staged file.
+         */
+        void close(Entry& entry) const;
+
+        std::filesystem::path directory_;
+        std::uintmax_t maxBytes_;
+        std::chrono::milliseconds maxAge_;
+        std::mutex mutex_;
+        /** Wakes the mover. */
+        std::condition_variable_any moveDue_;
+        /** Wakes writers waiting for room, and flush(). */
+        std::condition_variable_any moved_;
+        /** Never erased from except by the mover, so entries stay put while it works on them. */
+        std::list<Entry> entries_;
+        /** Bytes reserved that haven't been moved. */
+        std::uintmax_t waitingBytes_ = 0;
+        /** When the oldest waiting data was reserved. */
+        std::optional<std::chrono::steady_clock::time_point> waitingSince_;
+        bool moveNow_ = false;
+        bool moving_ = false;
+        /** Counts passes of the mover, so flush() knows when one that started after it has finished. */
+        uint64_t passes_ = 0;
+        std::atomic<std::uintmax_t> movedBytes_{0};
+        /** Must be last, so everything above exists while it runs. */
+        std::jthread worker_;
+    };
+} // namespace sacnlogger
+
+#endif // STAGINGAREA_H
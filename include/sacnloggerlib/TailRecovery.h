@@ -0,0 +1,46 @@
+/**
+ * @file TailRecovery.h
+ *
+ * @author Dan Keenan
+ * @date 10/17/26
+ * @copyright GPL-3.0-or-later
+ * Copyright (C) 2024-2026 Dan Keenan
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAILRECOVERY_H
+#define TAILRECOVERY_H
+
+#include <cstdint>
+#include <filesystem>
+
+namespace sacnlogger
+{
+    /**
+     * Remove a torn end from the log segment @p path, e.g. after the power was cut while it was being written.
+     *
+     * Only the tail is read, so this takes the same time no matter how large the segment is. `.sacnlog` segments are
+     * checked chunk by chunk from their last keyframe (see TimeIndex.h), keeping the chunks that are complete and have
+     * a good checksum. Other segments are text, and keep everything up to the last complete line without NUL bytes,
+     * which some filesystems leave in place of data that never reached the disk. Index entries past the new end are
+     * removed too.
+     *
+     * Compressed segments are never appended to, so they are left as they are.
+     *
+     * @return Number of bytes removed.
+     */
+    std::uintmax_t recoverTail(const std::filesystem::path& path);
+} // namespace sacnlogger
+
+#endif // TAILRECOVERY_H
@@ -0,0 +1,76 @@
+/**
+ * @file TimeIndex.h
+ *
+ * @author Dan Keenan
+ * @date 10/17/26
+ * @copyright GPL-3.0-or-later
+ * Copyright (C) 2024-2026 Dan Keenan
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TIMEINDEX_H
+#define TIMEINDEX_H
+
+#include <cstdint>
+#include <filesystem>
+#include <spdlog/common.h>
+#include <vector>
+
+namespace sacnlogger
+{
+    /**
+     * One keyframe in a time index file.
+     *
+     * Index files are a plain array of these, in the order the keyframes were written.
+     */
+    struct TimeIndexEntry
+    {
+        /** Nanoseconds since the Unix epoch. */
+        int64_t time;
+        /** Byte offset of the keyframe in the log file. */
+        uint64_t offset;
+    };
+    static_assert(sizeof(TimeIndexEntry) == 16);
+
+    /**
+     * Path of the time index for @p logPath, e.g. `U00001_data.csv.idx`.
+     */
+    [[nodiscard]] std::filesystem::path timeIndexPath(const std::filesystem::path& logPath);
+
+    /**
+     * Find keyframes in a log file by time.
+     */
+    class TimeIndex
+    {
+    public:
+        /**
+         * Load the index for @p logPath. A missing or unreadable index is empty.
+         */
+        explicit TimeIndex(const std::filesystem::path& logPath);
+
+        [[nodiscard]] const std::vector<TimeIndexEntry>& entries() const { return entries_; }
+
+        /**
+         * Find the last keyframe at or before @p time.
+         *
+         * @return The keyframe, or nullptr if @p time is before the first one.
+         */
+        [[nodiscard]] const TimeIndexEntry* keyframeAt(spdlog::log_clock::time_point time) const;
+
+    private:
+        std::vector<TimeIndexEntry> entries_;
+    };
+} // namespace sacnlogger
+
+#endif // TIMEINDEX_H
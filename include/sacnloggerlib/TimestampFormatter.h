@@ -0,0 +1,64 @@
+/**
+ * @file TimestampFormatter.h
+ *
+ * @author Dan Keenan
+ * @date 10/17/26
+ * @copyright GPL-3.0-or-later
+ * Copyright (C) 2024-2026 Dan Keenan
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TIMESTAMPFORMATTER_H
+#define TIMESTAMPFORMATTER_H
+
+#include <array>
+#include <ctime>
+#include <optional>
+#include <spdlog/common.h>
+#include <string_view>
+
+namespace sacnlogger
+{
+    /**
+     * Format log timestamps the same way as the spdlog pattern `%Y-%m-%d %H:%M:%S.%e%z`, in local time, e.g.
+     * `2024-01-02 03:04:05.006+01:00`.
+     *
+     * Local time formatting is expensive, so it is only done once per second.
+     */
+    class TimestampFormatter
+    {
+    public:
+        /**
+         * @return The formatted time, valid until the next call.
+         */
+        std::string_view format(spdlog::log_clock::time_point time);
+
+        /**
+         * Read a timestamp written by format().
+         *
+         * @return The time, or std::nullopt if @p text isn't a timestamp.
+         */
+        [[nodiscard]] static std::optional<spdlog::log_clock::time_point> parse(std::string_view text);
+
+    private:
+        std::time_t cachedSecond_ = -1;
+        std::array<char, 32> cachedSecondText_{};
+        std::size_t cachedSecondLen_ = 0;
+        std::array<char, 8> cachedZoneText_{};
+        std::size_t cachedZoneLen_ = 0;
+        std::array<char, 48> text_{};
+    };
+} // namespace sacnlogger
+
+#endif // TIMESTAMPFORMATTER_H
@@ -0,0 +1,136 @@
+/**
+ * @file TriggerRules.h
+ *
+ * @author Dan Keenan
+ * @date 10/17/26
+ * @copyright GPL-3.0-or-later
+ * Copyright (C) 2024-2026 Dan Keenan
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRIGGERRULES_H
+#define TRIGGERRULES_H
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <spdlog/common.h>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "FrameDiff.h"
+#include "LogConfig.h"
+
+namespace sacnlogger
+{
+    /**
+     * The triggers that apply to one universe, checked against each change.
+     *
+     * Rules are sorted by what they watch when they are built, so checking a change only looks at the addresses that
+     * have rules, except for ownerChange rules on every address, which compare the owners of the whole universe.
+     */
+    class TriggerRules
+    {
+    public:
+        /**
+         * Time span to write out, and why.
+         */
+        struct Capture
+        {
+            bool operator==(const Capture&) const = default;
+
+            std::string reason;
+            /** When the first trigger fired. */
+            spdlog::log_clock::time_point at;
+            spdlog::log_clock::time_point from;
+            spdlog::log_clock::time_point until;
+
+            /**
+             * Widen this capture to also cover @p other, keeping the first reason.
+             */
+            void merge(const Capture& other);
+        };
+
+        /**
+         * Take the rules in @p triggers that apply to @p universe.
+         */
+        TriggerRules(uint16_t universe, const std::vector<Trigger>& triggers);
+
+        [[nodiscard]] bool empty() const
+        {
+            return levelRules_.empty() && ownerRules_.empty() && !anyOwnerRule_ && !sourceLostRule_;
+        }
+
+        /**
+         * Longest span a trigger captures, pre plus post.
+         */
+        [[nodiscard]] std::chrono::seconds longestCapture() const { return longestCapture_; }
+
+        /**
+         * Check a change.
+         *
+         * The first check only takes note of the universe, so levels and owners that are already there when logging
+         * starts don't fire.
+         *
+         * @param time When @p mergedData was received.
+         * @param previous Data before @p mergedData.
+         * @param changedSlots Slots that differ between @p previous and @p mergedData.
+         * @return What to capture, if any rule fired.
+         */
+        std::optional<Capture> checkFrame(spdlog::log_clock::time_point time, const ComparableData& previous,
+                                          const SacnRecvMergedData& mergedData, const SlotMask& changedSlots);
+
+        /**
+         * Check the loss of source @p name.
+         */
+        [[nodiscard]] std::optional<Capture> checkSourceLost(spdlog::log_clock::time_point time,
+                                                             std::string_view name) const;
+
+    private:
+        struct Window
+        {
+            std::chrono::seconds pre;
+            std::chrono::seconds post;
+        };
+
+        struct LevelRule
+        {
+            std::size_t slot;
+            uint8_t level;
+            Window window;
+            /** Only a change to the level fires. */
+            bool atLevel = true;
+        };
+
+        struct OwnerRule
+        {
+            std::size_t slot;
+            Window window;
+        };
+
+        static void fire(std::optional<Capture>& capture, spdlog::log_clock::time_point time, const Window& window,
+                         std::string reason);
+
+        std::vector<LevelRule> levelRules_;
+        std::vector<OwnerRule> ownerRules_;
+        /** Widest window of the ownerChange rules on every address. */
+        std::optional<Window> anyOwnerRule_;
+        /** Widest window of the sourceLost rules. */
+        std::optional<Window> sourceLostRule_;
+        std::chrono::seconds longestCapture_{0};
+        bool started_ = false;
+    };
+} // namespace sacnlogger
+
+#endif // TRIGGERRULES_H
@@ -22,13 +22,29 @@
 #ifndef UNIVERSEMONITOR_H
 #define UNIVERSEMONITOR_H
 
+#include <atomic>
+#include <chrono>
 #include <cstdint>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <sacn/cpp/merge_receiver.h>
-#include <set>
 #include <spdlog/logger.h>
+#include <string>
+#include <string_view>
+#include <thread>
 #include <unordered_set>
+#include <vector>
 #include "AbbreviationMap.h"
+#include "DataRowFormatter.h"
+#include "FlightRecorder.h"
+#include "FrameDiff.h"
+#include "LogConfig.h"
+#include "LogWriter.h"
+#include "OwnerTable.h"
+#include "SacnLogEncoder.h"
+#include "SpscRing.h"
+#include "TriggerRules.h"
 
 namespace sacnlogger
 {
@@ -44,24 +60,10 @@ namespace sacnlogger
         }
     };
 
-    /**
-     * Collection of incoming sACN data.
-     *
-     * Contains levels, priorities, and owners for comparison to determine if data has changed from the previous packet.
-     */
-    struct ComparableData
-    {
-        auto operator<=>(const ComparableData&) const = default;
-        ComparableData() = default;
-        explicit ComparableData(const SacnRecvMergedData& mergedData);
-
-        std::array<uint8_t, SACN_MERGE_RECEIVER_MAX_SLOTS> levels_{};
-        std::array<uint8_t, SACN_MERGE_RECEIVER_MAX_SLOTS> priorities_{};
-        std::array<sacn_remote_source_t, SACN_MERGE_RECEIVER_MAX_SLOTS> owners_{};
-    };
-
     /**
      * Collection of incoming sACN sources.
+     *
+     * Sources are kept sorted by handle, so that an update only needs to look up the handles that were added.
      */
     struct ComparableSources
     {
@@ -77,27 +79,128 @@ namespace sacnlogger
                 return std::tie(lhs.cid, lhs.ipAddr, lhs.name) == std::tie(rhs.cid, rhs.ipAddr, rhs.name);
             }
             friend bool operator!=(const ComparableSource& lhs, const ComparableSource& rhs) { return !(lhs == rhs); }
+            sacn_remote_source_t handle;
             etcpal::Uuid cid;
             etcpal::SockAddr ipAddr;
             std::string name;
         };
-        std::weak_ordering operator<=>(const ComparableSources&) const = default;
-        ComparableSources() = default;
-        explicit ComparableSources(sacn::MergeReceiver* mergeReceiver, const SacnRecvMergedData& mergedData);
-        std::set<ComparableSource> sources_{};
+
+        /**
+         * Cheap summary of the active source handles in @p mergedData, independent of their order.
+         */
+        [[nodiscard]] static uint64_t fingerprint(const SacnRecvMergedData& mergedData);
+
+        /**
+         * Check whether the active source handles might differ from the last update().
+         */
+        [[nodiscard]] bool handlesChanged(const SacnRecvMergedData& mergedData) const
+        {
+            return !fingerprint_ || *fingerprint_ != fingerprint(mergedData);
+        }
+
+        /**
+         * Bring the collection up to date with @p mergedData.
+         *
+         * Only handles that were not present before are looked up, unless @p recheckAll is set, in which case the
+         * details of every source are fetched again to catch sources that have been renamed or moved.
+         *
+         * @return Sources that are new or whose details have changed.
+         */
+        std::vector<ComparableSource> update(sacn::MergeReceiver* mergeReceiver, const SacnRecvMergedData& mergedData,
+                                             bool recheckAll);
+
+        std::vector<ComparableSource> sources_{};
+        std::optional<uint64_t> fingerprint_;
+    };
+
+    /**
+     * Copy of the data from one merged packet, taken on the sACN receive thread.
+     */
+    struct FrameSnapshot
+    {
+        /**
+         * Copy @p mergedData into this snapshot.
+         *
+         * Does not allocate unless there are more active sources than in any previous snapshot.
+         */
+        void assign(const SacnRecvMergedData& mergedData, spdlog::log_clock::time_point capturedAt);
+
+        /**
+         * View this snapshot as merged data.
+         */
+        [[nodiscard]] SacnRecvMergedData mergedData() const;
+
+        spdlog::log_clock::time_point capturedAt;
+        uint16_t universe = 0;
+        SacnRecvUniverseSubrange slotRange{};
+        std::array<uint8_t, SACN_MERGE_RECEIVER_MAX_SLOTS> levels{};
+        std::array<uint8_t, SACN_MERGE_RECEIVER_MAX_SLOTS> priorities{};
+        std::array<sacn_remote_source_t, SACN_MERGE_RECEIVER_MAX_SLOTS> owners{};
+        std::vector<sacn_remote_source_t> activeSources;
     };
 
     /**
      * Handle incoming universe data.
+     *
+     * Callbacks from the sACN library only copy the packet into a ring buffer, so that slow logging for one universe
+     * doesn't delay reception of the others. A worker thread does the comparison and logging.
+     *
+     * With a FlightRecorder, changes go to it instead of the data log, and it is dumped when a trigger fires or a dump
+     * is requested.
      */
     class UniverseNotifyHandler : public sacn::MergeReceiver::NotifyHandler
     {
     public:
-        explicit UniverseNotifyHandler(sacn::MergeReceiver* mergeReceiver, spdlog::logger* sourceLogger,
-                                       spdlog::logger* dataLogger) :
-            mergeReceiver_(mergeReceiver), sourceLogger_(sourceLogger), dataLogger_(dataLogger)
+        /** How often to look for changes in the details of sources that are already active. */
+        static constexpr std::chrono::seconds kSourceRecheckInterval{1};
+        /** Start a new log file when less than this is left, so a header and full row always fit. */
+        static constexpr std::uintmax_t kRotateHeadroom = 32768;
+        /** Time between rows when OverflowPolicy::Degrade has kicked in. */
+        static constexpr std::chrono::seconds kDegradedRowInterval{1};
+        /** OverflowPolicy::Degrade kicks in below this fraction of free blocks... */
+        static constexpr double kDegradeBelow = 0.25;
+        /** ...and stops above this one. */
+        static constexpr double kRecoverAbove = 0.5;
+        static constexpr auto kSourceHeader = "State,Marker,CID,IP Address,Name";
+        /** Triggers this soon after a dump are put off, so a flapping trigger can't fill the drive with dumps. */
+        static constexpr std::chrono::seconds kMinDumpInterval{10};
+        /** How often to check whether a capture is due when no packets are arriving. */
+        static constexpr std::chrono::milliseconds kCapturePollInterval{250};
+        /** How often to check whether a partly filled log block should be written out. */
+        static constexpr std::chrono::milliseconds kFlushPollInterval{10};
+
+        /**
+         * How often each overflow policy has kicked in.
+         */
+        struct OverflowCounters
         {
-        }
+            bool operator==(const OverflowCounters&) const = default;
+
+            /** Packets dropped because the queue was full. */
+            uint64_t droppedPackets = 0;
+            /** Times logging waited for the writer. */
+            uint64_t writerWaits = 0;
+            /** Blocks of rows discarded by OverflowPolicy::DropOldest. */
+            uint64_t droppedBlocks = 0;
+            /** Times OverflowPolicy::Degrade kicked in. */
+            uint64_t degradedPeriods = 0;
+            /** Rows skipped by OverflowPolicy::Degrade. */
+            uint64_t skippedRows = 0;
+        };
+
+        /**
+         * @param sourceStream Source log, which should be a priority stream so that it is never dropped.
+         * @param dataStream Data log, or nullptr when using @p flightRecorder.
+         * @param sacnLogEncoder If set, data is written in the binary `.sacnlog` format instead of CSV.
+         * @param flightRecorder If set, data is kept here instead of being logged, and written out around the
+         * triggers in LogConfig::flightRecorder.
+         */
+        explicit UniverseNotifyHandler(sacn::MergeReceiver* mergeReceiver,
+                                       std::unique_ptr<LogWriter::Stream> sourceStream,
+                                       std::unique_ptr<LogWriter::Stream> dataStream, const LogConfig& logConfig,
+                                       const QueueConfig& queueConfig,
+                                       std::unique_ptr<SacnLogEncoder> sacnLogEncoder = nullptr,
+                                       std::unique_ptr<FlightRecorder> flightRecorder = nullptr);
 
         void HandleMergedData(sacn::MergeReceiver::Handle handle, const SacnRecvMergedData& mergedData) override;
         void HandleNonDmxData(sacn::MergeReceiver::Handle receiverHandle, const etcpal::SockAddr& sourceAddr,
@@ -105,14 +208,131 @@ namespace sacnlogger
         void HandleSourcesLost(sacn::MergeReceiver::Handle handle, uint16_t universe,
                                const std::vector<SacnLostSource>& lostSources) override;
 
+        /**
+         * Packets waiting for the worker thread, with counters for occupancy and overruns.
+         */
+        [[nodiscard]] const SpscRing<FrameSnapshot>& snapshots() const { return snapshots_; }
+
+        /**
+         * Safe to call from any thread.
+         */
+        [[nodiscard]] OverflowCounters overflowCounters() const;
+
+        /**
+         * Dump the flight recorder, if there is one, once everything received so far has been added to it. Safe to
+         * call from any thread.
+         *
+         * @param reason Logged with the dump.
+         */
+        void requestDump(std::string_view reason);
+
     private:
+        /**
+         * Worker thread.
+         */
+        void run(std::stop_token stopToken);
+        /**
+         * Wake the worker thread.
+         */
+        void wake();
+
+        void processSnapshot(const FrameSnapshot& snapshot);
+        /**
+         * Add a changed packet to the flight recorder, and check the triggers.
+         */
+        void recordSnapshot(const FrameSnapshot& snapshot, const SacnRecvMergedData& mergedData,
+                            const SlotMask& changedSlots);
+        void processSourcesLost(const std::vector<SacnLostSource>& lostSources);
+        void writeSourceRow(spdlog::log_clock::time_point time, std::string_view row);
+        /**
+         * Flush the log streams whose partly filled blocks are due (see LogWriter::Stream::flushDue()).
+         *
+         * @return TRUE if any are still collecting rows.
+         */
+        bool flushDueStreams();
+        /**
+         * Write a source row to the data log for each active source, if selfContained_.
+         */
+        void writeDataSources(spdlog::log_clock::time_point time);
+
+        /**
+         * Apply OverflowPolicy::Degrade.
+         *
+         * @return TRUE if the row at @p time should be skipped.
+         */
+        bool skipWhileDegraded(spdlog::log_clock::time_point time);
+
+        /**
+         * Warn about any overflow since the last report.
+         */
+        void reportOverflow(uint16_t universe);
+
+        /**
+         * Rebuild ownerTable_ from lastSources_.
+         */
+        void updateOwnerTable();
+
+        /**
+         * Write out @p capture once its post-roll has passed. Captures that overlap one that is waiting are written
+         * together. A capture is put off until kMinDumpInterval after the last dump.
+         */
+        void triggerDump(const TriggerRules::Capture& capture);
+
+        /**
+         * Write out the waiting capture if it is due, or @p force is set.
+         */
+        void dumpPending(bool force);
+
+        /**
+         * Check whether the waiting capture's post-roll has passed, and it isn't being put off.
+         */
+        [[nodiscard]] bool captureDue() const;
+
+        /**
+         * Write out everything in the flight recorder now, for @p reason.
+         */
+        void dumpAll(std::string_view reason);
+
+        // Only used by the worker thread.
         ComparableData lastData_;
         ComparableSources lastSources_;
+        std::chrono::steady_clock::time_point lastSourceRecheck_;
         sacn::MergeReceiver* mergeReceiver_;
-        spdlog::logger* sourceLogger_;
-        spdlog::logger* dataLogger_;
+        std::unique_ptr<LogWriter::Stream> sourceStream_;
+        std::unique_ptr<LogWriter::Stream> dataStream_;
         AbbreviationMap abbreviationMap_;
         std::unordered_map<etcpal::Uuid, std::string> cidIpAddrMap_;
+        OwnerTable ownerTable_;
+        DataRowFormatter dataRowFormatter_;
+        /** Source rows for the data log, written before the next row. */
+        std::vector<std::string> pendingDataSources_;
+        /** Write source and lost data rows to the data log, see LogConfig::selfContained. */
+        bool selfContained_;
+        std::chrono::seconds checkpointPeriod_;
+        spdlog::log_clock::time_point lastKeyframeAt_;
+        std::unique_ptr<SacnLogEncoder> sacnLogEncoder_;
+        bool degraded_ = false;
+        spdlog::log_clock::time_point lastRowAt_;
+        OverflowCounters reportedOverflow_;
+        std::atomic<uint64_t> degradedPeriods_{0};
+        std::atomic<uint64_t> skippedRows_{0};
+        std::unique_ptr<FlightRecorder> flightRecorder_;
+        /** Set when there is a flight recorder. */
+        std::optional<TriggerRules> triggerRules_;
+        /** Capture waiting for its post-roll, or put off by kMinDumpInterval. */
+        std::optional<TriggerRules::Capture> pendingCapture_;
+        std::optional<std::chrono::steady_clock::time_point> lastDumpAt_;
+
+        // Shared with the sACN receive thread.
+        SpscRing<FrameSnapshot> snapshots_;
+        std::mutex lostSourcesMutex_;
+        std::vector<SacnLostSource> lostSources_;
+        std::mutex dumpRequestMutex_;
+        std::optional<std::string> dumpRequest_;
+        std::atomic<uint32_t> wakeups_{0};
+
+        /** Must be last, so everything above exists while it runs. */
+        std::jthread worker_;
     };
 
     /**
@@ -122,24 +342,43 @@ namespace sacnlogger
     {
     public:
         explicit UniverseMonitor(uint16_t universe) : universe_(universe) {}
+        ~UniverseMonitor();
+        UniverseMonitor(UniverseMonitor&&) = default;
         [[nodiscard]] uint16_t universe() const { return universe_; }
         void setUniverse(uint16_t universe) { universe_ = universe; }
         [[nodiscard]] bool usePap() const { return usePap_; }
         void setUsePap(bool usePap) { usePap_ = usePap; }
+        [[nodiscard]] const LogConfig& logConfig() const { return logConfig_; }
+        void setLogConfig(const LogConfig& logConfig) { logConfig_ = logConfig; }
+        [[nodiscard]] const std::shared_ptr<LogWriter>& logWriter() const { return logWriter_; }
+        /**
+         * Share a writer thread with other monitors. If none is set, start() creates one.
+         */
+        void setLogWriter(std::shared_ptr<LogWriter> logWriter) { logWriter_ = std::move(logWriter); }
+        [[nodiscard]] unsigned int maxLogFileCount() const { return maxLogFileCount_; }
+        /**
+         * Finished files to keep for each log, or LogWriter::kKeepAllSegments to leave it to a RetentionManager.
+         */
+        void setMaxLogFileCount(unsigned int maxLogFileCount) { maxLogFileCount_ = maxLogFileCount; }
+        [[nodiscard]] unsigned long maxLogFileSize() const { return maxLogFileSize_; }
+        void setMaxLogFileSize(unsigned long maxLogFileSize) { maxLogFileSize_ = maxLogFileSize; }
 
         void start();
 
-    private:
-        static constexpr auto kLoggerPattern = "%Y-%m-%d %H:%M:%S.%e%z,%v";
+        /**
+         * Dump the flight recorder, if there is one. Safe to call from any thread.
+         */
+        void requestDump(std::string_view reason);
 
-        std::shared_ptr<spdlog::logger> sourceLogger_;
-        std::shared_ptr<spdlog::logger> dataLogger_;
+    private:
+        std::shared_ptr<LogWriter> logWriter_;
         std::unique_ptr<sacn::MergeReceiver, MergeReceiverDeleter> mergeReceiver_;
         std::unique_ptr<UniverseNotifyHandler> notifyHandler_;
-        unsigned int maxLogFileCount = 99;
-        unsigned long maxLogFileSize = 20971520; // 20 MB
+        unsigned int maxLogFileCount_ = 99;
+        unsigned long maxLogFileSize_ = 20971520; // 20 MB
         uint16_t universe_;
         bool usePap_ = false;
+        LogConfig logConfig_;
     };
 
 } // namespace sacnlogger
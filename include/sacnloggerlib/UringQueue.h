@@ -0,0 +1,125 @@
+/**
+ * @file UringQueue.h
+ *
+ * @author Dan Keenan
+ * @date 10/17/26
+ * @copyright GPL-3.0-or-later
+ * Copyright (C) 2024-2026 Dan Keenan
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef URINGQUEUE_H
+#define URINGQUEUE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+namespace sacnlogger
+{
+    /**
+     * Minimal io_uring submission and completion queue, for writing files without waiting for each write.
+     *
+     * Talks to the kernel directly, as only writes and syncs are needed. Not thread-safe.
+     *
+     * LogWriter submits each batch of blocks, and each group commit, at once, so writes and syncs to different files
+     * are in flight together instead of one after another. Blocks are written from where they are in the pool, which
+     * is registered with the kernel when `RLIMIT_MEMLOCK` allows. Anything that fails or comes up short is finished
+     * with a plain write.
+     */
+    class UringQueue
+    {
+    public:
+        struct Completion
+        {
+            /** Tag given when the operation was queued. */
+            uint64_t tag;
+            /** Bytes written, 0 for a sync, or -errno. */
+            int32_t result;
+        };
+
+        /**
+         * @param depth Most operations that can be in flight at once.
+         * @return The queue, or nullptr if io_uring isn't available (e.g. an old kernel, or disabled with the
+         * `kernel.io_uring_disabled` sysctl).
+         */
+        [[nodiscard]] static std::unique_ptr<UringQueue> create(unsigned int depth);
+
+        ~UringQueue();
+
+        UringQueue(const UringQueue&) = delete;
+        UringQueue& operator=(const UringQueue&) = delete;
+
+        [[nodiscard]] unsigned int depth() const { return depth_; }
+
+        /**
+         * Operations queued or submitted that haven't been returned by wait() yet.
+         */
+        [[nodiscard]] unsigned int inFlight() const { return inFlight_; }
+
+        /**
+         * Register @p size bytes at @p data with the kernel, so writes from there don't have to map the pages each
+         * time. This fails if it would lock more memory than `RLIMIT_MEMLOCK` allows.
+         */
+        bool registerBuffer(void* data, std::size_t size);
+
+        /**
+         * Queue writing @p size bytes at @p data to @p fd at @p offset.
+         *
+         * The data must stay in place until the write is returned by wait(). There must be room for the write in
+         * depth(), and for the sync too if there is one.
+         *
+         * @param sync Queue `fdatasync()` of @p fd once the write has finished, with the same tag. It is cancelled if
+         * the write fails or is short.
+         */
+        void write(int fd, const void* data, std::size_t size, uint64_t offset, uint64_t tag, bool sync = false);
+
+        /**
+         * Submit everything queued and wait for the next operation to finish. inFlight() must not be 0.
+         */
+        Completion wait();
+
+    private:
+        UringQueue() = default;
+        ::io_uring_sqe* nextSqe();
+        void enter(unsigned int minComplete);
+
+        unsigned int depth_ = 0;
+        int ringFd_ = -1;
+        void* sqRing_ = nullptr;
+        std::size_t sqRingSize_ = 0;
+        void* cqRing_ = nullptr;
+        std::size_t cqRingSize_ = 0;
+        ::io_uring_sqe* sqes_ = nullptr;
+        std::size_t sqesSize_ = 0;
+        unsigned int* sqHead_ = nullptr;
+        unsigned int* sqTail_ = nullptr;
+        unsigned int sqMask_ = 0;
+        unsigned int sqEntries_ = 0;
+        unsigned int* sqArray_ = nullptr;
+        unsigned int* cqHead_ = nullptr;
+        unsigned int* cqTail_ = nullptr;
+        unsigned int cqMask_ = 0;
+        ::io_uring_cqe* cqes_ = nullptr;
+        const char* buffer_ = nullptr;
+        std::size_t bufferSize_ = 0;
+        unsigned int toSubmit_ = 0;
+        unsigned int inFlight_ = 0;
+    };
+} // namespace sacnlogger
+
+#endif // URINGQUEUE_H
@@ -0,0 +1,118 @@
+/**
+ * @file ZstdStream.h
+ *
+ * @author Dan Keenan
+ * @date 10/17/26
+ * @copyright GPL-3.0-or-later
+ * Copyright (C) 2024-2026 Dan Keenan
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef ZSTDSTREAM_H
+#define ZSTDSTREAM_H
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+struct ZSTD_CCtx_s;
+struct ZSTD_DCtx_s;
+
+namespace sacnlogger
+{
+    /**
+     * Streaming zstd compression for log files.
+     *
+     * Output is flushed after every call, so everything handed to compress() can be decompressed from what has been
+     * written. Frames are ended every kMaxFrameInput bytes, so a damaged file can still be read from the next frame on.
+     */
+    class ZstdCompressor
+    {
+    public:
+        static constexpr std::size_t kMaxFrameInput = 1024 * 1024;
+        static constexpr int kDefaultLevel = 3;
+
+        explicit ZstdCompressor(int level = kDefaultLevel);
+        ~ZstdCompressor();
+
+        ZstdCompressor(const ZstdCompressor&) = delete;
+        ZstdCompressor& operator=(const ZstdCompressor&) = delete;
+
+        /**
+         * Compress @p data, appending the output to @p out.
+         */
+        void compress(std::string_view data, std::vector<char>& out);
+
+        /**
+         * Finish the current frame, if there is one, appending the output to @p out.
+         */
+        void endFrame(std::vector<char>& out);
+
+        /**
+         * Forget the current frame, e.g. because the file it was going to was replaced.
+         */
+        void reset();
+
+    private:
+        void run(std::string_view data, std::vector<char>& out, int directive);
+
+        std::unique_ptr<ZSTD_CCtx_s, std::size_t (*)(ZSTD_CCtx_s*)> cctx_;
+        std::size_t frameInput_ = 0;
+    };
+
+    /**
+     * Streaming zstd decompression that stops at the first damaged frame, for checking what was written.
+     */
+    class ZstdDecompressor
+    {
+    public:
+        ZstdDecompressor();
+        ~ZstdDecompressor();
+
+        ZstdDecompressor(const ZstdDecompressor&) = delete;
+        ZstdDecompressor& operator=(const ZstdDecompressor&) = delete;
+
+        /**
+         * Decompress @p data, appending the output to @p out.
+         *
+         * @return FALSE if the data is damaged.
+         */
+        [[nodiscard]] bool decompress(std::string_view data, std::vector<char>& out);
+
+        /**
+         * Check if everything given to decompress() so far ends with a complete frame.
+         */
+        [[nodiscard]] bool frameComplete() const { return frameComplete_; }
+
+    private:
+        std::unique_ptr<ZSTD_DCtx_s, std::size_t (*)(ZSTD_DCtx_s*)> dctx_;
+        bool frameComplete_ = true;
+    };
+
+    /**
+     * Check if @p path is a compressed log file.
+     */
+    [[nodiscard]] inline bool isCompressed(const std::filesystem::path& path) { return path.extension() == ".zst"; }
+
+    /**
+     * Decompress @p path from @p offset to the end.
+     *
+     * Damaged data is skipped up to the start of the next frame.
+     */
+    [[nodiscard]] std::vector<char> decompressFile(const std::filesystem::path& path, std::uintmax_t offset = 0);
+} // namespace sacnlogger
+
+#endif // ZSTDSTREAM_H
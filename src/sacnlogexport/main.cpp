@@ -0,0 +1,85 @@
+/**
+ * @file main.cpp
+ *
+ * @author Dan Keenan
+ * @date 10/17/26
+ * @copyright GPL-3.0-or-later
+ * Copyright (C) 2024-2026 Dan Keenan
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <argparse/argparse.hpp>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+#include "sacnlogger_config.h"
+#include "sacnloggerlib/SacnLogReader.h"
+#include "sacnloggerlib/ZstdStream.h"
+
+int main(int argc, char* argv[])
+{
+    argparse::ArgumentParser parser("sacnlogexport", sacnlogger::config::kProjectVersion);
+    parser.add_description("Convert a .sacnlog data log to CSV.");
+    parser.add_argument("input").help("path to .sacnlog or .sacnlog.zst file");
+    parser.add_argument("output")
+        .help("path to CSV file, or - for standard output; defaults to the input path with a .csv extension")
+        .default_value(std::string());
+    try
+    {
+        parser.parse_args(argc, argv);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        std::cerr << parser;
+        return EXIT_FAILURE;
+    }
+
+    const std::filesystem::path inputPath = parser.get<std::string>("input");
+    std::filesystem::path outputPath = parser.get<std::string>("output");
+    if (outputPath.empty())
+    {
+        outputPath = inputPath;
+        if (sacnlogger::isCompressed(outputPath))
+        {
+            outputPath.replace_extension();
+        }
+        outputPath.replace_extension(".csv");
+    }
+
+    try
+    {
+        sacnlogger::SacnLogReader reader(inputPath);
+        if (outputPath == "-")
+        {
+            sacnlogger::exportCsv(reader, std::cout);
+            return EXIT_SUCCESS;
+        }
+        std::ofstream out(outputPath);
+        if (!out)
+        {
+            std::cerr << "Could not open " << outputPath.string() << std::endl;
+            return EXIT_FAILURE;
+        }
+        sacnlogger::exportCsv(reader, out);
+    }
+    catch (const sacnlogger::SacnLogException& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
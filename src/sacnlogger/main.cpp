@@ -20,6 +20,7 @@
  */
 
 #include <argparse/argparse.hpp>
+#include <atomic>
 #include <csignal>
 #include <etcpal/common.h>
 #include <sacn/cpp/common.h>
@@ -35,10 +36,15 @@
 #include "sacnloggerlib/Runner.h"
 #include "sacnloggerlib/UniverseMonitor.h"
 
-bool termRequested = false;
+// Set from signal handlers and read from another thread, which only lock-free atomics are safe for.
+std::atomic<bool> termRequested = false;
+std::atomic<bool> dumpRequested = false;
+static_assert(std::atomic<bool>::is_always_lock_free);
 
 void requestTerm(int) { termRequested = true; }
 
+void requestDump(int) { dumpRequested = true; }
+
 void sacnCleanup()
 {
     sacn::Deinit();
@@ -84,6 +90,10 @@ int main(int argc, char* argv[])
 #ifdef SIGQUIT
     std::signal(SIGQUIT, &requestTerm);
 #endif
+#ifdef SIGUSR1
+    // Dump the flight recorder.
+    std::signal(SIGUSR1, &requestDump);
+#endif
 
     // Load config.
     sacnlogger::Config config;
@@ -100,10 +110,14 @@ int main(int argc, char* argv[])
     runner.start();
 
     auto waiter = std::thread(
-        []()
+        [&runner]()
         {
             while (!termRequested)
             {
+                if (dumpRequested.exchange(false))
+                {
+                    runner.requestDump("requested by signal");
+                }
                 std::this_thread::sleep_for(std::chrono::seconds(1));
             }
         });
@@ -20,33 +20,88 @@
  */
 
 #include "sacnloggerlib/AbbreviationMap.h"
+#include <algorithm>
+#include <bit>
+#include <cstring>
 
 namespace sacnlogger
 {
-    std::string AbbreviationMap::abbreviationForUuid(const etcpal::Uuid& cid)
+    namespace
     {
-        auto& abbreviation = abbreviations_[cid];
-        if (abbreviation.empty())
+        std::size_t hashUuid(const etcpal::Uuid& cid)
         {
-            abbreviation = nextAbbreviation_;
-            bool incremented = false;
-            for (auto it = nextAbbreviation_.rbegin(); !incremented && it != nextAbbreviation_.rend(); ++it)
+            uint64_t lo;
+            uint64_t hi;
+            std::memcpy(&lo, cid.data(), sizeof(lo));
+            std::memcpy(&hi, cid.data() + sizeof(lo), sizeof(hi));
+            // Most CIDs are random already; mix both halves in case they aren't.
+            return (lo ^ std::rotl(hi, 31)) * 0x9E3779B97F4A7C15ull >> 16;
+        }
+    } // namespace
+
+    std::string_view AbbreviationMap::abbreviationForUuid(const etcpal::Uuid& cid)
+    {
+        if (slots_.empty())
+        {
+            grow();
+        }
+        auto* slot = &findSlot(cid);
+        if (slot->index == kEmpty)
+        {
+            // Keep at least half of the slots empty.
+            if ((abbreviations_.size() + 1) * 2 > slots_.size())
             {
-                if (*it == 'Z')
-                {
-                    *it = 'A';
-                }
-                else
-                {
-                    ++(*it);
-                    incremented = true;
-                }
+                grow();
+                slot = &findSlot(cid);
             }
-            if (!incremented)
+            slot->cid = cid;
+            slot->index = abbreviations_.size();
+            abbreviations_.push_back(abbreviationForIndex(slot->index));
+        }
+        const auto& abbreviation = abbreviations_[slot->index];
+        return {abbreviation.data(), static_cast<std::size_t>(abbreviation.back())};
+    }
+
+    AbbreviationMap::Abbreviation AbbreviationMap::abbreviationForIndex(std::size_t index)
+    {
+        // Bijective base-26: A = 0, Z = 25, AA = 26, ...
+        Abbreviation r{};
+        std::size_t len = 0;
+        ++index;
+        while (index > 0 && len < r.size() - 1)
+        {
+            --index;
+            r[len++] = static_cast<char>('A' + index % 26);
+            index /= 26;
+        }
+        std::reverse(r.begin(), r.begin() + len);
+        r.back() = static_cast<char>(len);
+        return r;
+    }
+
+    AbbreviationMap::Slot& AbbreviationMap::findSlot(const etcpal::Uuid& cid)
+    {
+        const auto mask = slots_.size() - 1;
+        for (auto ix = hashUuid(cid) & mask;; ix = (ix + 1) & mask)
+        {
+            auto& slot = slots_[ix];
+            if (slot.index == kEmpty || slot.cid == cid)
+            {
+                return slot;
+            }
+        }
+    }
+
+    void AbbreviationMap::grow()
+    {
+        auto oldSlots = std::move(slots_);
+        slots_.assign(std::max<std::size_t>(oldSlots.size() * 2, 64), Slot{});
+        for (const auto& oldSlot : oldSlots)
+        {
+            if (oldSlot.index != kEmpty)
             {
-                nextAbbreviation_.insert(nextAbbreviation_.begin(), 'A');
+                findSlot(oldSlot.cid) = oldSlot;
             }
         }
-        return abbreviation;
     }
 } // namespace sacnlogger
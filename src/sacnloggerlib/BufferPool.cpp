@@ -0,0 +1,78 @@
+/**
+ * @file BufferPool.cpp
+ *
+ * @author Dan Keenan
+ * @date 10/17/26
+ * @copyright GPL-3.0-or-later
+ * Copyright (C) 2024-2026 Dan Keenan
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "sacnloggerlib/BufferPool.h"
+
+namespace sacnlogger
+{
+    BufferPool::BufferPool(std::size_t blockCount, std::size_t blockSize) :
+        blockSize_(blockSize), storage_(std::make_unique<char[]>(blockCount * blockSize))
+    {
+        blocks_.reserve(blockCount);
+        free_.reserve(blockCount);
+        for (std::size_t ix = 0; ix < blockCount; ++ix)
+        {
+            blocks_.push_back({.data = storage_.get() + ix * blockSize, .capacity = blockSize});
+        }
+        for (auto& block : blocks_)
+        {
+            free_.push_back(&block);
+        }
+    }
+
+    BufferPool::Block* BufferPool::acquire(std::size_t reserve)
+    {
+        std::unique_lock lock(mutex_);
+        blockReleased_.wait(lock, [this, reserve]() { return free_.size() > reserve; });
+        auto* block = free_.back();
+        free_.pop_back();
+        return block;
+    }
+
+    BufferPool::Block* BufferPool::tryAcquire(std::size_t reserve)
+    {
+        const std::scoped_lock lock(mutex_);
+        if (free_.size() <= reserve)
+        {
+            return nullptr;
+        }
+        auto* block = free_.back();
+        free_.pop_back();
+        return block;
+    }
+
+    void BufferPool::release(Block* block)
+    {
+        block->size = 0;
+        {
+            const std::scoped_lock lock(mutex_);
+            free_.push_back(block);
+        }
+        // Waiters may have different reserves, so make sure the one that can use this block sees it.
+        blockReleased_.notify_all();
+    }
+
+    std::size_t BufferPool::freeCount() const
+    {
+        const std::scoped_lock lock(mutex_);
+        return free_.size();
+    }
+} // namespace sacnlogger
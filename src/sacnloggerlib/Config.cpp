@@ -33,6 +33,7 @@
 constexpr auto kUniverses = "universes";
 constexpr auto kUsePap = "usePap";
 constexpr auto kSystem = "system";
+constexpr auto kLog = "log";
 
 namespace sacnlogger
 {
@@ -57,6 +58,7 @@ namespace sacnlogger
 #ifdef SACNLOGGER_SYSTEM_CONFIG
             {kSystem, value.systemConfig},
 #endif
+            {kLog, value.logConfig},
         };
     }
 
@@ -77,6 +79,10 @@ namespace sacnlogger
             it->get_to(value.systemConfig);
         }
 #endif
+        if ((it = j.find(kLog)) != j.end())
+        {
+            it->get_to(value.logConfig);
+        }
     }
 
     Config Config::loadFromFile(const std::string& filename)
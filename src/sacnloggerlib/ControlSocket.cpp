@@ -0,0 +1,143 @@
+/**
+ * @file ControlSocket.cpp
+ *
+ * @author Dan Keenan
+ * @date 10/17/26
+ * @copyright GPL-3.0-or-later
+ * Copyright (C) 2024-2026 Dan Keenan
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "sacnloggerlib/ControlSocket.h"
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <spdlog/spdlog.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace sacnlogger
+{
+    namespace
+    {
+        std::string_view trim(std::string_view text)
+        {
+            constexpr std::string_view kWhitespace = " \t\r\n";
+            const auto first = text.find_first_not_of(kWhitespace);
+            if (first == std::string_view::npos)
+            {
+                return {};
+            }
+            return text.substr(first, text.find_last_not_of(kWhitespace) - first + 1);
+        }
+    } // namespace
+
+    ControlSocket::ControlSocket(std::filesystem::path path) : path_(std::move(path))
+    {
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        if (path_.native().size() >= sizeof(addr.sun_path))
+        {
+            SPDLOG_ERROR("Control socket path {} is too long", path_.string());
+            return;
+        }
+        std::ranges::copy(path_.native(), addr.sun_path);
+
+        std::error_code ec;
+        std::filesystem::create_directories(path_.parent_path(), ec);
+        // Left behind if the logger didn't stop cleanly.
+        std::filesystem::remove(path_, ec);
+        fd_ = ::socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+        if (fd_ < 0 || ::bind(fd_, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0)
+        {
+            SPDLOG_ERROR("Failed opening control socket {}: {}", path_.string(), std::strerror(errno));
+            if (fd_ >= 0)
+            {
+                ::close(fd_);
+                fd_ = -1;
+            }
+            return;
+        }
+        worker_ = std::jthread([this](std::stop_token stopToken) { run(std::move(stopToken)); });
+    }
+
+    ControlSocket::~ControlSocket()
+    {
+        if (fd_ < 0)
+        {
+            return;
+        }
+        worker_.request_stop();
+        // Wakes the worker from recv().
+        ::shutdown(fd_, SHUT_RDWR);
+        if (worker_.joinable())
+        {
+            worker_.join();
+        }
+        ::close(fd_);
+        std::error_code ec;
+        std::filesystem::remove(path_, ec);
+    }
+
+    void ControlSocket::run(std::stop_token stopToken)
+    {
+        std::array<char, 256> buffer{};
+        while (!stopToken.stop_requested())
+        {
+            const auto size = ::recv(fd_, buffer.data(), buffer.size(), 0);
+            if (size < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                SPDLOG_ERROR("Failed reading control socket {}: {}", path_.string(), std::strerror(errno));
+                return;
+            }
+            if (stopToken.stop_requested())
+            {
+                return;
+            }
+            handle({buffer.data(), static_cast<std::size_t>(size)});
+        }
+    }
+
+    void ControlSocket::handle(std::string_view command)
+    {
+        command = trim(command);
+        const auto verb = command.substr(0, command.find(' '));
+        const auto argument = trim(command.substr(verb.size()));
+        if (verb == "dump")
+        {
+            if (argument.empty())
+            {
+                SPDLOG_INFO("Dump requested for all universes");
+                sigDump(std::nullopt);
+                return;
+            }
+            uint16_t universe = 0;
+            const auto result = std::from_chars(argument.data(), argument.data() + argument.size(), universe);
+            if (result.ec == std::errc() && result.ptr == argument.data() + argument.size())
+            {
+                SPDLOG_INFO("Dump requested for universe {}", universe);
+                sigDump(universe);
+                return;
+            }
+        }
+        SPDLOG_WARN("Unknown control command \"{}\"", command);
+    }
+} // namespace sacnlogger
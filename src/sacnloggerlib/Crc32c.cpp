@@ -0,0 +1,88 @@
+/**
+ * @file Crc32c.cpp
+ *
+ * @author Dan Keenan
+ * @date 10/17/26
+ * @copyright GPL-3.0-or-later
+ * Copyright (C) 2024-2026 Dan Keenan
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "sacnloggerlib/Crc32c.h"
+#include <array>
+#include <cstring>
+
+namespace sacnlogger
+{
+    namespace
+    {
+        using Table = std::array<std::array<uint32_t, 256>, 8>;
+
+        /**
+         * Tables for slicing-by-8, which handles 8 bytes per step instead of 1.
+         */
+        constexpr Table makeTable()
+        {
+            constexpr uint32_t kPolynomial = 0x82F63B78;
+            Table table{};
+            for (uint32_t byte = 0; byte < 256; ++byte)
+            {
+                uint32_t crc = byte;
+                for (int bit = 0; bit < 8; ++bit)
+                {
+                    crc = (crc >> 1) ^ ((crc & 1) != 0 ? kPolynomial : 0);
+                }
+                table[0][byte] = crc;
+            }
+            for (uint32_t byte = 0; byte < 256; ++byte)
+            {
+                for (std::size_t slice = 1; slice < table.size(); ++slice)
+                {
+                    const auto previous = table[slice - 1][byte];
+                    table[slice][byte] = (previous >> 8) ^ table[0][previous & 0xFF];
+                }
+            }
+            return table;
+        }
+
+        constexpr Table kTable = makeTable();
+    } // namespace
+
+    uint32_t crc32c(const void* data, std::size_t size, uint32_t crc)
+    {
+        const auto* bytes = static_cast<const uint8_t*>(data);
+        crc = ~crc;
+        while (size >= 8)
+        {
+            // Little-endian, like everything else this checksums.
+            uint32_t low;
+            uint32_t high;
+            std::memcpy(&low, bytes, sizeof(low));
+            std::memcpy(&high, bytes + 4, sizeof(high));
+            low ^= crc;
+            crc = kTable[7][low & 0xFF] ^ kTable[6][(low >> 8) & 0xFF] ^ kTable[5][(low >> 16) & 0xFF] ^
+                  kTable[4][low >> 24] ^ kTable[3][high & 0xFF] ^ kTable[2][(high >> 8) & 0xFF] ^
+                  kTable[1][(high >> 16) & 0xFF] ^ kTable[0][high >> 24];
+            bytes += 8;
+            size -= 8;
+        }
+        while (size > 0)
+        {
+            crc = (crc >> 8) ^ kTable[0][(crc ^ *bytes) & 0xFF];
+            ++bytes;
+            --size;
+        }
+        return ~crc;
+    }
+} // namespace sacnlogger
@@ -23,30 +23,20 @@
 
 namespace sacnlogger
 {
-    CsvRow& CsvRow::operator<<(const std::string& val)
+    CsvRow& CsvRow::operator<<(std::string_view val)
     {
-        stream_ << '"';
-        for (const auto c : val)
+        buffer_.push_back('"');
+        std::size_t start = 0;
+        for (auto quote = val.find('"'); quote != std::string_view::npos; quote = val.find('"', start))
         {
-            stream_ << c;
             // Escape quotation mark with additional quotation mark.
-            if (c == '"')
-            {
-                stream_ << '"';
-            }
+            buffer_.append(val.data() + start, quote + 1 - start);
+            buffer_.push_back('"');
+            start = quote + 1;
         }
-        stream_ << "\",";
+        buffer_.append(val.data() + start, val.size() - start);
+        buffer_.append("\",");
 
         return *this;
     }
-
-    std::string CsvRow::string() const
-    {
-        auto s = stream_.str();
-        if (!s.empty())
-        {
-            s.pop_back();
-        }
-        return s;
-    }
 } // namespace sacnlogger
@@ -0,0 +1,255 @@
+/**
+ * @file DataLogReader.cpp
+ *
+ * @author Dan Keenan
+ * @date 10/17/26
+ * @copyright GPL-3.0-or-later
+ * Copyright (C) 2024-2026 Dan Keenan
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "sacnloggerlib/DataLogReader.h"
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <sacn/merge_receiver.h>
+#include <sstream>
+#include "sacnloggerlib/DataRowFormatter.h"
+#include "sacnloggerlib/TimeIndex.h"
+#include "sacnloggerlib/TimestampFormatter.h"
+#include "sacnloggerlib/ZstdStream.h"
+
+namespace sacnlogger
+{
+    namespace
+    {
+        /**
+         * Split a CSV row written by CsvRow into fields.
+         */
+        class CsvFieldReader
+        {
+        public:
+            explicit CsvFieldReader(std::string_view row) : row_(row) {}
+
+            /**
+             * @return FALSE at the end of the row.
+             */
+            bool next(std::string& field)
+            {
+                if (done_)
+                {
+                    return false;
+                }
+                field.clear();
+                std::size_t pos = 0;
+                if (!row_.empty() && row_.front() == '"')
+                {
+                    for (pos = 1; pos < row_.size(); ++pos)
+                    {
+                        if (row_[pos] != '"')
+                        {
+                            field.push_back(row_[pos]);
+                        }
+                        else if (pos + 1 < row_.size() && row_[pos + 1] == '"')
+                        {
+                            field.push_back('"');
+                            ++pos;
+                        }
+                        else
+                        {
+                            ++pos;
+                            break;
+                        }
+                    }
+                }
+                else
+                {
+                    pos = std::min(row_.find(','), row_.size());
+                    field.assign(row_.substr(0, pos));
+                }
+                if (pos >= row_.size())
+                {
+                    done_ = true;
+                }
+                else
+                {
+                    row_.remove_prefix(pos + 1);
+                }
+                return true;
+            }
+
+        private:
+            std::string_view row_;
+            bool done_ = false;
+        };
+
+        bool toByte(std::string_view text, uint8_t& value)
+        {
+            const auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+            return result.ec == std::errc() && result.ptr == text.data() + text.size();
+        }
+
+        void setSlot(UniverseState& state, std::size_t slot, uint8_t level, uint8_t priority, std::string owner)
+        {
+            if (slot >= state.levels.size())
+            {
+                state.levels.resize(slot + 1);
+                state.priorities.resize(slot + 1);
+                state.owners.resize(slot + 1);
+            }
+            state.levels[slot] = level;
+            state.priorities[slot] = priority;
+            state.owners[slot] = std::move(owner);
+        }
+
+        /**
+         * Apply a delta row field, `address:level:priority:owner`.
+         */
+        void applyDelta(UniverseState& state, std::string_view field)
+        {
+            std::array<std::string_view, 4> parts;
+            for (std::size_t ix = 0; ix < parts.size() - 1; ++ix)
+            {
+                const auto colon = field.find(':');
+                if (colon == std::string_view::npos)
+                {
+                    return;
+                }
+                parts[ix] = field.substr(0, colon);
+                field.remove_prefix(colon + 1);
+            }
+            parts.back() = field;
+
+            unsigned int address = 0;
+            uint8_t level = 0;
+            uint8_t priority = 0;
+            const auto result = std::from_chars(parts[0].data(), parts[0].data() + parts[0].size(), address);
+            if (result.ec != std::errc() || address == 0 || address > SACN_MERGE_RECEIVER_MAX_SLOTS ||
+                !toByte(parts[1], level) || !toByte(parts[2], priority))
+            {
+                return;
+            }
+            setSlot(state, address - 1, level, priority, std::string(parts[3]));
+        }
+    } // namespace
+
+    std::optional<UniverseState> readDataLogState(const std::filesystem::path& path, spdlog::log_clock::time_point time)
+    {
+        std::error_code ec;
+        const auto fileSize = std::filesystem::file_size(path, ec);
+        if (ec)
+        {
+            return std::nullopt;
+        }
+        const TimeIndex index(path);
+        const auto* keyframe = index.keyframeAt(time);
+        // If the index doesn't match the file, read all of it.
+        const auto offset = keyframe != nullptr && keyframe->offset < fileSize ? keyframe->offset : 0;
+
+        std::unique_ptr<std::istream> file;
+        if (isCompressed(path))
+        {
+            const auto contents = decompressFile(path, offset);
+            file = std::make_unique<std::istringstream>(std::string(contents.begin(), contents.end()));
+        }
+        else
+        {
+            file = std::make_unique<std::ifstream>(path, std::ios::binary);
+            file->seekg(static_cast<std::streamoff>(offset));
+        }
+
+        std::optional<UniverseState> state;
+        std::map<std::string, std::string> sourceNames;
+        std::string line;
+        std::string field;
+        std::vector<std::string> fields;
+        while (std::getline(*file, line))
+        {
+            CsvFieldReader reader(line);
+            if (!reader.next(field))
+            {
+                continue;
+            }
+            const auto rowTime = TimestampFormatter::parse(field);
+            if (!rowTime)
+            {
+                continue;
+            }
+            if (*rowTime > time)
+            {
+                break;
+            }
+
+            fields.clear();
+            while (reader.next(field))
+            {
+                fields.push_back(field);
+            }
+            if (fields.empty() || fields.front().ends_with(" Lvl"))
+            {
+                // Header.
+                continue;
+            }
+            if (fields.front() == DataRowFormatter::kSourceMarker)
+            {
+                if (fields.size() >= 5)
+                {
+                    sourceNames.insert_or_assign(fields[1], fields[4]);
+                }
+                continue;
+            }
+            if (fields.front() == DataRowFormatter::kRecoveryMarker ||
+                fields.front() == DataRowFormatter::kDroppedMarker)
+            {
+                continue;
+            }
+            if (!state)
+            {
+                state.emplace();
+            }
+            state->time = *rowTime;
+            if (fields.front().find(':') != std::string::npos)
+            {
+                for (const auto& delta : fields)
+                {
+                    applyDelta(*state, delta);
+                }
+            }
+            else
+            {
+                // Full row; slots it doesn't cover are unused.
+                state->levels.clear();
+                state->priorities.clear();
+                state->owners.clear();
+                for (std::size_t ix = 0; ix + 2 < fields.size(); ix += 3)
+                {
+                    uint8_t level = 0;
+                    uint8_t priority = 0;
+                    toByte(fields[ix], level);
+                    toByte(fields[ix + 1], priority);
+                    setSlot(*state, ix / 3, level, priority, std::move(fields[ix + 2]));
+                }
+            }
+        }
+
+        if (state)
+        {
+            state->sourceNames = std::move(sourceNames);
+        }
+        return state;
+    }
+} // namespace sacnlogger
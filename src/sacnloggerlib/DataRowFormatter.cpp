@@ -0,0 +1,101 @@
+/**
+ * @file DataRowFormatter.cpp
+ *
+ * @author Dan Keenan
+ * @date 10/17/26
+ * @copyright GPL-3.0-or-later
+ * Copyright (C) 2024-2026 Dan Keenan
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "sacnloggerlib/DataRowFormatter.h"
+#include <algorithm>
+#include <fmt/format.h>
+
+namespace sacnlogger
+{
+    std::string DataRowFormatter::header(std::size_t slotCount)
+    {
+        CsvRow row;
+        for (std::size_t addr = 1; addr <= slotCount; ++addr)
+        {
+            row << fmt::format("{:03d} Lvl", addr) << fmt::format("{:03d} Pri", addr)
+                << fmt::format("{:03d} Src", addr);
+        }
+        return row.string();
+    }
+
+    std::string DataRowFormatter::sourceRow(std::string_view abbreviation, std::string_view cid,
+                                            std::string_view ipAddr, std::string_view name)
+    {
+        CsvRow row;
+        row << kSourceMarker << abbreviation << cid << ipAddr << name;
+        return row.string();
+    }
+
+    std::string DataRowFormatter::recoveryRow(std::uintmax_t removedBytes)
+    {
+        CsvRow row;
+        row << kRecoveryMarker << removedBytes;
+        return row.string();
+    }
+
+    std::string DataRowFormatter::droppedRow(std::uintmax_t droppedBytes)
+    {
+        CsvRow row;
+        row << kDroppedMarker << droppedBytes;
+        return row.string();
+    }
+
+    bool DataRowFormatter::widen(std::size_t slotCount)
+    {
+        slotCount = std::min<std::size_t>(slotCount, SACN_MERGE_RECEIVER_MAX_SLOTS);
+        if (slotCount <= slotCount_)
+        {
+            return false;
+        }
+        slotCount_ = slotCount;
+        fullRowRequested_ = true;
+        return true;
+    }
+
+    std::string_view DataRowFormatter::format(const ComparableData& data, const SlotMask& changedSlots,
+                                              const OwnerTable& owners)
+    {
+        row_.clear();
+        if (fullRowNext())
+        {
+            for (std::size_t slot = 0; slot < slotCount_; ++slot)
+            {
+                row_ << data.levels_[slot] << data.priorities_[slot] << owners[data.owners_[slot]];
+            }
+            fullRowRequested_ = false;
+            deltaRowsSinceFull_ = 0;
+        }
+        else
+        {
+            changedSlots.forEach(
+                [this, &data, &owners](std::size_t slot)
+                {
+                    std::array<char, 64> field;
+                    const auto result = fmt::format_to_n(field.data(), field.size(), "{}:{}:{}:{}", slot + 1,
+                                                         data.levels_[slot], data.priorities_[slot],
+                                                         owners[data.owners_[slot]]);
+                    row_ << std::string_view(field.data(), std::min(result.size, field.size()));
+                });
+            ++deltaRowsSinceFull_;
+        }
+        return row_.view();
+    }
+} // namespace sacnlogger
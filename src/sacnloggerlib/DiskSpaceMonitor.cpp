@@ -20,53 +20,143 @@
  */
 
 #include "sacnloggerlib/DiskSpaceMonitor.h"
+#include <cmath>
 #include <spdlog/spdlog.h>
 
 namespace sacnlogger
 {
+    DiskSpaceForecast DiskSpaceForecast::make(std::uintmax_t available, double writeRate)
+    {
+        DiskSpaceForecast forecast{.available = available, .writeRate = writeRate};
+        // Anything slower than this won't fill a drive in a lifetime, and wouldn't fit in seconds.
+        constexpr double kMinWriteRate = 1.0;
+        if (writeRate >= kMinWriteRate)
+        {
+            forecast.timeToFull = std::chrono::seconds(static_cast<std::chrono::seconds::rep>(available / writeRate));
+        }
+        return forecast;
+    }
+
     DiskSpaceMonitor::DiskSpaceMonitor(const std::filesystem::path& path) : path_(path)
     {
-        worker_ = std::jthread(
-            [this](std::stop_token stop)
+        worker_ = std::jthread([this](std::stop_token stopToken) { run(std::move(stopToken)); });
+    }
+
+    DiskSpaceMonitor::~DiskSpaceMonitor() { stop(); }
+
+    void DiskSpaceMonitor::stop()
+    {
+        // Wakes the worker, so this doesn't wait for the next poll.
+        worker_.request_stop();
+        if (worker_.joinable())
+        {
+            worker_.join();
+        }
+    }
+
+    DiskSpaceForecast DiskSpaceMonitor::forecast() const
+    {
+        std::scoped_lock lock(configMx_);
+        return forecast_;
+    }
+
+    void DiskSpaceMonitor::run(std::stop_token stopToken)
+    {
+        auto lastPoll = std::chrono::steady_clock::now();
+        std::uintmax_t lastWritten = 0;
+        std::uintmax_t lastFreed = 0;
+        std::optional<double> writeRate;
+        while (true)
+        {
+            std::filesystem::path path;
+            std::uintmax_t lowSpaceThreshold;
+            std::uintmax_t criticalSpaceThreshold;
+            std::chrono::minutes lowTimeThreshold;
+            std::chrono::minutes criticalTimeThreshold;
+            std::chrono::seconds rateWindow;
+            {
+                std::unique_lock lock(configMx_);
+                configChanged_.wait_for(lock, stopToken, pollPeriod_,
+                                        [this]() { return std::exchange(pollNow_, false); });
+                if (stopToken.stop_requested())
+                {
+                    return;
+                }
+                path = path_;
+                lowSpaceThreshold = lowSpaceThreshold_;
+                criticalSpaceThreshold = criticalSpaceThreshold_;
+                lowTimeThreshold = lowTimeThreshold_;
+                criticalTimeThreshold = criticalTimeThreshold_;
+                rateWindow = rateWindow_;
+            }
+
+            // Fold what has been used since the last poll into the write rate.
+            const auto now = std::chrono::steady_clock::now();
+            const auto elapsed = std::chrono::duration<double>(now - lastPoll).count();
+            if (elapsed > 0)
             {
-                while (!stop.stop_requested())
+                const auto written = writtenBytes_.load(std::memory_order_relaxed);
+                const auto freed = reclaimedBytes_.load(std::memory_order_relaxed) +
+                    removedBytes_.load(std::memory_order_relaxed);
+                const auto sample = (double(written - lastWritten) - double(freed - lastFreed)) / elapsed;
+                if (writeRate)
                 {
-                    if (!path_.empty())
+                    const auto weight =
+                        rateWindow.count() > 0 ? 1.0 - std::exp(-elapsed / double(rateWindow.count())) : 1.0;
+                    *writeRate += weight * (sample - *writeRate);
+                }
+                else
+                {
+                    writeRate = sample;
+                }
+                lastPoll = now;
+                lastWritten = written;
+                lastFreed = freed;
+            }
+
+            if (path.empty())
+            {
+                continue;
+            }
+            try
+            {
+                const auto space = std::filesystem::space(path);
+                const auto forecast = DiskSpaceForecast::make(space.available, writeRate.value_or(0));
+                {
+                    std::scoped_lock lock(configMx_);
+                    forecast_ = forecast;
+                }
+                const auto lastsUnder = [&forecast](std::chrono::minutes threshold)
+                { return forecast.timeToFull && *forecast.timeToFull < threshold; };
+                if (space.available <= criticalSpaceThreshold || lastsUnder(criticalTimeThreshold))
+                {
+                    if (!criticalSpaceMet_)
+                    {
+                        sigCriticalSpace(forecast);
+                        criticalSpaceMet_ = true;
+                    }
+                }
+                else if (space.available <= lowSpaceThreshold || lastsUnder(lowTimeThreshold))
+                {
+                    // No longer critical, so the next time it is signals again.
+                    criticalSpaceMet_ = false;
+                    if (!lowSpaceMet_)
                     {
-                        std::scoped_lock lock(configMx_);
-                        try
-                        {
-                            const auto space = std::filesystem::space(path_);
-                            if (space.available <= criticalSpaceThreshold_)
-                            {
-                                if (!criticalSpaceMet_)
-                                {
-                                    sigCriticalSpace(space.available);
-                                    criticalSpaceMet_ = true;
-                                }
-                            }
-                            else if (space.available <= lowSpaceThreshold_)
-                            {
-                                if (!lowSpaceMet_)
-                                {
-                                    sigLowSpace(space.available);
-                                    lowSpaceMet_ = true;
-                                }
-                            }
-                            else
-                            {
-                                criticalSpaceMet_ = false;
-                                lowSpaceMet_ = false;
-                            }
-                        }
-                        catch (const std::exception& e)
-                        {
-                            SPDLOG_WARN("DiskSpaceMonitor: {}", e.what());
-                        }
-                        std::this_thread::sleep_for(pollPeriod_);
+                        sigLowSpace(forecast);
+                        lowSpaceMet_ = true;
                     }
                 }
-            });
+                else
+                {
+                    criticalSpaceMet_ = false;
+                    lowSpaceMet_ = false;
+                }
+            }
+            catch (const std::exception& e)
+            {
+                SPDLOG_WARN("DiskSpaceMonitor: {}", e.what());
+            }
+        }
     }
 
 } // namespace sacnlogger
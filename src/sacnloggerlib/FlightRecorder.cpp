@@ -0,0 +1,325 @@
+/**
+ * @file FlightRecorder.cpp
+ *
+ * @author Dan Keenan
+ * @date 10/17/26
+ * @copyright GPL-3.0-or-later
+ * Copyright (C) 2024-2026 Dan Keenan
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "sacnloggerlib/FlightRecorder.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <fmt/format.h>
+#include <limits>
+#include <spdlog/spdlog.h>
+#include <unistd.h>
+#include "sacnloggerlib/Crc32c.h"
+
+namespace sacnlogger
+{
+    namespace
+    {
+        /**
+         * Closes the file when it goes out of scope.
+         */
+        class FileDescriptor
+        {
+        public:
+            explicit FileDescriptor(int fd) : fd_(fd) {}
+            ~FileDescriptor()
+            {
+                if (fd_ >= 0)
+                {
+                    ::close(fd_);
+                }
+            }
+
+            FileDescriptor(const FileDescriptor&) = delete;
+            FileDescriptor& operator=(const FileDescriptor&) = delete;
+
+            [[nodiscard]] int get() const { return fd_; }
+
+        private:
+            int fd_;
+        };
+
+        bool writeAll(int fd, const void* data, std::size_t size)
+        {
+            const auto* bytes = static_cast<const char*>(data);
+            while (size > 0)
+            {
+                const auto written = ::write(fd, bytes, size);
+                if (written < 0)
+                {
+                    if (errno == EINTR)
+                    {
+                        continue;
+                    }
+                    return false;
+                }
+                bytes += written;
+                size -= written;
+            }
+            return true;
+        }
+
+        bool writeChunk(int fd, uint32_t type, const void* payload, std::size_t size)
+        {
+            const sacnlog::ChunkHeader header{
+                .type = type, .size = static_cast<uint32_t>(size), .crc = crc32c(payload, size)};
+            return writeAll(fd, &header, sizeof(header)) && writeAll(fd, payload, size);
+        }
+
+        int64_t nanoseconds(spdlog::log_clock::time_point time)
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+        }
+    } // namespace
+
+    FlightRecorder::FlightRecorder(uint16_t universe, std::size_t capacity, std::chrono::seconds window) :
+        universe_(universe), window_(window),
+        // Zeroing the buffer here also makes sure all of it is in memory from the start.
+        bufferStorage_(sacnlog::padded(std::max(capacity, kMinCapacity)) / sizeof(uint64_t)),
+        buffer_(reinterpret_cast<std::byte*>(bufferStorage_.data()), bufferStorage_.size() * sizeof(uint64_t)),
+        chunk_((sizeof(sacnlog::ChunkHeader) +
+                sacnlog::frameChunkSize(SacnLogEncoder::kFramesPerBlock, SACN_MERGE_RECEIVER_MAX_SLOTS)) /
+               sizeof(uint64_t))
+    {
+    }
+
+    void FlightRecorder::addFrame(spdlog::log_clock::time_point time, const ComparableData& data,
+                                  std::size_t slotCount)
+    {
+        slotCount = std::min<std::size_t>(slotCount, SACN_MERGE_RECEIVER_MAX_SLOTS);
+        // The newest frame from before the window is kept, as it is what the universe looked like when the window
+        // starts.
+        const auto cutoff = nanoseconds(time - window_);
+        while (frameCount_ > 1 && header(next(head_)).time <= cutoff)
+        {
+            dropOldest();
+        }
+        const auto size = recordSize(slotCount);
+        std::optional<std::size_t> offset;
+        while (!(offset = room(size)))
+        {
+            dropOldest();
+        }
+        if (frameCount_ > 0 && *offset < tail_)
+        {
+            wrapEnd_ = tail_;
+        }
+
+        auto* record = buffer_.data() + *offset;
+        const RecordHeader recordHeader{.time = nanoseconds(time),
+                                        .size = static_cast<uint32_t>(size),
+                                        .slotCount = static_cast<uint16_t>(slotCount)};
+        std::memcpy(record, &recordHeader, sizeof(recordHeader));
+        auto* levels = record + sizeof(recordHeader);
+        std::memcpy(levels, data.levels_.data(), slotCount);
+        std::memcpy(levels + slotCount, data.priorities_.data(), slotCount);
+        auto* owners = reinterpret_cast<uint16_t*>(levels + 2 * slotCount);
+        for (std::size_t slot = 0; slot < slotCount; ++slot)
+        {
+            owners[slot] = sources_.ownerIndex(data.owners_[slot]);
+        }
+        tail_ = *offset + size;
+        ++frameCount_;
+    }
+
+    std::optional<spdlog::log_clock::time_point> FlightRecorder::oldest() const
+    {
+        if (frameCount_ == 0)
+        {
+            return std::nullopt;
+        }
+        return spdlog::log_clock::time_point(std::chrono::duration_cast<spdlog::log_clock::duration>(
+            std::chrono::nanoseconds(header(head_).time)));
+    }
+
+    std::size_t FlightRecorder::next(std::size_t offset) const
+    {
+        const auto r = offset + header(offset).size;
+        return r == wrapEnd_ ? 0 : r;
+    }
+
+    std::optional<std::size_t> FlightRecorder::room(std::size_t size) const
+    {
+        if (frameCount_ == 0)
+        {
+            return 0;
+        }
+        if (tail_ > head_)
+        {
+            // Records haven't wrapped, so there is room after the newest and before the oldest.
+            if (tail_ + size <= buffer_.size())
+            {
+                return tail_;
+            }
+            if (size <= head_)
+            {
+                return 0;
+            }
+            return std::nullopt;
+        }
+        if (tail_ + size <= head_)
+        {
+            return tail_;
+        }
+        return std::nullopt;
+    }
+
+    void FlightRecorder::dropOldest()
+    {
+        if (--frameCount_ == 0)
+        {
+            head_ = 0;
+            tail_ = 0;
+            wrapEnd_ = 0;
+            return;
+        }
+        head_ = next(head_);
+        if (head_ == 0)
+        {
+            wrapEnd_ = 0;
+        }
+    }
+
+    bool FlightRecorder::dump(const std::filesystem::path& path)
+    {
+        return dump(path, std::numeric_limits<int64_t>::min(), std::numeric_limits<int64_t>::max());
+    }
+
+    bool FlightRecorder::dump(const std::filesystem::path& path, spdlog::log_clock::time_point from,
+                              spdlog::log_clock::time_point until)
+    {
+        return dump(path, nanoseconds(from), nanoseconds(until));
+    }
+
+    bool FlightRecorder::dump(const std::filesystem::path& path, int64_t from, int64_t until)
+    {
+        auto offset = head_;
+        std::size_t frameCount = 0;
+        if (frameCount_ > 0)
+        {
+            auto remaining = frameCount_;
+            while (remaining > 1 && header(next(offset)).time <= from)
+            {
+                offset = next(offset);
+                --remaining;
+            }
+            for (auto it = offset; frameCount < remaining && header(it).time <= until; it = next(it))
+            {
+                ++frameCount;
+            }
+        }
+
+        // Hidden, so it can't be mistaken for a dump.
+        const auto tempPath = path.parent_path() / fmt::format(".{}.tmp", path.filename().string());
+        const auto discard = [&tempPath]()
+        {
+            std::error_code ec;
+            std::filesystem::remove(tempPath, ec);
+        };
+        {
+            const FileDescriptor file(::open(tempPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644));
+            if (file.get() < 0)
+            {
+                SPDLOG_ERROR("Failed opening {}: {}", tempPath.string(), std::strerror(errno));
+                return false;
+            }
+
+            const sacnlog::FileHeader fileHeader{.version = sacnlog::kVersion, .universe = universe_};
+            bool ok = writeChunk(file.get(), sacnlog::kFileHeaderChunk, &fileHeader, sizeof(fileHeader));
+            const auto& sources = sources_.records();
+            if (ok && !sources.empty())
+            {
+                ok = writeChunk(file.get(), sacnlog::kSourceChunk, sources.data(),
+                                sources.size() * sizeof(sacnlog::SourceRecord));
+            }
+            for (auto remaining = frameCount; ok && remaining > 0;)
+            {
+                // Each block holds frames of the same width.
+                const auto slotCount = header(offset).slotCount;
+                const auto maxFrames = std::min(remaining, SacnLogEncoder::kFramesPerBlock);
+                std::size_t blockFrames = 1;
+                for (auto it = next(offset); blockFrames < maxFrames && header(it).slotCount == slotCount;
+                     it = next(it))
+                {
+                    ++blockFrames;
+                }
+                const auto after = writeBlock(file.get(), offset, blockFrames, slotCount);
+                ok = after.has_value();
+                offset = after.value_or(offset);
+                remaining -= blockFrames;
+            }
+            if (!ok || ::fdatasync(file.get()) != 0)
+            {
+                SPDLOG_ERROR("Failed writing {}: {}", tempPath.string(), std::strerror(errno));
+                discard();
+                return false;
+            }
+        }
+
+        std::error_code ec;
+        std::filesystem::rename(tempPath, path, ec);
+        if (ec)
+        {
+            SPDLOG_ERROR("Failed renaming {} to {}: {}", tempPath.string(), path.string(), ec.message());
+            discard();
+            return false;
+        }
+        return true;
+    }
+
+    std::optional<std::size_t> FlightRecorder::writeBlock(int fd, std::size_t offset, std::size_t frameCount,
+                                                          std::size_t slotCount)
+    {
+        // Lay the columns out in the chunk buffer, so the chunk is one write.
+        const auto payloadSize = sacnlog::frameChunkSize(frameCount, slotCount);
+        auto* chunk = reinterpret_cast<std::byte*>(chunk_.data());
+        auto* payload = chunk + sizeof(sacnlog::ChunkHeader);
+        const sacnlog::FrameBlockHeader blockHeader{.frameCount = static_cast<uint32_t>(frameCount),
+                                                    .slotCount = static_cast<uint16_t>(slotCount)};
+        std::memcpy(payload, &blockHeader, sizeof(blockHeader));
+        auto* timestamps = payload + sizeof(blockHeader);
+        auto* levels = timestamps + frameCount * sizeof(int64_t);
+        auto* priorities = levels + frameCount * slotCount;
+        auto* owners = priorities + frameCount * slotCount;
+        auto* padding = owners + frameCount * slotCount * sizeof(uint16_t);
+        for (std::size_t frame = 0; frame < frameCount; ++frame, offset = next(offset))
+        {
+            const auto* recordLevels = buffer_.data() + offset + sizeof(RecordHeader);
+            std::memcpy(timestamps + frame * sizeof(int64_t), &header(offset).time, sizeof(int64_t));
+            std::memcpy(levels + frame * slotCount, recordLevels, slotCount);
+            std::memcpy(priorities + frame * slotCount, recordLevels + slotCount, slotCount);
+            std::memcpy(owners + frame * slotCount * sizeof(uint16_t), recordLevels + 2 * slotCount,
+                        slotCount * sizeof(uint16_t));
+        }
+        std::memset(padding, 0, payload + payloadSize - padding);
+
+        const sacnlog::ChunkHeader chunkHeader{.type = sacnlog::kFrameChunk,
+                                               .size = static_cast<uint32_t>(payloadSize),
+                                               .crc = crc32c(payload, payloadSize)};
+        std::memcpy(chunk, &chunkHeader, sizeof(chunkHeader));
+        if (!writeAll(fd, chunk, sizeof(chunkHeader) + payloadSize))
+        {
+            return std::nullopt;
+        }
+        return offset;
+    }
+} // namespace sacnlogger
@@ -0,0 +1,247 @@
+/**
+ * @file FrameDiff.cpp
+ *
+ * @author Dan Keenan
+ * @date 10/17/26
+ * @copyright GPL-3.0-or-later
+ * Copyright (C) 2024-2026 Dan Keenan
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "sacnloggerlib/FrameDiff.h"
+#include <algorithm>
+#include <cstring>
+#include <spdlog/spdlog.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define SACNLOGGER_DIFF_AVX2
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define SACNLOGGER_DIFF_SSE2
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define SACNLOGGER_DIFF_NEON
+#endif
+
+namespace sacnlogger
+{
+    namespace detail
+    {
+        void diffSlotsScalar(const uint8_t* lhs, const uint8_t* rhs, std::size_t count, std::size_t offset,
+                             SlotMask& mask)
+        {
+            for (std::size_t ix = 0; ix < count; ++ix)
+            {
+                if (lhs[ix] != rhs[ix])
+                {
+                    mask.set(offset + ix);
+                }
+            }
+        }
+
+        void diffSlotsScalar(const sacn_remote_source_t* lhs, const sacn_remote_source_t* rhs, std::size_t count,
+                             std::size_t offset, SlotMask& mask)
+        {
+            for (std::size_t ix = 0; ix < count; ++ix)
+            {
+                if (lhs[ix] != rhs[ix])
+                {
+                    mask.set(offset + ix);
+                }
+            }
+        }
+    } // namespace detail
+
+#ifdef SACNLOGGER_DIFF_NEON
+    namespace
+    {
+        /**
+         * Collapse a vector of 0x00/0xFF lanes into one bit per lane.
+         */
+        uint64_t neonMoveMask(uint8x16_t lanes)
+        {
+            static constexpr uint8_t kWeights[16] = {1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+            const auto weighted = vandq_u8(lanes, vld1q_u8(kWeights));
+            return uint64_t(vaddv_u8(vget_low_u8(weighted))) | (uint64_t(vaddv_u8(vget_high_u8(weighted))) << 8);
+        }
+    } // namespace
+#endif
+
+    void diffSlots(const uint8_t* lhs, const uint8_t* rhs, std::size_t count, std::size_t offset, SlotMask& mask)
+    {
+        std::size_t ix = 0;
+#if defined(SACNLOGGER_DIFF_AVX2)
+        for (; ix + 32 <= count; ix += 32)
+        {
+            const auto a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lhs + ix));
+            const auto b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rhs + ix));
+            const auto same = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(a, b)));
+            mask.orBits(offset + ix, ~same, 32);
+        }
+#elif defined(SACNLOGGER_DIFF_SSE2)
+        for (; ix + 16 <= count; ix += 16)
+        {
+            const auto a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lhs + ix));
+            const auto b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rhs + ix));
+            const auto same = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(a, b)));
+            mask.orBits(offset + ix, ~same & 0xFFFF, 16);
+        }
+#elif defined(SACNLOGGER_DIFF_NEON)
+        for (; ix + 16 <= count; ix += 16)
+        {
+            const auto changed = vmvnq_u8(vceqq_u8(vld1q_u8(lhs + ix), vld1q_u8(rhs + ix)));
+            mask.orBits(offset + ix, neonMoveMask(changed), 16);
+        }
+#endif
+        detail::diffSlotsScalar(lhs + ix, rhs + ix, count - ix, offset + ix, mask);
+    }
+
+    void diffSlots(const sacn_remote_source_t* lhs, const sacn_remote_source_t* rhs, std::size_t count,
+                   std::size_t offset, SlotMask& mask)
+    {
+        static_assert(sizeof(sacn_remote_source_t) == 2, "SIMD owner comparison assumes 16-bit source handles");
+        std::size_t ix = 0;
+#if defined(SACNLOGGER_DIFF_AVX2)
+        for (; ix + 32 <= count; ix += 32)
+        {
+            const auto lo = _mm256_cmpeq_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(lhs + ix)),
+                                               _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rhs + ix)));
+            const auto hi = _mm256_cmpeq_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(lhs + ix + 16)),
+                                               _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rhs + ix + 16)));
+            // Packing works per 128-bit lane, so restore slot order afterwards.
+            const auto packed = _mm256_permute4x64_epi64(_mm256_packs_epi16(lo, hi), _MM_SHUFFLE(3, 1, 2, 0));
+            const auto same = static_cast<uint32_t>(_mm256_movemask_epi8(packed));
+            mask.orBits(offset + ix, ~same, 32);
+        }
+#elif defined(SACNLOGGER_DIFF_SSE2)
+        for (; ix + 16 <= count; ix += 16)
+        {
+            const auto lo = _mm_cmpeq_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(lhs + ix)),
+                                            _mm_loadu_si128(reinterpret_cast<const __m128i*>(rhs + ix)));
+            const auto hi = _mm_cmpeq_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(lhs + ix + 8)),
+                                            _mm_loadu_si128(reinterpret_cast<const __m128i*>(rhs + ix + 8)));
+            const auto same = static_cast<uint32_t>(_mm_movemask_epi8(_mm_packs_epi16(lo, hi)));
+            mask.orBits(offset + ix, ~same & 0xFFFF, 16);
+        }
+#elif defined(SACNLOGGER_DIFF_NEON)
+        for (; ix + 16 <= count; ix += 16)
+        {
+            const auto lo = vmovn_u16(vceqq_u16(vld1q_u16(lhs + ix), vld1q_u16(rhs + ix)));
+            const auto hi = vmovn_u16(vceqq_u16(vld1q_u16(lhs + ix + 8), vld1q_u16(rhs + ix + 8)));
+            mask.orBits(offset + ix, neonMoveMask(vmvnq_u8(vcombine_u8(lo, hi))), 16);
+        }
+#endif
+        detail::diffSlotsScalar(lhs + ix, rhs + ix, count - ix, offset + ix, mask);
+    }
+
+    namespace
+    {
+        bool slotRangeValid(const SacnRecvMergedData& mergedData)
+        {
+            const auto addrStartOffset = mergedData.slot_range.start_address - 1;
+            const auto addrCount = mergedData.slot_range.address_count;
+            if (addrStartOffset < 0 || addrStartOffset + addrCount > SACN_MERGE_RECEIVER_MAX_SLOTS)
+            {
+                SPDLOG_CRITICAL("Received more slots than expected: Got {}, wanted no more than {}", addrCount,
+                                SACN_MERGE_RECEIVER_MAX_SLOTS);
+                return false;
+            }
+            return true;
+        }
+
+        /**
+         * Compare @p values to @p received inside the received slot range, and to @p unused outside it.
+         */
+        template <typename T>
+        void diffUniverse(const std::array<T, SACN_MERGE_RECEIVER_MAX_SLOTS>& values, const T* received,
+                          std::size_t offset, std::size_t count,
+                          const std::array<T, SACN_MERGE_RECEIVER_MAX_SLOTS>& unused, SlotMask& mask)
+        {
+            const auto end = offset + count;
+            diffSlots(values.data(), unused.data(), offset, 0, mask);
+            diffSlots(values.data() + offset, received, count, offset, mask);
+            diffSlots(values.data() + end, unused.data() + end, values.size() - end, end, mask);
+        }
+
+        /**
+         * Copy @p received into @p values inside the received slot range, and @p unused outside it.
+         */
+        template <typename T>
+        void assignUniverse(std::array<T, SACN_MERGE_RECEIVER_MAX_SLOTS>& values, const T* received,
+                            std::size_t offset, std::size_t count,
+                            const std::array<T, SACN_MERGE_RECEIVER_MAX_SLOTS>& unused)
+        {
+            values = unused;
+            std::copy_n(received, count, values.begin() + offset);
+        }
+
+        constexpr std::array<uint8_t, SACN_MERGE_RECEIVER_MAX_SLOTS> kNoLevels{};
+    } // namespace
+
+    ComparableData::ComparableData(const SacnRecvMergedData& mergedData) { assign(mergedData); }
+
+    SlotMask ComparableData::diff(const SacnRecvMergedData& mergedData) const
+    {
+        SlotMask changed;
+        if (!slotRangeValid(mergedData))
+        {
+            return changed;
+        }
+        const std::size_t addrStartOffset = mergedData.slot_range.start_address - 1;
+        const std::size_t addrCount = mergedData.slot_range.address_count;
+        diffUniverse(levels_, mergedData.levels, addrStartOffset, addrCount, kNoLevels, changed);
+        diffUniverse(priorities_, mergedData.priorities, addrStartOffset, addrCount, kNoLevels, changed);
+        diffUniverse(owners_, mergedData.owners, addrStartOffset, addrCount, kNoOwners, changed);
+        return changed;
+    }
+
+    SlotMask ComparableData::diffOwners(const SacnRecvMergedData& mergedData) const
+    {
+        SlotMask changed;
+        if (!slotRangeValid(mergedData))
+        {
+            return changed;
+        }
+        diffUniverse(owners_, mergedData.owners, mergedData.slot_range.start_address - 1,
+                     mergedData.slot_range.address_count, kNoOwners, changed);
+        return changed;
+    }
+
+    void ComparableData::assign(const SacnRecvMergedData& mergedData)
+    {
+        if (!slotRangeValid(mergedData))
+        {
+            return;
+        }
+        const std::size_t addrStartOffset = mergedData.slot_range.start_address - 1;
+        const std::size_t addrCount = mergedData.slot_range.address_count;
+        assignUniverse(levels_, mergedData.levels, addrStartOffset, addrCount, kNoLevels);
+        assignUniverse(priorities_, mergedData.priorities, addrStartOffset, addrCount, kNoLevels);
+        assignUniverse(owners_, mergedData.owners, addrStartOffset, addrCount, kNoOwners);
+    }
+
+    const char* diffSlotsKernel()
+    {
+#if defined(SACNLOGGER_DIFF_AVX2)
+        return "AVX2";
+#elif defined(SACNLOGGER_DIFF_SSE2)
+        return "SSE2";
+#elif defined(SACNLOGGER_DIFF_NEON)
+        return "NEON";
+#else
+        return "scalar";
+#endif
+    }
+} // namespace sacnlogger
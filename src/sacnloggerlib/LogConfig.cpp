@@ -0,0 +1,292 @@
+/**
+ * @file LogConfig.cpp
+ *
+ * @author Dan Keenan
+ * @date 10/17/26
+ * @copyright GPL-3.0-or-later
+ * Copyright (C) 2024-2026 Dan Keenan
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "sacnloggerlib/LogConfig.h"
+#include <charconv>
+#include <nlohmann/json.hpp>
+#include "sacnloggerlib/ConfigException.h"
+
+constexpr auto kDataFormat = "dataFormat";
+constexpr auto kCompression = "compression";
+constexpr auto kCompressionLevel = "compressionLevel";
+constexpr auto kCompressRotated = "compressRotated";
+constexpr auto kCompressRotatedRate = "compressRotatedRate";
+constexpr auto kDeltaRows = "deltaRows";
+constexpr auto kCheckpointInterval = "checkpointInterval";
+constexpr auto kCheckpointSeconds = "checkpointSeconds";
+constexpr auto kSelfContained = "selfContained";
+constexpr auto kCommitInterval = "commitInterval";
+constexpr auto kCommitSize = "commitSize";
+constexpr auto kIoUring = "ioUring";
+constexpr auto kRetentionBudget = "retentionBudget";
+constexpr auto kStagingSize = "stagingSize";
+constexpr auto kStagingAge = "stagingAge";
+constexpr auto kFlightRecorder = "flightRecorder";
+constexpr auto kSize = "size";
+constexpr auto kWindow = "window";
+constexpr auto kTriggers = "triggers";
+constexpr auto kEvent = "event";
+constexpr auto kUniverse = "universe";
+constexpr auto kAddress = "address";
+constexpr auto kLevel = "level";
+constexpr auto kPre = "pre";
+constexpr auto kPost = "post";
+constexpr auto kQueueSize = "queueSize";
+constexpr auto kOverflowPolicy = "overflowPolicy";
+constexpr auto kUniverses = "universes";
+
+namespace sacnlogger
+{
+    NLOHMANN_JSON_SERIALIZE_ENUM(DataFormat, {
+                                                 {DataFormat::Csv, "csv"},
+                                                 {DataFormat::SacnLog, "sacnlog"},
+                                             })
+
+    NLOHMANN_JSON_SERIALIZE_ENUM(Compression, {
+                                                  {Compression::None, "none"},
+                                                  {Compression::Zstd, "zstd"},
+                                              })
+
+    NLOHMANN_JSON_SERIALIZE_ENUM(OverflowPolicy, {
+                                                     {OverflowPolicy::Block, "block"},
+                                                     {OverflowPolicy::DropOldest, "dropOldest"},
+                                                     {OverflowPolicy::Degrade, "degrade"},
+                                                 })
+
+    NLOHMANN_JSON_SERIALIZE_ENUM(TriggerEvent, {
+                                                   {TriggerEvent::Level, "level"},
+                                                   {TriggerEvent::OwnerChange, "ownerChange"},
+                                                   {TriggerEvent::SourceLost, "sourceLost"},
+                                               })
+
+    void to_json(nlohmann::json& j, const QueueConfig& value)
+    {
+        j = nlohmann::json{
+            {kQueueSize, value.queueSize},
+            {kOverflowPolicy, value.overflowPolicy},
+        };
+    }
+
+    void from_json(const nlohmann::json& j, QueueConfig& value)
+    {
+        nlohmann::json::const_iterator it;
+        if ((it = j.find(kQueueSize)) != j.end())
+        {
+            it->get_to(value.queueSize);
+        }
+        if ((it = j.find(kOverflowPolicy)) != j.end())
+        {
+            it->get_to(value.overflowPolicy);
+        }
+    }
+
+    void to_json(nlohmann::json& j, const Trigger& value)
+    {
+        j = nlohmann::json{
+            {kEvent, value.event},
+            {kUniverse, value.universe},
+            {kAddress, value.address},
+            {kLevel, value.level},
+            {kPre, value.pre},
+            {kPost, value.post},
+        };
+    }
+
+    void from_json(const nlohmann::json& j, Trigger& value)
+    {
+        nlohmann::json::const_iterator it;
+        if ((it = j.find(kEvent)) != j.end())
+        {
+            it->get_to(value.event);
+        }
+        if ((it = j.find(kUniverse)) != j.end())
+        {
+            it->get_to(value.universe);
+        }
+        if ((it = j.find(kAddress)) != j.end())
+        {
+            it->get_to(value.address);
+        }
+        if ((it = j.find(kLevel)) != j.end())
+        {
+            it->get_to(value.level);
+        }
+        if ((it = j.find(kPre)) != j.end())
+        {
+            it->get_to(value.pre);
+        }
+        if ((it = j.find(kPost)) != j.end())
+        {
+            it->get_to(value.post);
+        }
+    }
+
+    void to_json(nlohmann::json& j, const FlightRecorderConfig& value)
+    {
+        j = nlohmann::json{
+            {kSize, value.size},
+            {kWindow, value.window},
+            {kTriggers, value.triggers},
+        };
+    }
+
+    void from_json(const nlohmann::json& j, FlightRecorderConfig& value)
+    {
+        nlohmann::json::const_iterator it;
+        if ((it = j.find(kSize)) != j.end())
+        {
+            it->get_to(value.size);
+        }
+        if ((it = j.find(kWindow)) != j.end())
+        {
+            it->get_to(value.window);
+        }
+        if ((it = j.find(kTriggers)) != j.end())
+        {
+            it->get_to(value.triggers);
+        }
+    }
+
+    void to_json(nlohmann::json& j, const LogConfig& value)
+    {
+        j = nlohmann::json{
+            {kDataFormat, value.dataFormat},
+            {kCompression, value.compression},
+            {kCompressionLevel, value.compressionLevel},
+            {kCompressRotated, value.compressRotated},
+            {kCompressRotatedRate, value.compressRotatedRate},
+            {kDeltaRows, value.deltaRows},
+            {kCheckpointInterval, value.checkpointInterval},
+            {kCheckpointSeconds, value.checkpointSeconds},
+            {kSelfContained, value.selfContained},
+            {kCommitInterval, value.commitInterval},
+            {kCommitSize, value.commitSize},
+            {kIoUring, value.ioUring},
+            {kRetentionBudget, value.retentionBudget},
+            {kStagingSize, value.stagingSize},
+            {kStagingAge, value.stagingAge},
+            {kFlightRecorder, value.flightRecorder},
+            {kQueueSize, value.queue.queueSize},
+            {kOverflowPolicy, value.queue.overflowPolicy},
+        };
+        auto& universes = j[kUniverses] = nlohmann::json::object();
+        for (const auto& [universe, queueConfig] : value.universeQueues)
+        {
+            // Only what differs from the defaults above, so the rest still follows them when they change.
+            auto& universeJson = universes[std::to_string(universe)] = nlohmann::json::object();
+            if (queueConfig.queueSize != value.queue.queueSize)
+            {
+                universeJson[kQueueSize] = queueConfig.queueSize;
+            }
+            if (queueConfig.overflowPolicy != value.queue.overflowPolicy)
+            {
+                universeJson[kOverflowPolicy] = queueConfig.overflowPolicy;
+            }
+        }
+    }
+
+    void from_json(const nlohmann::json& j, LogConfig& value)
+    {
+        nlohmann::json::const_iterator it;
+        if ((it = j.find(kDataFormat)) != j.end())
+        {
+            it->get_to(value.dataFormat);
+        }
+        if ((it = j.find(kCompression)) != j.end())
+        {
+            it->get_to(value.compression);
+        }
+        if ((it = j.find(kCompressionLevel)) != j.end())
+        {
+            it->get_to(value.compressionLevel);
+        }
+        if ((it = j.find(kCompressRotated)) != j.end())
+        {
+            it->get_to(value.compressRotated);
+        }
+        if ((it = j.find(kCompressRotatedRate)) != j.end())
+        {
+            it->get_to(value.compressRotatedRate);
+        }
+        if ((it = j.find(kDeltaRows)) != j.end())
+        {
+            it->get_to(value.deltaRows);
+        }
+        if ((it = j.find(kCheckpointInterval)) != j.end())
+        {
+            it->get_to(value.checkpointInterval);
+        }
+        if ((it = j.find(kCheckpointSeconds)) != j.end())
+        {
+            it->get_to(value.checkpointSeconds);
+        }
+        if ((it = j.find(kSelfContained)) != j.end())
+        {
+            it->get_to(value.selfContained);
+        }
+        if ((it = j.find(kCommitInterval)) != j.end())
+        {
+            it->get_to(value.commitInterval);
+        }
+        if ((it = j.find(kCommitSize)) != j.end())
+        {
+            it->get_to(value.commitSize);
+        }
+        if ((it = j.find(kIoUring)) != j.end())
+        {
+            it->get_to(value.ioUring);
+        }
+        if ((it = j.find(kRetentionBudget)) != j.end())
+        {
+            it->get_to(value.retentionBudget);
+        }
+        if ((it = j.find(kStagingSize)) != j.end())
+        {
+            it->get_to(value.stagingSize);
+        }
+        if ((it = j.find(kStagingAge)) != j.end())
+        {
+            it->get_to(value.stagingAge);
+        }
+        if ((it = j.find(kFlightRecorder)) != j.end())
+        {
+            it->get_to(value.flightRecorder);
+        }
+        from_json(j, value.queue);
+        if ((it = j.find(kUniverses)) != j.end())
+        {
+            for (const auto& [universe, queueJson] : it->items())
+            {
+                // Settings not given for a universe come from the defaults above.
+                uint16_t universeId = 0;
+                const auto [end, ec] = std::from_chars(universe.data(), universe.data() + universe.size(), universeId);
+                if (ec != std::errc() || end != universe.data() + universe.size() || universeId < 1 ||
+                    universeId > 63999)
+                {
+                    throw ConfigException("Invalid universe \"" + universe + "\" in " + kUniverses);
+                }
+                auto queueConfig = value.queue;
+                from_json(queueJson, queueConfig);
+                value.universeQueues.insert_or_assign(universeId, queueConfig);
+            }
+        }
+    }
+} // namespace sacnlogger
@@ -0,0 +1,832 @@
+/**
+ * @file LogWriter.cpp
+ *
+ * @author Dan Keenan
+ * @date 10/17/26
+ * @copyright GPL-3.0-or-later
+ * Copyright (C) 2024-2026 Dan Keenan
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "sacnloggerlib/LogWriter.h"
+#include "sacnloggerlib/SegmentManifest.h"
+#include "sacnloggerlib/TailRecovery.h"
+#include "sacnloggerlib/TimeIndex.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <spdlog/spdlog.h>
+#include <sys/stat.h>
+#include <sys/statvfs.h>
+#include <unistd.h>
+
+namespace sacnlogger
+{
+    std::filesystem::path LogWriter::File::pathFor(uint64_t sequence) const
+    {
+        auto r = segmentPath(path, sequence);
+        if (compressor)
+        {
+            r += ".zst";
+        }
+        return r;
+    }
+
+    LogWriter::Stream::Stream(LogWriter& writer, File& file, std::uintmax_t fileSize, std::uintmax_t maxFileSize,
+                              OverflowPolicy overflowPolicy, bool priority, std::uintmax_t recoveredBytes) :
+        writer_(writer), file_(file), overflowPolicy_(priority ? OverflowPolicy::Block : overflowPolicy),
+        reserve_(priority ? 0 : writer.reservedBlocks_), recoveredBytes_(recoveredBytes), fileSize_(fileSize),
+        maxFileSize_(maxFileSize)
+    {
+    }
+
+    LogWriter::Stream::~Stream() { flush(); }
+
+    void LogWriter::Stream::write(spdlog::log_clock::time_point time, std::string_view line)
+    {
+        const auto timestamp = timestampFormatter_.format(time);
+        beginRecord(timestamp.size() + line.size() + 2);
+        append(timestamp);
+        append(",");
+        append(line);
+        append("\n");
+        fileSize_ += timestamp.size() + line.size() + 2;
+    }
+
+    void LogWriter::Stream::writeBytes(const void* data, std::size_t size)
+    {
+        append({static_cast<const char*>(data), size});
+        fileSize_ += size;
+    }
+
+    void LogWriter::Stream::beginRecord(std::size_t size)
+    {
+        if (overflowPolicy_ == OverflowPolicy::DropOldest && block_ != nullptr && size > block_->available())
+        {
+            flush();
+        }
+        recordRemaining_ = size;
+        midRecord_ = false;
+    }
+
+    void LogWriter::Stream::append(std::string_view bytes)
+    {
+        while (!bytes.empty())
+        {
+            if (block_ == nullptr)
+            {
+                blockContinues_ = midRecord_;
+                block_ = acquireBlock();
+                blockStartedAt_ = std::chrono::steady_clock::now();
+            }
+            const auto count = std::min(bytes.size(), block_->available());
+            std::memcpy(block_->data + block_->size, bytes.data(), count);
+            block_->size += count;
+            bytes.remove_prefix(count);
+            recordRemaining_ -= std::min(count, recordRemaining_);
+            midRecord_ = recordRemaining_ > 0;
+            if (block_->available() == 0)
+            {
+                flush();
+            }
+        }
+    }
+
+    BufferPool::Block* LogWriter::Stream::acquireBlock()
+    {
+        if (auto* block = writer_.pool_.tryAcquire(reserve_))
+        {
+            return block;
+        }
+        if (overflowPolicy_ == OverflowPolicy::DropOldest)
+        {
+            const auto reclaimed = writer_.reclaim(file_, midRecord_);
+            if (reclaimed.block != nullptr)
+            {
+                counters_.droppedBlocks.fetch_add(reclaimed.blockCount, std::memory_order_relaxed);
+                rotatePending_ = rotatePending_ || reclaimed.rotate;
+                droppedBytes_ += reclaimed.bytes;
+                return reclaimed.block;
+            }
+        }
+        counters_.waits.fetch_add(1, std::memory_order_relaxed);
+        return writer_.pool_.acquire(reserve_);
+    }
+
+    void LogWriter::Stream::markKeyframe(spdlog::log_clock::time_point time)
+    {
+        // Keyframes start a block, so the writer thread knows where they end up in the file.
+        flush();
+        keyframe_ = time;
+    }
+
+    void LogWriter::Stream::flush()
+    {
+        if (block_ == nullptr)
+        {
+            return;
+        }
+        writer_.submit({.file = &file_,
+                        .block = block_,
+                        .rotate = std::exchange(rotatePending_, false),
+                        .keyframe = std::exchange(keyframe_, std::nullopt),
+                        .continuation = blockContinues_});
+        block_ = nullptr;
+    }
+
+    void LogWriter::Stream::rotate()
+    {
+        flush();
+        rotatePending_ = true;
+        fileStarted_ = true;
+        fileSize_ = 0;
+    }
+
+    std::size_t LogWriter::blockCountFor(std::size_t streamCount)
+    {
+        return streamCount * kBlocksPerStream + kDefaultBlockCount;
+    }
+
+    LogWriter::LogWriter(std::size_t blockCount, std::size_t blockSize,
+                         std::shared_ptr<SegmentCompressor> segmentCompressor, CommitPolicy commitPolicy,
+                         bool ioUring, std::shared_ptr<StagingArea> stagingArea) :
+        pool_(blockCount, blockSize), reservedBlocks_(std::min<std::size_t>(8, blockCount / 4)),
+        segmentCompressor_(std::move(segmentCompressor)), stagingArea_(std::move(stagingArea)),
+        commitPolicy_(commitPolicy)
+    {
+        requests_.reserve(blockCount);
+        if (ioUring)
+        {
+            uring_ = UringQueue::create(kUringDepth);
+            if (!uring_)
+            {
+                SPDLOG_WARN("io_uring isn't available, so logs will be written directly");
+            }
+            else if (!uring_->registerBuffer(pool_.storage(), pool_.storageSize()))
+            {
+                SPDLOG_DEBUG("Couldn't register log buffers with io_uring: {}", std::strerror(errno));
+            }
+        }
+        worker_ = std::jthread([this](std::stop_token stopToken) { run(std::move(stopToken)); });
+    }
+
+    LogWriter::~LogWriter()
+    {
+        worker_.request_stop();
+        worker_.join();
+        for (auto& file : files_)
+        {
+            closeFile(file);
+            if (file.manifestFd >= 0)
+            {
+                ::close(file.manifestFd);
+            }
+        }
+    }
+
+    std::unique_ptr<LogWriter::Stream> LogWriter::openStream(const std::filesystem::path& path,
+                                                             std::uintmax_t maxFileSize, unsigned int maxFileCount,
+                                                             OverflowPolicy overflowPolicy, bool priority,
+                                                             int compressionLevel)
+    {
+        File* file;
+        {
+            const std::scoped_lock lock(mutex_);
+            file = &files_.emplace_back();
+        }
+        file->path = path;
+        file->maxFileCount = maxFileCount;
+        if (compressionLevel != 0)
+        {
+            file->compressor = std::make_unique<ZstdCompressor>(compressionLevel);
+        }
+        else
+        {
+            // Compressed segments end up much smaller than the maximum, so reserving it would mostly be wasted.
+            file->preallocateSize = maxFileSize;
+        }
+        if (path.has_parent_path())
+        {
+            std::error_code ec;
+            std::filesystem::create_directories(path.parent_path(), ec);
+        }
+
+        const SegmentManifest manifest(path);
+        for (const auto& segment : manifest.segments())
+        {
+            file->segments.push_back(segment.sequence);
+        }
+        // Drop lines for segments that have been removed since, so the manifest doesn't grow forever.
+        manifest.rewrite();
+        const auto manifestPath = segmentManifestPath(path);
+        file->manifestFd = ::open(manifestPath.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC | O_APPEND, 0644);
+        if (file->manifestFd < 0)
+        {
+            SPDLOG_ERROR("Failed opening {}: {}", manifestPath.string(), std::strerror(errno));
+        }
+
+        std::error_code ec;
+        std::uintmax_t recoveredBytes = 0;
+        // Only uncompressed segments can be appended to, and only if they haven't been compressed since. A compressed
+        // segment's last frame may have been cut short, which would hide anything appended after it.
+        if (file->segments.empty() || !std::filesystem::exists(file->currentPath(), ec) ||
+            (file->compressor && std::filesystem::file_size(file->currentPath(), ec) > 0))
+        {
+            rotateFile(*file);
+        }
+        else
+        {
+            // Logging probably stopped with the power, so cut off anything that didn't make it to the disk whole.
+            recoveredBytes = recoverTail(file->currentPath());
+            if (recoveredBytes > 0)
+            {
+                SPDLOG_WARN("Removed {} torn bytes from the end of {}", recoveredBytes,
+                            file->currentPath().string());
+            }
+            openFile(*file, false);
+        }
+        if (segmentCompressor_ && !file->compressor)
+        {
+            // Catch up on anything finished before compression was turned on, or that didn't finish last time.
+            const std::scoped_lock lock(segmentCompressor_->renameMutex());
+            for (const auto sequence : file->segments)
+            {
+                if (sequence != file->segments.back())
+                {
+                    segmentCompressor_->enqueue(file->pathFor(sequence));
+                }
+            }
+        }
+        return std::make_unique<Stream>(*this, *file, file->size, maxFileSize, overflowPolicy, priority,
+                                        recoveredBytes);
+    }
+
+    void LogWriter::submit(const Request& request)
+    {
+        {
+            const std::scoped_lock lock(mutex_);
+            requests_.push_back(request);
+        }
+        requestSubmitted_.notify_one();
+    }
+
+    LogWriter::Reclaimed LogWriter::reclaim(const File& file, bool midRecord)
+    {
+        Reclaimed reclaimed;
+        const std::scoped_lock lock(mutex_);
+        const auto isFile = [&file](const Request& request) { return request.file == &file; };
+        const auto first = std::ranges::find_if(
+            requests_, [&file](const Request& request) { return request.file == &file && !request.continuation; });
+        if (first == requests_.end())
+        {
+            return reclaimed;
+        }
+        auto next = std::find_if(std::next(first), requests_.end(), isFile);
+        while (next != requests_.end() && next->continuation)
+        {
+            next = std::find_if(std::next(next), requests_.end(), isFile);
+        }
+        if (next == requests_.end() && midRecord)
+        {
+            // The record being written started in these blocks.
+            return reclaimed;
+        }
+
+        for (auto it = first; it != next; ++it)
+        {
+            if (it->file != &file)
+            {
+                continue;
+            }
+            reclaimed.rotate = reclaimed.rotate || it->rotate;
+            reclaimed.bytes += it->block->size;
+            ++reclaimed.blockCount;
+            if (reclaimed.block == nullptr)
+            {
+                reclaimed.block = it->block;
+            }
+            else
+            {
+                pool_.release(it->block);
+            }
+            it->block = nullptr;
+        }
+        if (reclaimed.rotate && next != requests_.end())
+        {
+            // The rotation still needs to happen before anything after these blocks is written.
+            next->rotate = true;
+            reclaimed.rotate = false;
+        }
+        std::erase_if(requests_, [](const Request& request) { return request.block == nullptr; });
+        reclaimed.block->size = 0;
+        return reclaimed;
+    }
+
+    void LogWriter::run(std::stop_token stopToken)
+    {
+        std::vector<Request> pending;
+        pending.reserve(pool_.blockCount());
+        while (true)
+        {
+            {
+                std::unique_lock lock(mutex_);
+                const auto requestsWaiting = [this]() { return !requests_.empty(); };
+                if (stagedFiles_.empty())
+                {
+                    requestSubmitted_.wait(lock, stopToken, requestsWaiting);
+                }
+                else
+                {
+                    // Wake up in time to commit the oldest staged data.
+                    requestSubmitted_.wait_until(lock, stopToken,
+                                                 stagedFiles_.front()->stagedSince + commitPolicy_.interval,
+                                                 requestsWaiting);
+                }
+                if (requests_.empty() && stopToken.stop_requested())
+                {
+                    // Stopped, and everything has been written. Files are committed as they are closed.
+                    return;
+                }
+                pending.swap(requests_);
+            }
+            for (const auto& request : pending)
+            {
+                write(request);
+                if (!uring_)
+                {
+                    pool_.release(request.block);
+                }
+            }
+            if (uring_)
+            {
+                // Blocks are written from where they are, so they can't be reused until those writes have finished.
+                waitFor(nullptr);
+                for (const auto& request : pending)
+                {
+                    pool_.release(request.block);
+                }
+            }
+            pending.clear();
+            commitDue();
+            if (unreportedBytes_ > 0)
+            {
+                sigWritten(std::exchange(unreportedBytes_, 0));
+            }
+        }
+    }
+
+    void LogWriter::write(const Request& request)
+    {
+        auto& file = *request.file;
+        if (request.rotate)
+        {
+            rotateFile(file);
+        }
+        else if (file.fd < 0)
+        {
+            openFile(file, false);
+        }
+        if (file.fd < 0)
+        {
+            return;
+        }
+
+        const std::string_view data(request.block->data, request.block->size);
+        if (file.compressor)
+        {
+            if (request.keyframe)
+            {
+                writeCompressed(file, {});
+                writeIndex(file, *request.keyframe);
+            }
+            if (!data.empty())
+            {
+                writeCompressed(file, data);
+            }
+        }
+        else
+        {
+            if (request.keyframe)
+            {
+                writeIndex(file, *request.keyframe);
+            }
+            writeData(file, data);
+        }
+    }
+
+    void LogWriter::writeData(File& file, std::string_view data)
+    {
+        if (commitPolicy_.interval.count() == 0)
+        {
+            writeAt(file, data, file.size, false);
+            file.size += data.size();
+            return;
+        }
+        if (data.empty())
+        {
+            return;
+        }
+        if (file.staged.empty())
+        {
+            file.stagedSince = std::chrono::steady_clock::now();
+            stagedFiles_.push_back(&file);
+        }
+        file.staged.insert(file.staged.end(), data.begin(), data.end());
+        file.size += data.size();
+        stagedBytes_ += data.size();
+    }
+
+    void LogWriter::writeAt(File& file, std::string_view data, std::uintmax_t offset, bool sync)
+    {
+        unreportedBytes_ += data.size();
+        if (stagingArea_)
+        {
+            stagingArea_->reserve(data.size());
+        }
+        if (!uring_)
+        {
+            writeAll(file, data, offset);
+            if (sync)
+            {
+                syncData(file);
+            }
+            return;
+        }
+        if (data.empty() && !sync)
+        {
+            return;
+        }
+        const unsigned int operations = sync ? 2 : 1;
+        while (uring_->inFlight() + operations > uring_->depth())
+        {
+            complete(uring_->wait());
+        }
+        uint64_t tag;
+        if (freeUringWrites_.empty())
+        {
+            tag = uringWrites_.size();
+            uringWrites_.emplace_back();
+        }
+        else
+        {
+            tag = freeUringWrites_.back();
+            freeUringWrites_.pop_back();
+        }
+        uringWrites_[tag] = {.file = &file, .data = data, .offset = offset, .writing = true, .sync = sync};
+        uring_->write(file.fd, data.data(), data.size(), offset, tag, sync);
+        file.inFlight += operations;
+    }
+
+    void LogWriter::complete(const UringQueue::Completion& completion)
+    {
+        auto& uringWrite = uringWrites_[completion.tag];
+        auto& file = *uringWrite.file;
+        --file.inFlight;
+        if (uringWrite.writing)
+        {
+            // Linked operations finish in order, so the write is always first.
+            uringWrite.writing = false;
+            const auto written = static_cast<std::size_t>(std::max(completion.result, 0));
+            if (written < uringWrite.data.size())
+            {
+                // Finish the rest directly, which reports the error if there really is one.
+                writeAll(file, uringWrite.data.substr(written), uringWrite.offset + written);
+            }
+            else
+            {
+                file.failed = false;
+            }
+            if (uringWrite.sync)
+            {
+                return;
+            }
+        }
+        else if (completion.result < 0)
+        {
+            // Cancelled because the write came up short, or failed.
+            syncData(file);
+        }
+        freeUringWrites_.push_back(completion.tag);
+    }
+
+    void LogWriter::waitFor(const File* file)
+    {
+        while (uring_ && (file == nullptr ? uring_->inFlight() > 0 : file->inFlight > 0))
+        {
+            complete(uring_->wait());
+        }
+    }
+
+    void LogWriter::writeAll(File& file, std::string_view data, std::uintmax_t offset)
+    {
+        while (!data.empty())
+        {
+            const auto written = ::pwrite(file.fd, data.data(), data.size(), static_cast<off_t>(offset));
+            if (written < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                if (!file.failed)
+                {
+                    SPDLOG_ERROR("Failed writing to {}: {}", file.currentPath().string(), std::strerror(errno));
+                    file.failed = true;
+                }
+                return;
+            }
+            data.remove_prefix(written);
+            offset += written;
+        }
+        file.failed = false;
+    }
+
+    void LogWriter::syncData(File& file)
+    {
+        if (::fdatasync(file.fd) != 0 && !file.failed)
+        {
+            SPDLOG_ERROR("Failed syncing {}: {}", file.currentPath().string(), std::strerror(errno));
+            file.failed = true;
+        }
+    }
+
+    void LogWriter::commitDue()
+    {
+        if (stagedFiles_.empty())
+        {
+            return;
+        }
+        const bool timeDue =
+            std::chrono::steady_clock::now() - stagedFiles_.front()->stagedSince >= commitPolicy_.interval;
+        if (!timeDue && stagedBytes_ < commitPolicy_.bytes)
+        {
+            return;
+        }
+        // Commit every file at once, so the drive sees one burst of writes instead of a trickle. With io_uring, they
+        // are all in flight together.
+        const std::vector files(stagedFiles_);
+        for (auto* file : files)
+        {
+            startCommit(*file, timeDue);
+        }
+        waitFor(nullptr);
+        for (auto* file : files)
+        {
+            finishCommit(*file);
+        }
+    }
+
+    void LogWriter::commit(File& file, bool whole)
+    {
+        startCommit(file, whole);
+        waitFor(&file);
+        finishCommit(file);
+    }
+
+    void LogWriter::startCommit(File& file, bool whole)
+    {
+        if (file.staged.empty())
+        {
+            return;
+        }
+        auto count = file.staged.size();
+        if (!whole)
+        {
+            // Stop at a cluster boundary, so the filesystem doesn't have to update a partial cluster twice.
+            const auto committedSize = file.size - file.staged.size();
+            const auto alignedSize = file.size / file.clusterSize * file.clusterSize;
+            if (alignedSize <= committedSize)
+            {
+                return;
+            }
+            count = alignedSize - committedSize;
+        }
+        file.committing = count;
+        if (file.fd >= 0)
+        {
+            writeAt(file, {file.staged.data(), count}, file.size - file.staged.size(), true);
+        }
+    }
+
+    void LogWriter::finishCommit(File& file)
+    {
+        if (file.committing == 0)
+        {
+            return;
+        }
+        const auto count = std::exchange(file.committing, 0);
+        const auto waited = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() -
+                                                                                   file.stagedSince);
+        if (waited.count() > longestCommitWait_.load(std::memory_order_relaxed))
+        {
+            longestCommitWait_.store(waited.count(), std::memory_order_relaxed);
+        }
+
+        file.staged.erase(file.staged.begin(), file.staged.begin() + static_cast<std::ptrdiff_t>(count));
+        stagedBytes_ -= count;
+        if (file.staged.empty())
+        {
+            // Whatever is left keeps its place in line, as it is no newer than it was.
+            std::erase(stagedFiles_, &file);
+        }
+    }
+
+    void LogWriter::writeCompressed(File& file, std::string_view data)
+    {
+        // The last output may still be being written from here.
+        waitFor(&file);
+        file.compressed.clear();
+        if (data.empty())
+        {
+            file.compressor->endFrame(file.compressed);
+        }
+        else
+        {
+            file.compressor->compress(data, file.compressed);
+        }
+        writeData(file, {file.compressed.data(), file.compressed.size()});
+        file.fileRawBytes += data.size();
+        file.fileStoredBytes += file.compressed.size();
+        file.rawBytes.fetch_add(data.size(), std::memory_order_relaxed);
+        file.storedBytes.fetch_add(file.compressed.size(), std::memory_order_relaxed);
+    }
+
+    void LogWriter::writeIndex(File& file, spdlog::log_clock::time_point keyframe)
+    {
+        if (file.indexFd < 0)
+        {
+            // Appending, because a file that was already there may have an index too.
+            const auto indexPath = timeIndexPath(file.currentPath());
+            const auto openPath = stagingArea_ ? stagingArea_->stage(indexPath, false) : indexPath;
+            file.indexFd = ::open(openPath.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC | O_APPEND, 0644);
+            if (file.indexFd < 0)
+            {
+                SPDLOG_ERROR("Failed opening {}: {}", indexPath.string(), std::strerror(errno));
+                return;
+            }
+        }
+        const TimeIndexEntry entry{
+            .time = std::chrono::duration_cast<std::chrono::nanoseconds>(keyframe.time_since_epoch()).count(),
+            .offset = file.size,
+        };
+        if (stagingArea_)
+        {
+            stagingArea_->reserve(sizeof(entry));
+        }
+        // Entries are small enough to be written atomically, so a partial one is only possible if the disk is full.
+        if (::write(file.indexFd, &entry, sizeof(entry)) != sizeof(entry))
+        {
+            SPDLOG_ERROR("Failed writing to {}: {}", timeIndexPath(file.currentPath()).string(), std::strerror(errno));
+        }
+    }
+
+    void LogWriter::openFile(File& file, bool truncate)
+    {
+        const auto path = file.currentPath();
+        // The staging area reserves space on the drive instead, as reserving it in memory would be a waste.
+        const auto openPath = stagingArea_ ? stagingArea_->stage(path, truncate, file.preallocateSize) : path;
+        file.fd = ::open(openPath.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC | (truncate ? O_TRUNC : 0), 0644);
+        file.size = 0;
+        struct stat st{};
+        if (file.fd >= 0 && !truncate && ::fstat(file.fd, &st) == 0)
+        {
+            file.size = st.st_size;
+        }
+        struct statvfs vfs{};
+        if (file.fd >= 0 && ::fstatvfs(file.fd, &vfs) == 0 && vfs.f_bsize > 0)
+        {
+            file.clusterSize = vfs.f_bsize;
+        }
+#ifdef PLATFORM_LINUX
+        if (!stagingArea_ && file.fd >= 0 && file.preallocateSize > file.size)
+        {
+            // Keep the size, so the file never ends in reserved space that wasn't written. Not every filesystem can do
+            // this, in which case the file just grows as it is written.
+            file.preallocated = ::fallocate(file.fd, FALLOC_FL_KEEP_SIZE, 0,
+                                            static_cast<off_t>(file.preallocateSize)) == 0;
+        }
+#endif
+        if (file.fd < 0 && !file.failed)
+        {
+            SPDLOG_ERROR("Failed opening {}: {}", path.string(), std::strerror(errno));
+            file.failed = true;
+        }
+    }
+
+    void LogWriter::rotateFile(File& file)
+    {
+        closeFile(file);
+        // Sequence numbers start at 1.
+        const uint64_t previous = file.segments.empty() ? 0 : file.segments.back();
+        file.segments.push_back(previous + 1);
+        openFile(file, true);
+        if (file.manifestFd >= 0)
+        {
+            const auto line = SegmentManifest::line(spdlog::log_clock::now(), file.currentPath());
+            if (::write(file.manifestFd, line.data(), line.size()) != static_cast<ssize_t>(line.size()))
+            {
+                SPDLOG_ERROR("Failed writing to {}: {}", segmentManifestPath(file.path).string(),
+                             std::strerror(errno));
+            }
+        }
+
+        std::unique_lock<std::mutex> lock;
+        if (segmentCompressor_)
+        {
+            lock = std::unique_lock(segmentCompressor_->renameMutex());
+        }
+        removeOldSegments(file);
+        if (segmentCompressor_ && !file.compressor && previous != 0 && file.segments.front() <= previous)
+        {
+            if (stagingArea_)
+            {
+                // Only once all of it is on the drive. That may be right away, so don't hold the lock.
+                lock.unlock();
+                stagingArea_->whenMoved(file.pathFor(previous),
+                                        [segmentCompressor = segmentCompressor_, path = file.pathFor(previous)]()
+                                        {
+                                            const std::scoped_lock lock(segmentCompressor->renameMutex());
+                                            segmentCompressor->enqueue(path);
+                                        });
+            }
+            else
+            {
+                segmentCompressor_->enqueue(file.pathFor(previous));
+            }
+        }
+    }
+
+    void LogWriter::removeOldSegments(File& file)
+    {
+        if (file.maxFileCount == kKeepAllSegments)
+        {
+            return;
+        }
+        while (file.segments.size() > file.maxFileCount + 1)
+        {
+            removeSegment(file.path, file.segments.front());
+            file.segments.pop_front();
+        }
+    }
+
+    void LogWriter::closeFile(File& file)
+    {
+        if (file.fd >= 0)
+        {
+            if (file.compressor)
+            {
+                writeCompressed(file, {});
+                if (file.fileStoredBytes > 0)
+                {
+                    SPDLOG_INFO("Compressed {} {:.1f}:1 ({} bytes to {})", file.currentPath().string(),
+                                double(file.fileRawBytes) / double(file.fileStoredBytes), file.fileRawBytes,
+                                file.fileStoredBytes);
+                }
+            }
+            commit(file, true);
+            waitFor(&file);
+            if (file.preallocated)
+            {
+                // Give back the reserved space that wasn't used.
+                struct stat st{};
+                if (::fstat(file.fd, &st) != 0 || ::ftruncate(file.fd, st.st_size) != 0)
+                {
+                    SPDLOG_ERROR("Failed trimming {}: {}", file.currentPath().string(), std::strerror(errno));
+                }
+                file.preallocated = false;
+            }
+            ::close(file.fd);
+            file.fd = -1;
+        }
+        if (file.compressor)
+        {
+            file.compressor->reset();
+        }
+        file.fileRawBytes = 0;
+        file.fileStoredBytes = 0;
+        if (file.indexFd >= 0)
+        {
+            ::close(file.indexFd);
+            file.indexFd = -1;
+        }
+        if (stagingArea_ && !file.segments.empty())
+        {
+            // The index first, so it is on the drive by the time anything waiting for the segment runs.
+            stagingArea_->finish(timeIndexPath(file.currentPath()));
+            stagingArea_->finish(file.currentPath());
+        }
+    }
+} // namespace sacnlogger
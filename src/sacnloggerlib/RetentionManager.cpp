@@ -0,0 +1,248 @@
+/**
+ * @file RetentionManager.cpp
+ *
+ * @author Dan Keenan
+ * @date 10/17/26
+ * @copyright GPL-3.0-or-later
+ * Copyright (C) 2024-2026 Dan Keenan
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "sacnloggerlib/RetentionManager.h"
+#include <algorithm>
+#include <map>
+#include <spdlog/spdlog.h>
+#include <string>
+#include <vector>
+#include "sacnloggerlib/SegmentManifest.h"
+#include "sacnloggerlib/TimeIndex.h"
+
+namespace sacnlogger
+{
+    struct RetentionManager::Scan
+    {
+        struct Segment
+        {
+            std::filesystem::path logPath;
+            uint64_t sequence;
+            std::filesystem::path path;
+            /** Segments that aren't in the manifest are older than those that are. */
+            spdlog::log_clock::time_point startedAt;
+            std::uintmax_t bytes;
+            std::string universe;
+        };
+
+        /** Segments that can be removed, oldest first. */
+        std::vector<Segment> finished;
+        std::map<std::string, std::uintmax_t> universeBytes;
+        std::uintmax_t totalBytes = 0;
+    };
+
+    RetentionManager::RetentionManager(std::filesystem::path directory, std::uintmax_t budget,
+                                       std::shared_ptr<SegmentCompressor> segmentCompressor,
+                                       std::chrono::milliseconds pollPeriod) :
+        directory_(std::move(directory)), budget_(budget), segmentCompressor_(std::move(segmentCompressor)),
+        pollPeriod_(pollPeriod)
+    {
+        // Make room before logging starts.
+        enforce();
+        worker_ = std::jthread([this](std::stop_token stopToken) { run(std::move(stopToken)); });
+    }
+
+    RetentionManager::~RetentionManager()
+    {
+        worker_.request_stop();
+        worker_.join();
+    }
+
+    std::uintmax_t RetentionManager::budget() const { return budget(scan()); }
+
+    std::uintmax_t RetentionManager::budget(const Scan& scan) const
+    {
+        if (budget_ > 0)
+        {
+            return budget_;
+        }
+        std::error_code ec;
+        const auto space = std::filesystem::space(directory_, ec);
+        if (ec)
+        {
+            // Without knowing better, keep what there is.
+            return scan.totalBytes;
+        }
+        const auto budget = budgetFor(scan.totalBytes, space.capacity, space.available);
+        if (budget < kSmallBudget && !warnedSmallBudget_.exchange(true))
+        {
+            SPDLOG_WARN("Only {} MiB of {} MiB on the drive can be used for logs, so little history will be kept",
+                        budget / (1024 * 1024), space.capacity / (1024 * 1024));
+        }
+        return budget;
+    }
+
+    std::uintmax_t RetentionManager::budgetFor(std::uintmax_t logBytes, std::uintmax_t capacity,
+                                               std::uintmax_t available)
+    {
+        // What the logs use plus what is free is what they could use, if nothing else on the drive grows.
+        const auto reserve = std::max(capacity / 20, std::min(kMinReserve, capacity / 4));
+        const auto usable = logBytes + available;
+        return std::max(usable > reserve ? usable - reserve : 0, usable / 2);
+    }
+
+    std::uintmax_t RetentionManager::segmentSizeFor(std::uintmax_t quota)
+    {
+        constexpr std::uintmax_t kMinSegmentSize = 1024 * 1024;
+        constexpr std::uintmax_t kMaxSegmentSize = 20 * 1024 * 1024;
+        return std::clamp(quota / 20, kMinSegmentSize, kMaxSegmentSize);
+    }
+
+    std::uintmax_t RetentionManager::enforce()
+    {
+        const std::scoped_lock lock(mutex_);
+        auto logs = scan();
+        const auto budget = this->budget(logs);
+        if (logs.totalBytes <= budget)
+        {
+            return 0;
+        }
+        return remove(logs, logs.totalBytes - budget);
+    }
+
+    std::uintmax_t RetentionManager::reclaim(std::uintmax_t bytes)
+    {
+        const std::scoped_lock lock(mutex_);
+        auto logs = scan();
+        return remove(logs, bytes);
+    }
+
+    RetentionManager::Scan RetentionManager::scan() const
+    {
+        // List the directory once, with files grouped by the log they belong to, e.g. `U00001_data`.
+        const auto logKey = [](const std::filesystem::path& path)
+        {
+            const auto filename = path.filename().string();
+            return filename.substr(0, filename.find('.'));
+        };
+        std::map<std::string, std::vector<std::filesystem::path>> files;
+        std::map<std::filesystem::path, std::pair<std::filesystem::file_time_type, std::uintmax_t>> manifests;
+        std::error_code ec;
+        for (const auto& entry : std::filesystem::directory_iterator(directory_, ec))
+        {
+            if (!entry.is_regular_file(ec))
+            {
+                continue;
+            }
+            if (entry.path().extension() == ".manifest")
+            {
+                manifests.emplace(entry.path(), std::make_pair(entry.last_write_time(ec), entry.file_size(ec)));
+            }
+            else
+            {
+                files[logKey(entry.path())].push_back(entry.path());
+            }
+        }
+
+        const std::scoped_lock lock(manifestCacheMutex_);
+        std::erase_if(manifestCache_, [&manifests](const auto& cached) { return !manifests.contains(cached.first); });
+        Scan scan;
+        for (const auto& [manifestPath, version] : manifests)
+        {
+            const auto& [writtenAt, size] = version;
+            auto logPath = manifestPath;
+            logPath.replace_extension();
+            auto& cached = manifestCache_[manifestPath];
+            if (cached.writtenAt != writtenAt || cached.size != size)
+            {
+                cached = {.writtenAt = writtenAt, .size = size, .startTimes = readSegmentStartTimes(logPath)};
+            }
+            const auto filename = logPath.filename().string();
+            const auto universe = filename.substr(0, filename.find('_'));
+            const SegmentManifest manifest(logPath, cached.startTimes, files[logKey(logPath)]);
+            for (const auto& segment : manifest.segments())
+            {
+                std::uintmax_t bytes = 0;
+                for (const auto& path : {segment.path, timeIndexPath(segment.path)})
+                {
+                    const auto size = std::filesystem::file_size(path, ec);
+                    bytes += ec ? 0 : size;
+                }
+                scan.universeBytes[universe] += bytes;
+                scan.totalBytes += bytes;
+                if (&segment != &manifest.segments().back())
+                {
+                    scan.finished.push_back({.logPath = logPath,
+                                             .sequence = segment.sequence,
+                                             .path = segment.path,
+                                             .startedAt = segment.startedAt.value_or(spdlog::log_clock::time_point()),
+                                             .bytes = bytes,
+                                             .universe = universe});
+                }
+            }
+        }
+        std::ranges::stable_sort(scan.finished, {}, &Scan::Segment::startedAt);
+        return scan;
+    }
+
+    std::uintmax_t RetentionManager::remove(Scan& scan, std::uintmax_t bytes)
+    {
+        if (scan.universeBytes.empty())
+        {
+            return 0;
+        }
+        const auto quota = budget(scan) / scan.universeBytes.size();
+        std::uintmax_t removed = 0;
+        while (removed < bytes && !scan.finished.empty())
+        {
+            auto it = std::ranges::find_if(scan.finished, [&scan, quota](const Scan::Segment& segment)
+                                           { return scan.universeBytes[segment.universe] > quota; });
+            if (it == scan.finished.end())
+            {
+                it = scan.finished.begin();
+            }
+            {
+                std::unique_lock<std::mutex> lock;
+                if (segmentCompressor_)
+                {
+                    lock = std::unique_lock(segmentCompressor_->renameMutex());
+                }
+                removeSegment(it->logPath, it->sequence);
+            }
+            SPDLOG_INFO("Removed {} ({} bytes) to make room for new logs", it->path.string(), it->bytes);
+            removed += it->bytes;
+            scan.universeBytes[it->universe] -= it->bytes;
+            scan.finished.erase(it);
+        }
+        removedBytes_.fetch_add(removed, std::memory_order_relaxed);
+        if (removed > 0)
+        {
+            sigRemoved(removed);
+        }
+        return removed;
+    }
+
+    void RetentionManager::run(std::stop_token stopToken)
+    {
+        while (true)
+        {
+            {
+                std::unique_lock lock(waitMutex_);
+                stopped_.wait_for(lock, stopToken, pollPeriod_, []() { return false; });
+            }
+            if (stopToken.stop_requested())
+            {
+                return;
+            }
+            enforce();
+        }
+    }
+} // namespace sacnlogger
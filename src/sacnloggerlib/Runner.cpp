@@ -20,6 +20,8 @@
  */
 
 #include "sacnloggerlib/Runner.h"
+#include <algorithm>
+#include <cstdlib>
 #include <fmt/ranges.h>
 #include <spdlog/spdlog.h>
 
@@ -27,8 +29,33 @@ using namespace boost::placeholders;
 
 namespace sacnlogger
 {
+    namespace
+    {
+        /**
+         * Where to stage logs and listen for commands. systemd's RuntimeDirectory= is in memory, and can be kept while
+         * the service restarts.
+         */
+        std::filesystem::path runtimeDirectory()
+        {
+            if (const auto* runtimeDirectory = std::getenv("RUNTIME_DIRECTORY"))
+            {
+                return runtimeDirectory;
+            }
+            return std::filesystem::temp_directory_path() / "sacnlogger";
+        }
+    } // namespace
+
+    Runner::~Runner()
+    {
+        // The disk space monitor is destroyed last, so stop it first; otherwise it could stop the runner from its own
+        // thread while the members are being destroyed.
+        diskSpaceMonitor_.stop();
+        stop();
+    }
+
     void Runner::start()
     {
+        const std::scoped_lock lock(mutex_);
 #ifdef SACNLOGGER_EMBEDDED_BUILD
         // Configure system.
         if (config_.systemConfig.networkConfig.dhcp)
@@ -51,6 +78,7 @@ namespace sacnlogger
 
         SPDLOG_INFO("Using universes {}", config_.universes);
         SPDLOG_INFO("PAP = {}", config_.usePap);
+        SPDLOG_INFO("Delta rows = {}", config_.logConfig.deltaRows);
 
         // Setup disk space monitor.
         diskSpaceMonitor_.sigCriticalSpace.connect({&Runner::onCriticalDiskSpace, this, _1});
@@ -58,30 +86,120 @@ namespace sacnlogger
         diskSpaceMonitor_.setPath(std::filesystem::current_path());
 
         // Create monitors.
+        if (config_.logConfig.compressRotated)
+        {
+            segmentCompressor_ = std::make_shared<SegmentCompressor>(config_.logConfig.compressionLevel,
+                                                                     config_.logConfig.compressRotatedRate * 1024);
+            segmentCompressor_->sigReclaimed.connect({&DiskSpaceMonitor::addReclaimed, &diskSpaceMonitor_, _1});
+        }
+        retentionManager_ = std::make_unique<RetentionManager>(
+            std::filesystem::current_path(), std::uintmax_t(config_.logConfig.retentionBudget) * 1024 * 1024,
+            segmentCompressor_);
+        retentionManager_->sigRemoved.connect({&DiskSpaceMonitor::addRemoved, &diskSpaceMonitor_, _1});
+        const auto budget = retentionManager_->budget();
+        const auto quota = budget / std::max<std::size_t>(config_.universes.size(), 1);
+        SPDLOG_INFO("Keeping up to {} MiB of logs, {} MiB for each universe", budget / (1024 * 1024),
+                    quota / (1024 * 1024));
+        CommitPolicy commitPolicy{.interval = std::chrono::milliseconds(config_.logConfig.commitInterval),
+                                  .bytes = std::size_t(config_.logConfig.commitSize) * 1024};
+        if (config_.logConfig.stagingSize > 0)
+        {
+            // Anything left from before is moved before logging starts.
+            stagingArea_ = std::make_shared<StagingArea>(runtimeDirectory() / "staging",
+                                                         std::uintmax_t(config_.logConfig.stagingSize) * 1024 * 1024,
+                                                         std::chrono::milliseconds(config_.logConfig.stagingAge));
+            SPDLOG_INFO("Staging up to {} MiB of logs in {}; a power cut can lose up to {} ms of logging",
+                        config_.logConfig.stagingSize, stagingArea_->directory().string(),
+                        config_.logConfig.stagingAge);
+            if (commitPolicy.interval.count() > 0)
+            {
+                // Staged logs are already moved to the drive in groups.
+                SPDLOG_INFO("Not using commitInterval, as logs are staged");
+                commitPolicy.interval = std::chrono::milliseconds(0);
+            }
+        }
+        if (commitPolicy.interval.count() > 0)
+        {
+            SPDLOG_INFO("Committing logs every {} ms or {} KiB; a power cut can lose up to {} ms of logging",
+                        commitPolicy.interval.count(), config_.logConfig.commitSize, commitPolicy.interval.count());
+        }
+        // Each universe has a source and a data stream.
+        const auto blockCount = LogWriter::blockCountFor(config_.universes.size() * 2);
+        logWriter_ = std::make_shared<LogWriter>(blockCount, LogWriter::kDefaultBlockSize, segmentCompressor_,
+                                                 commitPolicy, config_.logConfig.ioUring, stagingArea_);
+        SPDLOG_INFO("Log buffers: {} blocks of {} KiB, {} MiB in all", blockCount, LogWriter::kDefaultBlockSize / 1024,
+                    logWriter_->pool().storageSize() / (1024 * 1024));
+        logWriter_->sigWritten.connect({&DiskSpaceMonitor::addWritten, &diskSpaceMonitor_, _1});
+        const auto& flightRecorder = config_.logConfig.flightRecorder;
+        if (flightRecorder.size > 0)
+        {
+            SPDLOG_INFO("Flight recorder: keeping the last {} s of each universe in memory instead of logging it, "
+                        "{} MiB in all, with {} triggers",
+                        flightRecorder.window, flightRecorder.size * config_.universes.size(),
+                        flightRecorder.triggers.size());
+        }
         for (const auto universe : config_.universes)
         {
             auto& universeMonitor = universeMonitors_.emplace_back(universe);
             universeMonitor.setUsePap(config_.usePap);
+            universeMonitor.setLogConfig(config_.logConfig);
+            universeMonitor.setLogWriter(logWriter_);
+            universeMonitor.setMaxLogFileCount(LogWriter::kKeepAllSegments);
+            universeMonitor.setMaxLogFileSize(RetentionManager::segmentSizeFor(quota));
             universeMonitor.start();
         }
+        if (flightRecorder.size > 0)
+        {
+            controlSocket_ = std::make_unique<ControlSocket>(runtimeDirectory() / "control");
+            controlSocket_->sigDump.connect([this](std::optional<uint16_t> universe)
+                                            { requestDump("requested on the control socket", universe); });
+        }
         running_ = true;
     }
 
     void Runner::stop()
     {
+        std::unique_ptr<ControlSocket> controlSocket;
+        {
+            const std::scoped_lock lock(mutex_);
+            controlSocket = std::move(controlSocket_);
+        }
+        // Not holding the lock, as its worker may be waiting for it in requestDump().
+        controlSocket.reset();
+
+        const std::scoped_lock lock(mutex_);
+        // Dumps anything put off.
         universeMonitors_.clear();
+        if (logWriter_ && logWriter_->commitPolicy().interval.count() > 0)
+        {
+            SPDLOG_INFO("Longest wait for a commit: {} ms", logWriter_->longestCommitWait().count());
+        }
+        // Waits for everything to be written.
+        logWriter_.reset();
+        // Moves whatever is still staged.
+        stagingArea_.reset();
+        retentionManager_.reset();
+        // Anything not compressed yet is picked up again next time.
+        segmentCompressor_.reset();
         running_ = false;
     }
 
     void Runner::setConfig(const Config& config)
     {
-        const auto wasRunning = running_;
+        bool wasRunning;
+        {
+            const std::scoped_lock lock(mutex_);
+            wasRunning = running_;
+        }
         if (wasRunning)
         {
             stop();
         }
 
-        config_ = config;
+        {
+            const std::scoped_lock lock(mutex_);
+            config_ = config;
+        }
 
         if (wasRunning)
         {
@@ -89,11 +207,58 @@ namespace sacnlogger
         }
     }
 
-    void Runner::onLowDiskSpace(std::uintmax_t space) { SPDLOG_WARN("Low disk space: {} bytes available", space); }
+    void Runner::requestDump(std::string_view reason, std::optional<uint16_t> universe)
+    {
+        const std::scoped_lock lock(mutex_);
+        for (auto& universeMonitor : universeMonitors_)
+        {
+            if (!universe || universeMonitor.universe() == *universe)
+            {
+                universeMonitor.requestDump(reason);
+            }
+        }
+    }
 
-    void Runner::onCriticalDiskSpace(std::uintmax_t space)
+    void Runner::onLowDiskSpace(const DiskSpaceForecast& forecast)
     {
-        SPDLOG_ERROR("Critical disk space: {} bytes available", space);
+        if (forecast.timeToFull)
+        {
+            const auto minutes = std::chrono::duration_cast<std::chrono::minutes>(*forecast.timeToFull);
+            SPDLOG_WARN("Low disk space: {} bytes available, full in about {} min at {:.0f} KiB/s ({} bytes reclaimed "
+                        "by compression)",
+                        forecast.available, minutes.count(), forecast.writeRate / 1024,
+                        diskSpaceMonitor_.reclaimedBytes());
+        }
+        else
+        {
+            SPDLOG_WARN("Low disk space: {} bytes available ({} bytes reclaimed by compression)", forecast.available,
+                        diskSpaceMonitor_.reclaimedBytes());
+        }
+    }
+
+    void Runner::onCriticalDiskSpace(const DiskSpaceForecast& forecast)
+    {
+        if (forecast.timeToFull)
+        {
+            SPDLOG_ERROR("Critical disk space: {} bytes available, full in about {} s at {:.0f} KiB/s",
+                         forecast.available, forecast.timeToFull->count(), forecast.writeRate / 1024);
+        }
+        else
+        {
+            SPDLOG_ERROR("Critical disk space: {} bytes available", forecast.available);
+        }
+        // Make enough room to get out of low space, so this doesn't happen again straight away.
+        const auto lowTimeThreshold = std::chrono::duration<double>(diskSpaceMonitor_.lowTimeThreshold()).count();
+        const auto wanted = static_cast<std::uintmax_t>(
+            kReclaimMargin * std::max(static_cast<double>(diskSpaceMonitor_.lowSpaceThreshold()),
+                                      std::max(forecast.writeRate, 0.0) * lowTimeThreshold));
+        {
+            const std::scoped_lock lock(mutex_);
+            if (retentionManager_ && retentionManager_->reclaim(wanted - std::min(forecast.available, wanted)) > 0)
+            {
+                return;
+            }
+        }
         SPDLOG_ERROR("Stopping logger because of disk space.");
         stop();
     }
@@ -0,0 +1,216 @@
+/**
+ * @file SacnLogEncoder.cpp
+ *
+ * @author Dan Keenan
+ * @date 10/17/26
+ * @copyright GPL-3.0-or-later
+ * Copyright (C) 2024-2026 Dan Keenan
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "sacnloggerlib/SacnLogEncoder.h"
+#include <algorithm>
+#include <cstring>
+#include <sacn/cpp/common.h>
+#include "sacnloggerlib/Crc32c.h"
+
+namespace sacnlogger
+{
+    namespace
+    {
+        constexpr std::array<char, sacnlog::kAlignment> kZeros{};
+    } // namespace
+
+    void SourceDictionary::clearHandles() { std::ranges::fill(handleIndexes_, sacnlog::kUnknownOwner); }
+
+    void SourceDictionary::setSource(sacn_remote_source_t handle, const etcpal::Uuid& cid,
+                                   std::string_view abbreviation, std::string_view name)
+    {
+        abbreviation = abbreviation.substr(0, sizeof(sacnlog::SourceRecord::abbreviation));
+        name = name.substr(0, sizeof(sacnlog::SourceRecord::name));
+        // Records are never changed once written, so a renamed source gets a new one.
+        auto it = std::ranges::find_if(records_,
+                                       [&cid, name](const sacnlog::SourceRecord& record)
+                                       {
+                                           return std::memcmp(record.cid, cid.data(), sizeof(record.cid)) == 0 &&
+                                                  std::string_view(record.name, record.nameLength) == name;
+                                       });
+        if (it == records_.end())
+        {
+            if (records_.size() >= sacnlog::kUnknownOwner)
+            {
+                return;
+            }
+            sacnlog::SourceRecord record{};
+            record.index = records_.size();
+            record.abbreviationLength = abbreviation.size();
+            record.nameLength = name.size();
+            std::memcpy(record.cid, cid.data(), sizeof(record.cid));
+            std::ranges::copy(abbreviation, record.abbreviation);
+            std::ranges::copy(name, record.name);
+            it = records_.insert(records_.end(), record);
+        }
+        if (handle >= handleIndexes_.size())
+        {
+            handleIndexes_.resize(handle + 1, sacnlog::kUnknownOwner);
+        }
+        handleIndexes_[handle] = it->index;
+    }
+
+    uint16_t SourceDictionary::ownerIndex(sacn_remote_source_t handle) const
+    {
+        if (handle == sacn::kInvalidRemoteSourceHandle)
+        {
+            return sacnlog::kNoOwner;
+        }
+        return handle < handleIndexes_.size() ? handleIndexes_[handle] : sacnlog::kUnknownOwner;
+    }
+
+    SacnLogEncoder::SacnLogEncoder(uint16_t universe) :
+        universe_(universe), levels_(kFramesPerBlock * SACN_MERGE_RECEIVER_MAX_SLOTS),
+        priorities_(kFramesPerBlock * SACN_MERGE_RECEIVER_MAX_SLOTS),
+        owners_(kFramesPerBlock * SACN_MERGE_RECEIVER_MAX_SLOTS)
+    {
+    }
+
+    void SacnLogEncoder::addFrame(LogWriter::Stream& stream, spdlog::log_clock::time_point time,
+                                  const ComparableData& data, std::size_t slotCount)
+    {
+        slotCount = std::min<std::size_t>(slotCount, SACN_MERGE_RECEIVER_MAX_SLOTS);
+        if (slotCount != slotCount_ && frameCount_ > 0)
+        {
+            flush(stream);
+        }
+        if (frameCount_ == 0)
+        {
+            slotCount_ = slotCount;
+            blockStartedAt_ = time;
+        }
+
+        timestamps_[frameCount_] =
+            std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+        const auto offset = frameCount_ * slotCount_;
+        std::memcpy(levels_.data() + offset, data.levels_.data(), slotCount_);
+        std::memcpy(priorities_.data() + offset, data.priorities_.data(), slotCount_);
+        for (std::size_t slot = 0; slot < slotCount_; ++slot)
+        {
+            owners_[offset + slot] = dictionary_.ownerIndex(data.owners_[slot]);
+        }
+
+        if (++frameCount_ == kFramesPerBlock)
+        {
+            flush(stream);
+        }
+    }
+
+    void SacnLogEncoder::flush(LogWriter::Stream& stream)
+    {
+        const auto& sources = dictionary_.records();
+        if (frameCount_ == 0 && writtenSources_ == sources.size())
+        {
+            return;
+        }
+
+        // Leave room to restate the header and dictionary if this starts a new file.
+        const auto frameBytes =
+            frameCount_ > 0 ? sizeof(sacnlog::ChunkHeader) + sacnlog::frameChunkSize(frameCount_, slotCount_) : 0;
+        const auto startBytes = 4 * sizeof(sacnlog::ChunkHeader) + sizeof(sacnlog::FileHeader) +
+                                sizeof(sacnlog::RecoveryRecord) + sizeof(sacnlog::DroppedRecord) +
+                                sources.size() * sizeof(sacnlog::SourceRecord);
+        if (stream.wouldOverflow(startBytes + frameBytes))
+        {
+            stream.rotate();
+        }
+        const bool fileStarted = stream.takeFileStarted();
+        const auto droppedBytes = stream.takeDroppedBytes();
+        const bool dataLost = droppedBytes > 0;
+        // Keyframes are chunk boundaries, where recovery after a power cut can start reading (see TailRecovery.h).
+        if (fileStarted || dataLost || (frameCount_ > 0 && blockStartedAt_ - lastKeyframeAt_ >= kKeyframeInterval))
+        {
+            const auto keyframeAt = frameCount_ > 0 ? blockStartedAt_ : spdlog::log_clock::now();
+            stream.markKeyframe(keyframeAt);
+            lastKeyframeAt_ = keyframeAt;
+        }
+        if (fileStarted || dataLost)
+        {
+            // Lost data may have included the dictionary, so start over.
+            const sacnlog::FileHeader header{.version = sacnlog::kVersion, .universe = universe_};
+            writeChunk(stream, sacnlog::kFileHeaderChunk, sizeof(header), &header);
+            writtenSources_ = 0;
+        }
+        if (const auto removedBytes = stream.takeRecoveredBytes(); removedBytes > 0)
+        {
+            const sacnlog::RecoveryRecord record{
+                .time = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            spdlog::log_clock::now().time_since_epoch())
+                            .count(),
+                .removedBytes = removedBytes,
+            };
+            writeChunk(stream, sacnlog::kRecoveryChunk, sizeof(record), &record);
+        }
+        if (dataLost)
+        {
+            const sacnlog::DroppedRecord record{
+                .time = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            spdlog::log_clock::now().time_since_epoch())
+                            .count(),
+                .droppedBytes = droppedBytes,
+            };
+            writeChunk(stream, sacnlog::kDroppedChunk, sizeof(record), &record);
+        }
+        if (writtenSources_ < sources.size())
+        {
+            const auto count = sources.size() - writtenSources_;
+            writeChunk(stream, sacnlog::kSourceChunk, count * sizeof(sacnlog::SourceRecord),
+                       sources.data() + writtenSources_);
+            writtenSources_ = sources.size();
+        }
+
+        if (frameCount_ > 0)
+        {
+            const auto chunkSize = sacnlog::frameChunkSize(frameCount_, slotCount_);
+            const sacnlog::FrameBlockHeader blockHeader{.frameCount = static_cast<uint32_t>(frameCount_),
+                                                        .slotCount = static_cast<uint16_t>(slotCount_)};
+            const auto columnSize = frameCount_ * slotCount_;
+            const auto paddingSize = chunkSize - sizeof(blockHeader) - frameCount_ * sizeof(int64_t) - columnSize * 4;
+            // The columns are written straight from where they were collected, so checksum them in place.
+            auto crc = crc32c(&blockHeader, sizeof(blockHeader));
+            crc = crc32c(timestamps_.data(), frameCount_ * sizeof(int64_t), crc);
+            crc = crc32c(levels_.data(), columnSize, crc);
+            crc = crc32c(priorities_.data(), columnSize, crc);
+            crc = crc32c(owners_.data(), columnSize * sizeof(uint16_t), crc);
+            crc = crc32c(kZeros.data(), paddingSize, crc);
+            const sacnlog::ChunkHeader header{
+                .type = sacnlog::kFrameChunk, .size = static_cast<uint32_t>(chunkSize), .crc = crc};
+            stream.beginRecord(sizeof(header) + chunkSize);
+            stream.writeBytes(&header, sizeof(header));
+            stream.writeBytes(&blockHeader, sizeof(blockHeader));
+            stream.writeBytes(timestamps_.data(), frameCount_ * sizeof(int64_t));
+            stream.writeBytes(levels_.data(), columnSize);
+            stream.writeBytes(priorities_.data(), columnSize);
+            stream.writeBytes(owners_.data(), columnSize * sizeof(uint16_t));
+            stream.writeBytes(kZeros.data(), paddingSize);
+            frameCount_ = 0;
+        }
+    }
+
+    void SacnLogEncoder::writeChunk(LogWriter::Stream& stream, uint32_t type, std::size_t size, const void* payload)
+    {
+        const sacnlog::ChunkHeader header{
+            .type = type, .size = static_cast<uint32_t>(size), .crc = crc32c(payload, size)};
+        stream.beginRecord(sizeof(header) + size);
+        stream.writeBytes(&header, sizeof(header));
+        stream.writeBytes(payload, size);
+    }
+} // namespace sacnlogger
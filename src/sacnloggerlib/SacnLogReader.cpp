@@ -0,0 +1,267 @@
+/**
+ * @file SacnLogReader.cpp
+ *
+ * @author Dan Keenan
+ * @date 10/17/26
+ * @copyright GPL-3.0-or-later
+ * Copyright (C) 2024-2026 Dan Keenan
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "sacnloggerlib/SacnLogReader.h"
+#include <cstring>
+#include <fcntl.h>
+#include <fmt/format.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "sacnloggerlib/Crc32c.h"
+#include "sacnloggerlib/CsvRow.h"
+#include "sacnloggerlib/DataRowFormatter.h"
+#include "sacnloggerlib/OwnerTable.h"
+#include "sacnloggerlib/TimestampFormatter.h"
+#include "sacnloggerlib/ZstdStream.h"
+
+namespace sacnlogger
+{
+    SacnLogReader::SacnLogReader(const std::filesystem::path& path)
+    {
+        if (isCompressed(path))
+        {
+            std::error_code ec;
+            if (!std::filesystem::is_regular_file(path, ec))
+            {
+                throw SacnLogException(fmt::format("Could not open {}", path.string()));
+            }
+            decompressed_ = decompressFile(path);
+            data_ = reinterpret_cast<const uint8_t*>(decompressed_.data());
+            size_ = decompressed_.size();
+        }
+        else
+        {
+            map(path);
+        }
+
+        sacnlog::ChunkHeader chunkHeader{};
+        sacnlog::FileHeader fileHeader{};
+        if (size_ >= sizeof(chunkHeader) + sizeof(fileHeader))
+        {
+            std::memcpy(&chunkHeader, data_, sizeof(chunkHeader));
+            std::memcpy(&fileHeader, data_ + sizeof(chunkHeader), sizeof(fileHeader));
+        }
+        if (chunkHeader.type != sacnlog::kFileHeaderChunk)
+        {
+            unmap();
+            throw SacnLogException(fmt::format("{} is not a sacnlog file", path.string()));
+        }
+        if (fileHeader.version != sacnlog::kVersion)
+        {
+            unmap();
+            throw SacnLogException(
+                fmt::format("{} has unsupported sacnlog version {}", path.string(), fileHeader.version));
+        }
+        universe_ = fileHeader.universe;
+    }
+
+    SacnLogReader::~SacnLogReader() { unmap(); }
+
+    void SacnLogReader::map(const std::filesystem::path& path)
+    {
+        const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+        {
+            throw SacnLogException(fmt::format("Could not open {}: {}", path.string(), std::strerror(errno)));
+        }
+        struct stat st{};
+        if (::fstat(fd, &st) != 0)
+        {
+            ::close(fd);
+            throw SacnLogException(fmt::format("Could not read {}: {}", path.string(), std::strerror(errno)));
+        }
+        size_ = st.st_size;
+        if (size_ > 0)
+        {
+            auto* mapped = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped == MAP_FAILED)
+            {
+                ::close(fd);
+                throw SacnLogException(fmt::format("Could not map {}: {}", path.string(), std::strerror(errno)));
+            }
+            ::madvise(mapped, size_, MADV_SEQUENTIAL);
+            data_ = static_cast<const uint8_t*>(mapped);
+            mapped_ = true;
+        }
+        ::close(fd);
+    }
+
+    void SacnLogReader::unmap()
+    {
+        if (mapped_)
+        {
+            ::munmap(const_cast<uint8_t*>(data_), size_);
+            mapped_ = false;
+        }
+        data_ = nullptr;
+    }
+
+    bool SacnLogReader::next(Frame& frame)
+    {
+        if (block_ == nullptr || frameInBlock_ >= block_->frameCount)
+        {
+            if (!nextBlock())
+            {
+                return false;
+            }
+        }
+
+        const auto frameCount = block_->frameCount;
+        const auto slotCount = block_->slotCount;
+        const auto* timestamps = reinterpret_cast<const int64_t*>(block_ + 1);
+        const auto* levels = reinterpret_cast<const uint8_t*>(timestamps + frameCount);
+        const auto* priorities = levels + frameCount * slotCount;
+        const auto* owners = reinterpret_cast<const uint16_t*>(priorities + frameCount * slotCount);
+        const auto offset = frameInBlock_ * slotCount;
+
+        frame.time = spdlog::log_clock::time_point(std::chrono::duration_cast<spdlog::log_clock::duration>(
+            std::chrono::nanoseconds(timestamps[frameInBlock_])));
+        frame.levels = {levels + offset, slotCount};
+        frame.priorities = {priorities + offset, slotCount};
+        frame.owners = {owners + offset, slotCount};
+        ++frameInBlock_;
+        return true;
+    }
+
+    bool SacnLogReader::nextBlock()
+    {
+        block_ = nullptr;
+        while (offset_ + sizeof(sacnlog::ChunkHeader) <= size_)
+        {
+            const auto* chunkHeader = reinterpret_cast<const sacnlog::ChunkHeader*>(data_ + offset_);
+            const auto* payload = data_ + offset_ + sizeof(sacnlog::ChunkHeader);
+            if (chunkHeader->size > size_ - offset_ - sizeof(sacnlog::ChunkHeader))
+            {
+                // Incomplete; the logger probably stopped while writing it.
+                return false;
+            }
+            if (crc32c(payload, chunkHeader->size) != chunkHeader->crc)
+            {
+                // Damaged, e.g. by a power cut before it reached the disk. Nothing after it can be trusted.
+                return false;
+            }
+            offset_ += sizeof(sacnlog::ChunkHeader) + chunkHeader->size;
+
+            switch (chunkHeader->type)
+            {
+                case sacnlog::kFileHeaderChunk:
+                    // Logging restarted, so the dictionary starts over.
+                    sources_.clear();
+                    break;
+                case sacnlog::kSourceChunk:
+                {
+                    const auto* records = reinterpret_cast<const sacnlog::SourceRecord*>(payload);
+                    for (std::size_t ix = 0; ix < chunkHeader->size / sizeof(sacnlog::SourceRecord); ++ix)
+                    {
+                        const auto& record = records[ix];
+                        EtcPalUuid cid;
+                        std::memcpy(cid.data, record.cid, sizeof(cid.data));
+                        if (record.index >= sources_.size())
+                        {
+                            sources_.resize(record.index + 1);
+                        }
+                        sources_[record.index] = Source{
+                            .cid = cid,
+                            .abbreviation = {record.abbreviation, std::min<std::size_t>(record.abbreviationLength,
+                                                                                       sizeof(record.abbreviation))},
+                            .name = {record.name, std::min<std::size_t>(record.nameLength, sizeof(record.name))},
+                        };
+                    }
+                    break;
+                }
+                case sacnlog::kFrameChunk:
+                {
+                    const auto* block = reinterpret_cast<const sacnlog::FrameBlockHeader*>(payload);
+                    if (chunkHeader->size < sizeof(*block) ||
+                        sacnlog::frameChunkSize(block->frameCount, block->slotCount) > chunkHeader->size)
+                    {
+                        return false;
+                    }
+                    if (block->frameCount == 0)
+                    {
+                        continue;
+                    }
+                    block_ = block;
+                    frameInBlock_ = 0;
+                    return true;
+                }
+                default:
+                    // Added in a later version.
+                    break;
+            }
+        }
+        return false;
+    }
+
+    void SacnLogReader::rewind()
+    {
+        offset_ = 0;
+        block_ = nullptr;
+        frameInBlock_ = 0;
+        sources_.clear();
+    }
+
+    const SacnLogReader::Source* SacnLogReader::source(uint16_t ownerIndex) const
+    {
+        if (ownerIndex >= sources_.size() || !sources_[ownerIndex])
+        {
+            return nullptr;
+        }
+        return &*sources_[ownerIndex];
+    }
+
+    void exportCsv(SacnLogReader& reader, std::ostream& out)
+    {
+        TimestampFormatter timestampFormatter;
+        CsvRow row;
+        std::size_t slotCount = 0;
+        SacnLogReader::Frame frame;
+        while (reader.next(frame))
+        {
+            const auto timestamp = timestampFormatter.format(frame.time);
+            if (frame.levels.size() != slotCount)
+            {
+                slotCount = frame.levels.size();
+                out << timestamp << ',' << DataRowFormatter::header(slotCount) << '\n';
+            }
+            row.clear();
+            for (std::size_t slot = 0; slot < slotCount; ++slot)
+            {
+                row << frame.levels[slot] << frame.priorities[slot];
+                const auto owner = frame.owners[slot];
+                if (owner == sacnlog::kNoOwner)
+                {
+                    row << OwnerTable::kNoOwner;
+                }
+                else if (const auto* source = reader.source(owner))
+                {
+                    row << source->abbreviation;
+                }
+                else
+                {
+                    row << OwnerTable::kUnknownOwner;
+                }
+            }
+            out << timestamp << ',' << row.view() << '\n';
+        }
+    }
+} // namespace sacnlogger
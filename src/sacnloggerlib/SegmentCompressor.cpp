@@ -0,0 +1,431 @@
+/**
+ * @file SegmentCompressor.cpp
+ *
+ * @author Dan Keenan
+ * @date 10/17/26
+ * @copyright GPL-3.0-or-later
+ * Copyright (C) 2024-2026 Dan Keenan
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "sacnloggerlib/SegmentCompressor.h"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <optional>
+#include <spdlog/spdlog.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "sacnloggerlib/TimeIndex.h"
+#ifdef PLATFORM_LINUX
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#endif
+
+namespace sacnlogger
+{
+    namespace
+    {
+        constexpr std::size_t kChunkSize = 64 * 1024;
+
+        /**
+         * Closes the file when it goes out of scope.
+         */
+        class FileDescriptor
+        {
+        public:
+            explicit FileDescriptor(int fd) : fd_(fd) {}
+            ~FileDescriptor()
+            {
+                if (fd_ >= 0)
+                {
+                    ::close(fd_);
+                }
+            }
+
+            FileDescriptor(const FileDescriptor&) = delete;
+            FileDescriptor& operator=(const FileDescriptor&) = delete;
+
+            [[nodiscard]] int get() const { return fd_; }
+
+        private:
+            int fd_;
+        };
+
+        std::filesystem::path tempPath(const std::filesystem::path& path, std::string_view suffix)
+        {
+            // Hidden, and nothing like a segment name, so rotation leaves it alone.
+            return path.parent_path() / fmt::format(".{}{}.tmp", path.filename().string(), suffix);
+        }
+
+        bool writeAll(int fd, std::string_view data)
+        {
+            while (!data.empty())
+            {
+                const auto written = ::write(fd, data.data(), data.size());
+                if (written < 0)
+                {
+                    if (errno == EINTR)
+                    {
+                        continue;
+                    }
+                    return false;
+                }
+                data.remove_prefix(written);
+            }
+            return true;
+        }
+
+        /**
+         * Read up to @p size bytes, only stopping early at the end of the file.
+         *
+         * @return Bytes read, or -1 on error.
+         */
+        ssize_t readFull(int fd, char* data, std::size_t size)
+        {
+            std::size_t total = 0;
+            while (total < size)
+            {
+                const auto count = ::read(fd, data + total, size - total);
+                if (count < 0)
+                {
+                    if (errno == EINTR)
+                    {
+                        continue;
+                    }
+                    return -1;
+                }
+                if (count == 0)
+                {
+                    break;
+                }
+                total += count;
+            }
+            return static_cast<ssize_t>(total);
+        }
+
+        /**
+         * Find where the file with @p device and @p inode is now, starting with @p path.
+         */
+        std::optional<std::filesystem::path> findFile(const std::filesystem::path& path, std::uintmax_t device,
+                                                      std::uintmax_t inode)
+        {
+            const auto isFile = [device, inode](const std::filesystem::path& candidate)
+            {
+                struct stat st{};
+                return ::stat(candidate.c_str(), &st) == 0 && st.st_dev == device && st.st_ino == inode;
+            };
+            if (isFile(path))
+            {
+                return path;
+            }
+            std::error_code ec;
+            const auto dir = path.has_parent_path() ? path.parent_path() : std::filesystem::path(".");
+            for (const auto& entry : std::filesystem::directory_iterator(dir, ec))
+            {
+                if (isFile(entry.path()))
+                {
+                    return entry.path();
+                }
+            }
+            return std::nullopt;
+        }
+
+        /**
+         * Check that @p compressedFd decompresses to exactly what is in @p originalFd.
+         */
+        template <typename Pace>
+        bool verify(int originalFd, int compressedFd, Pace pace)
+        {
+            if (::lseek(originalFd, 0, SEEK_SET) < 0 || ::lseek(compressedFd, 0, SEEK_SET) < 0)
+            {
+                return false;
+            }
+            ZstdDecompressor decompressor;
+            std::vector<char> input(kChunkSize);
+            std::vector<char> decompressed;
+            std::vector<char> original;
+            std::uintmax_t verified = 0;
+            while (true)
+            {
+                const auto count = readFull(compressedFd, input.data(), input.size());
+                if (count < 0)
+                {
+                    return false;
+                }
+                if (count == 0)
+                {
+                    break;
+                }
+                decompressed.clear();
+                if (!decompressor.decompress({input.data(), static_cast<std::size_t>(count)}, decompressed))
+                {
+                    return false;
+                }
+                original.resize(decompressed.size());
+                if (readFull(originalFd, original.data(), original.size()) != static_cast<ssize_t>(original.size()) ||
+                    original != decompressed)
+                {
+                    return false;
+                }
+                verified += decompressed.size();
+                if (!pace(verified))
+                {
+                    return false;
+                }
+            }
+            // Nothing may be left over in the original.
+            char extra;
+            return decompressor.frameComplete() && readFull(originalFd, &extra, 1) == 0;
+        }
+    } // namespace
+
+    SegmentCompressor::SegmentCompressor(int level, std::uintmax_t bytesPerSecond) :
+        level_(level), bytesPerSecond_(bytesPerSecond)
+    {
+        worker_ = std::jthread([this](std::stop_token stopToken) { run(std::move(stopToken)); });
+    }
+
+    SegmentCompressor::~SegmentCompressor()
+    {
+        worker_.request_stop();
+        worker_.join();
+    }
+
+    void SegmentCompressor::enqueue(const std::filesystem::path& path)
+    {
+        struct stat st{};
+        if (::stat(path.c_str(), &st) != 0)
+        {
+            return;
+        }
+        {
+            const std::scoped_lock lock(mutex_);
+            queue_.push_back({.path = path, .device = st.st_dev, .inode = st.st_ino});
+        }
+        changed_.notify_all();
+    }
+
+    void SegmentCompressor::waitIdle()
+    {
+        std::unique_lock lock(mutex_);
+        changed_.wait(lock, [this]() { return queue_.empty() && !busy_; });
+    }
+
+    void SegmentCompressor::run(std::stop_token stopToken)
+    {
+#ifdef PLATFORM_LINUX
+        // Only use what the rest of the logger leaves, for both CPU and disk. Both apply to just this thread.
+        ::setpriority(PRIO_PROCESS, static_cast<id_t>(::syscall(SYS_gettid)), 19);
+        constexpr int kIoprioWhoProcess = 1;
+        constexpr int kIoprioClassIdle = 3;
+        constexpr int kIoprioClassShift = 13;
+        ::syscall(SYS_ioprio_set, kIoprioWhoProcess, 0, kIoprioClassIdle << kIoprioClassShift);
+#endif
+        while (true)
+        {
+            Segment segment;
+            {
+                std::unique_lock lock(mutex_);
+                busy_ = false;
+                changed_.notify_all();
+                changed_.wait(lock, stopToken, [this]() { return !queue_.empty(); });
+                if (stopToken.stop_requested())
+                {
+                    queue_.clear();
+                    changed_.notify_all();
+                    return;
+                }
+                segment = std::move(queue_.front());
+                queue_.pop_front();
+                busy_ = true;
+            }
+            const auto reclaimed = compress(segment, stopToken);
+            if (reclaimed > 0)
+            {
+                reclaimedBytes_.fetch_add(reclaimed, std::memory_order_relaxed);
+                sigReclaimed(reclaimed);
+            }
+        }
+    }
+
+    bool SegmentCompressor::pace(std::chrono::steady_clock::time_point start, std::uintmax_t bytes,
+                                 const std::stop_token& stopToken)
+    {
+        if (stopToken.stop_requested())
+        {
+            return false;
+        }
+        if (bytesPerSecond_ == 0)
+        {
+            return true;
+        }
+        const auto until = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                       std::chrono::duration<double>(double(bytes) / double(bytesPerSecond_)));
+        std::unique_lock lock(mutex_);
+        return !changed_.wait_until(lock, stopToken, until, []() { return false; }) && !stopToken.stop_requested();
+    }
+
+    std::uintmax_t SegmentCompressor::compress(const Segment& segment, const std::stop_token& stopToken)
+    {
+        std::filesystem::path path;
+        std::optional<FileDescriptor> original;
+        std::vector<TimeIndexEntry> keyframes;
+        {
+            const std::scoped_lock lock(renameMutex_);
+            const auto current = findFile(segment.path, segment.device, segment.inode);
+            if (!current)
+            {
+                // Already rotated away.
+                return 0;
+            }
+            path = *current;
+            original.emplace(::open(path.c_str(), O_RDONLY | O_CLOEXEC));
+            if (original->get() < 0)
+            {
+                SPDLOG_ERROR("Failed opening {}: {}", path.string(), std::strerror(errno));
+                return 0;
+            }
+            keyframes = TimeIndex(path).entries();
+        }
+
+        const auto compressedTemp = tempPath(path, ".zst");
+        const auto indexTemp = tempPath(path, ".zst.idx");
+        const auto discard = [&compressedTemp, &indexTemp]()
+        {
+            std::error_code ec;
+            std::filesystem::remove(compressedTemp, ec);
+            std::filesystem::remove(indexTemp, ec);
+        };
+        const FileDescriptor compressed(
+            ::open(compressedTemp.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644));
+        if (compressed.get() < 0)
+        {
+            SPDLOG_ERROR("Failed opening {}: {}", compressedTemp.string(), std::strerror(errno));
+            return 0;
+        }
+
+        // Start a frame at each keyframe, so the index still works.
+        ZstdCompressor compressor(level_);
+        std::vector<char> input(kChunkSize);
+        std::vector<char> output;
+        std::uintmax_t rawBytes = 0;
+        std::uintmax_t storedBytes = 0;
+        auto keyframe = keyframes.begin();
+        const auto start = std::chrono::steady_clock::now();
+        while (true)
+        {
+            for (; keyframe != keyframes.end() && keyframe->offset <= rawBytes; ++keyframe)
+            {
+                compressor.endFrame(output);
+                keyframe->offset = storedBytes + output.size();
+            }
+            auto size = input.size();
+            if (keyframe != keyframes.end())
+            {
+                size = std::min<std::uintmax_t>(size, keyframe->offset - rawBytes);
+            }
+            const auto count = readFull(original->get(), input.data(), size);
+            if (count < 0)
+            {
+                SPDLOG_ERROR("Failed reading {}: {}", path.string(), std::strerror(errno));
+                discard();
+                return 0;
+            }
+            if (count == 0)
+            {
+                break;
+            }
+            compressor.compress({input.data(), static_cast<std::size_t>(count)}, output);
+            rawBytes += count;
+            if (!writeAll(compressed.get(), {output.data(), output.size()}))
+            {
+                SPDLOG_ERROR("Failed writing to {}: {}", compressedTemp.string(), std::strerror(errno));
+                discard();
+                return 0;
+            }
+            storedBytes += output.size();
+            output.clear();
+            if (!pace(start, rawBytes, stopToken))
+            {
+                discard();
+                return 0;
+            }
+        }
+        // Keyframes past the end of the file don't point to anything.
+        keyframes.erase(keyframe, keyframes.end());
+        compressor.endFrame(output);
+        if (!writeAll(compressed.get(), {output.data(), output.size()}) || ::fdatasync(compressed.get()) != 0)
+        {
+            SPDLOG_ERROR("Failed writing to {}: {}", compressedTemp.string(), std::strerror(errno));
+            discard();
+            return 0;
+        }
+        storedBytes += output.size();
+
+        // Verification reads the original a second time, so it counts towards the rate limit too.
+        const auto verifyStart = std::chrono::steady_clock::now();
+        if (!verify(original->get(), compressed.get(),
+                    [this, verifyStart, &stopToken](std::uintmax_t bytes)
+                    { return pace(verifyStart, bytes, stopToken); }))
+        {
+            if (!stopToken.stop_requested())
+            {
+                SPDLOG_ERROR("Compressed copy of {} does not match, keeping the original", path.string());
+            }
+            discard();
+            return 0;
+        }
+        if (!keyframes.empty())
+        {
+            const FileDescriptor index(::open(indexTemp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644));
+            const std::string_view indexData(reinterpret_cast<const char*>(keyframes.data()),
+                                             keyframes.size() * sizeof(TimeIndexEntry));
+            if (index.get() < 0 || !writeAll(index.get(), indexData) || ::fdatasync(index.get()) != 0)
+            {
+                SPDLOG_ERROR("Failed writing to {}: {}", indexTemp.string(), std::strerror(errno));
+                discard();
+                return 0;
+            }
+        }
+
+        const std::scoped_lock lock(renameMutex_);
+        const auto current = findFile(path, segment.device, segment.inode);
+        if (!current)
+        {
+            // Rotated out of existence while it was being compressed.
+            discard();
+            return 0;
+        }
+        auto target = *current;
+        target += ".zst";
+        std::error_code ec;
+        std::filesystem::rename(compressedTemp, target, ec);
+        if (ec)
+        {
+            SPDLOG_ERROR("Failed renaming {} to {}: {}", compressedTemp.string(), target.string(), ec.message());
+            discard();
+            return 0;
+        }
+        std::filesystem::remove(timeIndexPath(*current), ec);
+        if (!keyframes.empty())
+        {
+            std::filesystem::rename(indexTemp, timeIndexPath(target), ec);
+        }
+        std::filesystem::remove(*current, ec);
+        SPDLOG_INFO("Compressed {} {:.1f}:1 ({} bytes to {})", current->string(),
+                    storedBytes == 0 ? 1.0 : double(rawBytes) / double(storedBytes), rawBytes, storedBytes);
+        return rawBytes > storedBytes ? rawBytes - storedBytes : 0;
+    }
+} // namespace sacnlogger
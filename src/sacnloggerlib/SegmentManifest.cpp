@@ -0,0 +1,209 @@
+/**
+ * @file SegmentManifest.cpp
+ *
+ * @author Dan Keenan
+ * @date 10/17/26
+ * @copyright GPL-3.0-or-later
+ * Copyright (C) 2024-2026 Dan Keenan
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "sacnloggerlib/SegmentManifest.h"
+#include <algorithm>
+#include <charconv>
+#include <fmt/format.h>
+#include <fstream>
+#include <map>
+#include <spdlog/spdlog.h>
+#include "sacnloggerlib/TimeIndex.h"
+#include "sacnloggerlib/TimestampFormatter.h"
+
+namespace sacnlogger
+{
+    namespace
+    {
+        /** Sequence numbers are padded to this many digits, so segments sort by name. */
+        constexpr std::size_t kSequenceDigits = 6;
+    } // namespace
+
+    std::filesystem::path segmentManifestPath(const std::filesystem::path& logPath)
+    {
+        auto r = logPath;
+        r += ".manifest";
+        return r;
+    }
+
+    std::filesystem::path segmentPath(const std::filesystem::path& logPath, uint64_t sequence)
+    {
+        return logPath.parent_path() / fmt::format("{}.{:0{}d}{}", logPath.stem().string(), sequence, kSequenceDigits,
+                                                   logPath.extension().string());
+    }
+
+    std::optional<uint64_t> segmentSequence(const std::filesystem::path& logPath, std::string_view filename)
+    {
+        const auto stem = logPath.stem().string();
+        const auto extension = logPath.extension().string();
+        if (filename.ends_with(".zst"))
+        {
+            filename.remove_suffix(4);
+        }
+        if (!filename.starts_with(stem) || !filename.ends_with(extension) ||
+            filename.size() < stem.size() + 1 + kSequenceDigits + extension.size() || filename[stem.size()] != '.')
+        {
+            return std::nullopt;
+        }
+        const auto digits = filename.substr(stem.size() + 1, filename.size() - stem.size() - 1 - extension.size());
+        uint64_t sequence;
+        const auto [end, ec] = std::from_chars(digits.data(), digits.data() + digits.size(), sequence);
+        if (ec != std::errc() || end != digits.data() + digits.size() || digits.size() < kSequenceDigits)
+        {
+            return std::nullopt;
+        }
+        return sequence;
+    }
+
+    void removeSegment(const std::filesystem::path& logPath, uint64_t sequence)
+    {
+        // The segment may have been compressed since it was written.
+        const auto uncompressed = segmentPath(logPath, sequence);
+        auto compressed = uncompressed;
+        compressed += ".zst";
+        for (const auto& segment : {uncompressed, compressed})
+        {
+            std::error_code ec;
+            std::filesystem::remove(segment, ec);
+            std::filesystem::remove(timeIndexPath(segment), ec);
+        }
+    }
+
+    std::map<uint64_t, spdlog::log_clock::time_point> readSegmentStartTimes(const std::filesystem::path& logPath)
+    {
+        std::map<uint64_t, spdlog::log_clock::time_point> r;
+        std::ifstream manifest(segmentManifestPath(logPath));
+        std::string line;
+        while (std::getline(manifest, line))
+        {
+            const auto comma = line.find(',');
+            if (comma == std::string::npos)
+            {
+                continue;
+            }
+            auto filename = std::string_view(line).substr(comma + 1);
+            if (filename.size() >= 2 && filename.front() == '"' && filename.back() == '"')
+            {
+                filename = filename.substr(1, filename.size() - 2);
+            }
+            const auto sequence = segmentSequence(logPath, filename);
+            const auto startedAt = TimestampFormatter::parse(std::string_view(line).substr(0, comma));
+            if (sequence && startedAt)
+            {
+                r.insert_or_assign(*sequence, *startedAt);
+            }
+        }
+        return r;
+    }
+
+    SegmentManifest::SegmentManifest(const std::filesystem::path& logPath) : logPath_(logPath)
+    {
+        // The directory is the final word on which segments exist.
+        const auto dir = logPath.has_parent_path() ? logPath.parent_path() : std::filesystem::path(".");
+        std::vector<std::filesystem::path> files;
+        std::error_code ec;
+        for (const auto& entry : std::filesystem::directory_iterator(dir, ec))
+        {
+            if (segmentSequence(logPath, entry.path().filename().string()) && entry.is_regular_file(ec))
+            {
+                files.push_back(entry.path());
+            }
+        }
+        addSegments(readSegmentStartTimes(logPath), files);
+    }
+
+    SegmentManifest::SegmentManifest(const std::filesystem::path& logPath,
+                                     const std::map<uint64_t, spdlog::log_clock::time_point>& startTimes,
+                                     const std::vector<std::filesystem::path>& files) : logPath_(logPath)
+    {
+        addSegments(startTimes, files);
+    }
+
+    void SegmentManifest::addSegments(const std::map<uint64_t, spdlog::log_clock::time_point>& startTimes,
+                                      const std::vector<std::filesystem::path>& files)
+    {
+        for (const auto& file : files)
+        {
+            const auto sequence = segmentSequence(logPath_, file.filename().string());
+            if (!sequence)
+            {
+                continue;
+            }
+            const auto startedAt = startTimes.find(*sequence);
+            segments_.push_back({
+                .sequence = *sequence,
+                .path = logPath_.has_parent_path() ? file : file.filename(),
+                .startedAt = startedAt == startTimes.end() ? std::nullopt : std::optional(startedAt->second),
+            });
+        }
+        // A segment that is there both compressed and not is part way through SegmentCompressor; the original wins.
+        std::ranges::sort(segments_, {}, [](const Segment& segment)
+                          { return std::make_pair(segment.sequence, segment.path.extension() == ".zst"); });
+        const auto duplicates = std::ranges::unique(segments_, {}, &Segment::sequence);
+        segments_.erase(duplicates.begin(), duplicates.end());
+    }
+
+    const SegmentManifest::Segment* SegmentManifest::segmentAt(spdlog::log_clock::time_point time) const
+    {
+        const Segment* r = nullptr;
+        for (const auto& segment : segments_)
+        {
+            if (segment.startedAt && *segment.startedAt <= time)
+            {
+                r = &segment;
+            }
+        }
+        return r;
+    }
+
+    void SegmentManifest::rewrite() const
+    {
+        const auto manifestPath = segmentManifestPath(logPath_);
+        auto tempPath = manifestPath;
+        tempPath += ".tmp";
+        {
+            std::ofstream manifest(tempPath, std::ios::trunc);
+            for (const auto& segment : segments_)
+            {
+                manifest << line(segment.startedAt, segment.path);
+            }
+            if (!manifest)
+            {
+                SPDLOG_ERROR("Failed writing to {}", tempPath.string());
+                return;
+            }
+        }
+        std::error_code ec;
+        std::filesystem::rename(tempPath, manifestPath, ec);
+        if (ec)
+        {
+            SPDLOG_ERROR("Failed renaming {} to {}: {}", tempPath.string(), manifestPath.string(), ec.message());
+        }
+    }
+
+    std::string SegmentManifest::line(std::optional<spdlog::log_clock::time_point> startedAt,
+                                      const std::filesystem::path& segmentPath)
+    {
+        TimestampFormatter timestampFormatter;
+        return fmt::format("{},\"{}\"\n", startedAt ? timestampFormatter.format(*startedAt) : std::string_view(),
+                           segmentPath.filename().string());
+    }
+} // namespace sacnlogger
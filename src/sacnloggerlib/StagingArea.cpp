@@ -0,0 +1,384 @@
+/**
+ * @file StagingArea.cpp
+ *
+ * @author Dan Keenan
+ * @date 10/17/26
+ * @copyright GPL-3.0-or-later
+ * Copyright (C) 2024-2026 Dan Keenan
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "sacnloggerlib/StagingArea.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <spdlog/spdlog.h>
+#include <string_view>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace sacnlogger
+{
+    namespace
+    {
+        /** Large, so the drive sees few writes. */
+        constexpr std::size_t kChunkSize = 1024 * 1024;
+
+        std::uintmax_t fileSize(int fd)
+        {
+            struct stat st{};
+            return ::fstat(fd, &st) == 0 ? static_cast<std::uintmax_t>(st.st_size) : 0;
+        }
+    } // namespace
+
+    StagingArea::StagingArea(std::filesystem::path directory, std::uintmax_t maxBytes,
+                             std::chrono::milliseconds maxAge) :
+        directory_(std::move(directory)), maxBytes_(maxBytes), maxAge_(maxAge)
+    {
+        std::error_code ec;
+        std::filesystem::create_directories(directory_, ec);
+        if (ec)
+        {
+            SPDLOG_ERROR("Failed creating {}: {}", directory_.string(), ec.message());
+        }
+        recover();
+        worker_ = std::jthread([this](std::stop_token stopToken) { run(std::move(stopToken)); });
+    }
+
+    StagingArea::~StagingArea()
+    {
+        worker_.request_stop();
+        worker_.join();
+    }
+
+    std::filesystem::path StagingArea::stagedPathFor(const std::filesystem::path& path) const
+    {
+        return directory_ / std::filesystem::absolute(path).lexically_normal().relative_path();
+    }
+
+    std::filesystem::path StagingArea::stage(const std::filesystem::path& path, bool truncate,
+                                             std::uintmax_t preallocateSize)
+    {
+        {
+            // Anything still waiting to be moved to the same file has to get there first.
+            std::unique_lock lock(mutex_);
+            const auto staged = [this, &path]()
+            { return std::ranges::find(entries_, path, &Entry::path) != entries_.end(); };
+            if (staged())
+            {
+                moveNow_ = true;
+                moveDue_.notify_all();
+                moved_.wait(lock, [&staged]() { return !staged(); });
+            }
+        }
+
+        Entry entry{.path = path, .stagedPath = stagedPathFor(path)};
+        entry.fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC | (truncate ? O_TRUNC : 0), 0644);
+        if (entry.fd < 0)
+        {
+            SPDLOG_ERROR("Failed opening {}: {}", path.string(), std::strerror(errno));
+            entry.failed = true;
+        }
+        else
+        {
+            entry.moved = fileSize(entry.fd);
+#ifdef PLATFORM_LINUX
+            if (preallocateSize > entry.moved)
+            {
+                entry.preallocated =
+                    ::fallocate(entry.fd, FALLOC_FL_KEEP_SIZE, 0, static_cast<off_t>(preallocateSize)) == 0;
+            }
+#endif
+        }
+
+        std::error_code ec;
+        std::filesystem::create_directories(entry.stagedPath.parent_path(), ec);
+        entry.stagedFd = ::open(entry.stagedPath.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        // The same size as the real file, so offsets match, but without using any memory.
+        if (entry.stagedFd < 0 || ::ftruncate(entry.stagedFd, static_cast<off_t>(entry.moved)) != 0)
+        {
+            SPDLOG_ERROR("Failed opening {}: {}", entry.stagedPath.string(), std::strerror(errno));
+        }
+        auto stagedPath = entry.stagedPath;
+        const std::scoped_lock lock(mutex_);
+        entries_.push_back(std::move(entry));
+        return stagedPath;
+    }
+
+    void StagingArea::reserve(std::uintmax_t bytes)
+    {
+        std::unique_lock lock(mutex_);
+        if (waitingBytes_ > 0 && waitingBytes_ + bytes > maxBytes_)
+        {
+            moveNow_ = true;
+            moveDue_.notify_all();
+            moved_.wait(lock, [this, bytes]() { return waitingBytes_ == 0 || waitingBytes_ + bytes <= maxBytes_; });
+        }
+        waitingBytes_ += bytes;
+        if (!waitingSince_)
+        {
+            // The mover waits for this to be old enough.
+            waitingSince_ = std::chrono::steady_clock::now();
+            moveDue_.notify_all();
+        }
+        if (!moveNow_ && waitingBytes_ >= maxBytes_ / 2)
+        {
+            // Leave room for what is written while moving.
+            moveNow_ = true;
+            moveDue_.notify_all();
+        }
+    }
+
+    void StagingArea::finish(const std::filesystem::path& path)
+    {
+        const std::scoped_lock lock(mutex_);
+        for (auto& entry : entries_)
+        {
+            if (entry.path == path)
+            {
+                entry.finished = true;
+            }
+        }
+    }
+
+    void StagingArea::whenMoved(const std::filesystem::path& path, std::function<void()> callback)
+    {
+        {
+            const std::scoped_lock lock(mutex_);
+            const auto it = std::ranges::find(entries_, path, &Entry::path);
+            if (it != entries_.end())
+            {
+                it->whenMoved.push_back(std::move(callback));
+                return;
+            }
+        }
+        callback();
+    }
+
+    void StagingArea::flush()
+    {
+        std::unique_lock lock(mutex_);
+        // A pass that has already started may have missed the latest data.
+        const auto until = passes_ + (moving_ ? 2 : 1);
+        moveNow_ = true;
+        moveDue_.notify_all();
+        moved_.wait(lock, [this, until]() { return passes_ >= until; });
+    }
+
+    void StagingArea::recover()
+    {
+        std::error_code ec;
+        std::vector<char> buffer(kChunkSize);
+        std::vector<std::filesystem::path> leftovers;
+        for (const auto& file : std::filesystem::recursive_directory_iterator(directory_, ec))
+        {
+            if (file.is_regular_file(ec))
+            {
+                leftovers.push_back(file.path());
+            }
+        }
+        for (const auto& stagedPath : leftovers)
+        {
+            Entry entry{.path = std::filesystem::path("/") / stagedPath.lexically_relative(directory_),
+                        .stagedPath = stagedPath};
+            // A file that is gone was removed on purpose, so don't bring it back.
+            entry.fd = ::open(entry.path.c_str(), O_WRONLY | O_CLOEXEC);
+            entry.stagedFd = ::open(stagedPath.c_str(), O_RDWR | O_CLOEXEC);
+            if (entry.fd >= 0 && entry.stagedFd >= 0)
+            {
+                entry.moved = fileSize(entry.fd);
+                if (const auto bytes = move(entry, buffer); bytes > 0)
+                {
+                    SPDLOG_WARN("Moved {} bytes left in the staging area to {}", bytes, entry.path.string());
+                }
+            }
+            close(entry);
+        }
+    }
+
+    void StagingArea::run(std::stop_token stopToken)
+    {
+        std::vector<char> buffer(kChunkSize);
+        while (true)
+        {
+            std::vector<Entry*> entries;
+            std::vector<bool> finished;
+            std::chrono::steady_clock::time_point start;
+            {
+                std::unique_lock lock(mutex_);
+                const auto due = [this]()
+                {
+                    return moveNow_ ||
+                        (waitingSince_ && std::chrono::steady_clock::now() >= *waitingSince_ + maxAge_);
+                };
+                while (!due() && !stopToken.stop_requested())
+                {
+                    if (waitingSince_)
+                    {
+                        moveDue_.wait_until(lock, stopToken, *waitingSince_ + maxAge_, due);
+                    }
+                    else
+                    {
+                        moveDue_.wait(lock, stopToken, [this]() { return moveNow_ || waitingSince_.has_value(); });
+                    }
+                }
+                moveNow_ = false;
+                waitingSince_.reset();
+                moving_ = true;
+                start = std::chrono::steady_clock::now();
+                for (auto& entry : entries_)
+                {
+                    entries.push_back(&entry);
+                    finished.push_back(entry.finished);
+                }
+            }
+
+            // Everything at once, so the drive sees one burst of large writes.
+            const bool stopping = stopToken.stop_requested();
+            std::uintmax_t moved = 0;
+            for (auto* entry : entries)
+            {
+                moved += move(*entry, buffer);
+            }
+            movedBytes_.fetch_add(moved, std::memory_order_relaxed);
+
+            std::vector<std::function<void()>> callbacks;
+            {
+                const std::scoped_lock lock(mutex_);
+                for (std::size_t i = 0; i < entries.size(); ++i)
+                {
+                    auto* entry = entries[i];
+                    // A failed move is retried, unless this is the last chance.
+                    if ((finished[i] && !entry->failed) || stopping)
+                    {
+                        close(*entry);
+                        std::ranges::move(entry->whenMoved, std::back_inserter(callbacks));
+                        entries_.remove_if([entry](const Entry& candidate) { return &candidate == entry; });
+                    }
+                }
+                waitingBytes_ -= std::min(waitingBytes_, moved);
+                if (waitingBytes_ > 0 && (!waitingSince_ || start < *waitingSince_))
+                {
+                    // Reserved before this pass started, but not written in time to be moved by it.
+                    waitingSince_ = start;
+                }
+                moving_ = false;
+                ++passes_;
+            }
+            moved_.notify_all();
+            // Once the staged files are gone, in case they lead to more changes.
+            for (const auto& callback : callbacks)
+            {
+                callback();
+            }
+            if (stopping)
+            {
+                return;
+            }
+        }
+    }
+
+    std::uintmax_t StagingArea::move(Entry& entry, std::vector<char>& buffer)
+    {
+        if (entry.fd < 0 || entry.stagedFd < 0)
+        {
+            return 0;
+        }
+        const auto size = fileSize(entry.stagedFd);
+        auto offset = entry.moved;
+        bool ok = true;
+        while (ok && offset < size)
+        {
+            const auto chunk = std::min<std::uintmax_t>(buffer.size(), size - offset);
+            const auto count = ::pread(entry.stagedFd, buffer.data(), chunk, static_cast<off_t>(offset));
+            if (count < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            ok = count > 0;
+            std::string_view data(buffer.data(), ok ? static_cast<std::size_t>(count) : 0);
+            while (ok && !data.empty())
+            {
+                const auto written = ::pwrite(entry.fd, data.data(), data.size(), static_cast<off_t>(offset));
+                if (written < 0 && errno == EINTR)
+                {
+                    continue;
+                }
+                ok = written > 0;
+                if (ok)
+                {
+                    data.remove_prefix(written);
+                    offset += written;
+                }
+            }
+        }
+        if (offset > entry.moved && ::fdatasync(entry.fd) != 0)
+        {
+            ok = false;
+        }
+        if (!ok && !entry.failed)
+        {
+            SPDLOG_ERROR("Failed moving {} from the staging area: {}", entry.path.string(), std::strerror(errno));
+        }
+        entry.failed = !ok;
+
+#ifdef PLATFORM_LINUX
+        // Free the memory of what has been moved. A partial page at the end stays until it is full.
+        const auto pageSize = static_cast<std::uintmax_t>(::sysconf(_SC_PAGESIZE));
+        const auto punchStart = entry.moved / pageSize * pageSize;
+        const auto punchEnd = offset / pageSize * pageSize;
+        if (punchEnd > punchStart)
+        {
+            ::fallocate(entry.stagedFd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, static_cast<off_t>(punchStart),
+                        static_cast<off_t>(punchEnd - punchStart));
+        }
+#endif
+        const auto moved = offset - entry.moved;
+        entry.moved = offset;
+        return moved;
+    }
+
+    void StagingArea::close(Entry& entry) const
+    {
+        if (entry.fd >= 0)
+        {
+            if (entry.preallocated && ::ftruncate(entry.fd, static_cast<off_t>(fileSize(entry.fd))) != 0)
+            {
+                SPDLOG_ERROR("Failed trimming {}: {}", entry.path.string(), std::strerror(errno));
+            }
+            ::close(entry.fd);
+            entry.fd = -1;
+        }
+        if (entry.stagedFd >= 0)
+        {
+            ::close(entry.stagedFd);
+            entry.stagedFd = -1;
+        }
+        if (!entry.failed)
+        {
+            std::error_code ec;
+            std::filesystem::remove(entry.stagedPath, ec);
+            // Tidy up directories that are now empty, but not the staging area itself.
+            for (auto dir = entry.stagedPath.parent_path(); dir != directory_ && dir.has_relative_path();
+                 dir = dir.parent_path())
+            {
+                if (!std::filesystem::remove(dir, ec))
+                {
+                    break;
+                }
+            }
+        }
+    }
+} // namespace sacnlogger
@@ -0,0 +1,185 @@
+/**
+ * @file TailRecovery.cpp
+ *
+ * @author Dan Keenan
+ * @date 10/17/26
+ * @copyright GPL-3.0-or-later
+ * Copyright (C) 2024-2026 Dan Keenan
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "sacnloggerlib/TailRecovery.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <spdlog/spdlog.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+#include "sacnloggerlib/Crc32c.h"
+#include "sacnloggerlib/SacnLogFormat.h"
+#include "sacnloggerlib/TimeIndex.h"
+#include "sacnloggerlib/ZstdStream.h"
+
+namespace sacnlogger
+{
+    namespace
+    {
+        constexpr std::size_t kScanBlockSize = 65536;
+
+        /**
+         * Read @p size bytes at @p offset.
+         *
+         * @return FALSE if there weren't that many bytes, or they couldn't be read.
+         */
+        bool readAt(int fd, void* data, std::size_t size, std::uintmax_t offset)
+        {
+            auto* bytes = static_cast<char*>(data);
+            while (size > 0)
+            {
+                const auto count = ::pread(fd, bytes, size, static_cast<off_t>(offset));
+                if (count < 0 && errno == EINTR)
+                {
+                    continue;
+                }
+                if (count <= 0)
+                {
+                    return false;
+                }
+                bytes += count;
+                size -= count;
+                offset += count;
+            }
+            return true;
+        }
+
+        /**
+         * Find the end of the last good chunk, checking each one from @p start.
+         */
+        std::uintmax_t sacnLogEnd(int fd, std::uintmax_t size, std::uintmax_t start)
+        {
+            std::vector<char> payload;
+            auto offset = start;
+            while (offset + sizeof(sacnlog::ChunkHeader) <= size)
+            {
+                sacnlog::ChunkHeader header{};
+                if (!readAt(fd, &header, sizeof(header), offset) ||
+                    header.size > size - offset - sizeof(header) || header.size % sacnlog::kAlignment != 0)
+                {
+                    break;
+                }
+                payload.resize(header.size);
+                if (!readAt(fd, payload.data(), payload.size(), offset + sizeof(header)) ||
+                    crc32c(payload.data(), payload.size()) != header.crc)
+                {
+                    break;
+                }
+                offset += sizeof(header) + header.size;
+            }
+            return offset;
+        }
+
+        /**
+         * Find the end of the last complete line without NUL bytes, scanning backwards from the end.
+         */
+        std::uintmax_t textEnd(int fd, std::uintmax_t size)
+        {
+            std::vector<char> buffer(kScanBlockSize);
+            // End of the line being checked, or 0 until its newline has been found.
+            std::uintmax_t lineEnd = 0;
+            auto position = size;
+            while (position > 0)
+            {
+                const auto count = std::min<std::uintmax_t>(position, buffer.size());
+                position -= count;
+                if (!readAt(fd, buffer.data(), count, position))
+                {
+                    // Can't tell, so leave it alone.
+                    return size;
+                }
+                for (auto ix = count; ix > 0; --ix)
+                {
+                    const char c = buffer[ix - 1];
+                    if (c == '\n')
+                    {
+                        if (lineEnd > 0)
+                        {
+                            // Reached the start of the line without finding anything wrong with it.
+                            return lineEnd;
+                        }
+                        lineEnd = position + ix;
+                    }
+                    else if (c == '\0')
+                    {
+                        lineEnd = 0;
+                    }
+                }
+            }
+            return lineEnd;
+        }
+    } // namespace
+
+    std::uintmax_t recoverTail(const std::filesystem::path& path)
+    {
+        if (isCompressed(path))
+        {
+            return 0;
+        }
+        const int fd = ::open(path.c_str(), O_RDWR | O_CLOEXEC);
+        if (fd < 0)
+        {
+            return 0;
+        }
+        struct stat st{};
+        if (::fstat(fd, &st) != 0)
+        {
+            ::close(fd);
+            return 0;
+        }
+        const std::uintmax_t size = st.st_size;
+
+        const TimeIndex index(path);
+        const auto& entries = index.entries();
+        auto end = size;
+        if (path.extension() == ".sacnlog")
+        {
+            // Keyframes are chunk boundaries, so start from the last one that made it to the disk.
+            const auto keyframe = std::ranges::find_if(entries.rbegin(), entries.rend(),
+                                                       [size](const TimeIndexEntry& entry)
+                                                       { return entry.offset < size; });
+            end = sacnLogEnd(fd, size, keyframe == entries.rend() ? 0 : keyframe->offset);
+        }
+        else
+        {
+            end = textEnd(fd, size);
+        }
+        if (end < size && ::ftruncate(fd, static_cast<off_t>(end)) != 0)
+        {
+            SPDLOG_ERROR("Failed truncating {}: {}", path.string(), std::strerror(errno));
+            end = size;
+        }
+        ::close(fd);
+
+        // Entries are in order, so the ones past the end are all at the end of the index.
+        const auto keptEntries = std::ranges::count_if(entries, [end](const TimeIndexEntry& entry)
+                                                       { return entry.offset < end; });
+        if (static_cast<std::size_t>(keptEntries) < entries.size())
+        {
+            std::error_code ec;
+            std::filesystem::resize_file(timeIndexPath(path), keptEntries * sizeof(TimeIndexEntry), ec);
+        }
+        return size - end;
+    }
+} // namespace sacnlogger
@@ -0,0 +1,60 @@
+/**
+ * @file TimeIndex.cpp
+ *
+ * @author Dan Keenan
+ * @date 10/17/26
+ * @copyright GPL-3.0-or-later
+ * Copyright (C) 2024-2026 Dan Keenan
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "sacnloggerlib/TimeIndex.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+
+namespace sacnlogger
+{
+    std::filesystem::path timeIndexPath(const std::filesystem::path& logPath)
+    {
+        auto r = logPath;
+        r += ".idx";
+        return r;
+    }
+
+    TimeIndex::TimeIndex(const std::filesystem::path& logPath)
+    {
+        std::ifstream file(timeIndexPath(logPath), std::ios::binary | std::ios::ate);
+        if (!file)
+        {
+            return;
+        }
+        // A partial entry at the end is from a write that didn't finish.
+        entries_.resize(static_cast<std::size_t>(file.tellg()) / sizeof(TimeIndexEntry));
+        file.seekg(0);
+        file.read(reinterpret_cast<char*>(entries_.data()), entries_.size() * sizeof(TimeIndexEntry));
+        entries_.resize(file.gcount() / sizeof(TimeIndexEntry));
+    }
+
+    const TimeIndexEntry* TimeIndex::keyframeAt(spdlog::log_clock::time_point time) const
+    {
+        const auto timeNs = std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+        const auto it = std::ranges::upper_bound(entries_, timeNs, {}, &TimeIndexEntry::time);
+        if (it == entries_.begin())
+        {
+            return nullptr;
+        }
+        return &*std::prev(it);
+    }
+} // namespace sacnlogger
@@ -0,0 +1,95 @@
+/**
+ * @file TimestampFormatter.cpp
+ *
+ * @author Dan Keenan
+ * @date 10/17/26
+ * @copyright GPL-3.0-or-later
+ * Copyright (C) 2024-2026 Dan Keenan
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "sacnloggerlib/TimestampFormatter.h"
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+
+namespace sacnlogger
+{
+    std::string_view TimestampFormatter::format(spdlog::log_clock::time_point time)
+    {
+        const auto sinceEpoch = time.time_since_epoch();
+        const auto second = std::chrono::floor<std::chrono::seconds>(sinceEpoch);
+        if (second.count() != cachedSecond_)
+        {
+            cachedSecond_ = second.count();
+            std::tm tm{};
+            localtime_r(&cachedSecond_, &tm);
+            cachedSecondLen_ =
+                std::strftime(cachedSecondText_.data(), cachedSecondText_.size(), "%Y-%m-%d %H:%M:%S", &tm);
+            // strftime() gives +hhmm; spdlog writes +hh:mm.
+            std::array<char, 8> zone{};
+            if (std::strftime(zone.data(), zone.size(), "%z", &tm) == 5)
+            {
+                const std::array<char, 6> zoneText{zone[0], zone[1], zone[2], ':', zone[3], zone[4]};
+                std::ranges::copy(zoneText, cachedZoneText_.begin());
+                cachedZoneLen_ = zoneText.size();
+            }
+            else
+            {
+                cachedZoneLen_ = 0;
+            }
+        }
+        const auto millis = std::chrono::duration_cast<std::chrono::milliseconds>(sinceEpoch - second).count();
+
+        auto* out = std::copy_n(cachedSecondText_.data(), cachedSecondLen_, text_.data());
+        *out++ = '.';
+        *out++ = static_cast<char>('0' + millis / 100);
+        *out++ = static_cast<char>('0' + millis / 10 % 10);
+        *out++ = static_cast<char>('0' + millis % 10);
+        out = std::copy_n(cachedZoneText_.data(), cachedZoneLen_, out);
+        return {text_.data(), static_cast<std::size_t>(out - text_.data())};
+    }
+
+    std::optional<spdlog::log_clock::time_point> TimestampFormatter::parse(std::string_view text)
+    {
+        // YYYY-MM-DD HH:MM:SS.mmm+hh:mm
+        static constexpr std::size_t kLength = 29;
+        if (text.size() < kLength || (text[23] != '+' && text[23] != '-') || text[26] != ':')
+        {
+            return std::nullopt;
+        }
+        bool ok = true;
+        const auto field = [&text, &ok](std::size_t pos, std::size_t len)
+        {
+            int r = 0;
+            const auto result = std::from_chars(text.data() + pos, text.data() + pos + len, r);
+            ok = ok && result.ec == std::errc() && result.ptr == text.data() + pos + len;
+            return r;
+        };
+        const std::chrono::year_month_day date{std::chrono::year(field(0, 4)),
+                                               std::chrono::month(static_cast<unsigned int>(field(5, 2))),
+                                               std::chrono::day(static_cast<unsigned int>(field(8, 2)))};
+        const auto timeOfDay = std::chrono::hours(field(11, 2)) + std::chrono::minutes(field(14, 2)) +
+                               std::chrono::seconds(field(17, 2)) + std::chrono::milliseconds(field(20, 3));
+        const auto zone = (std::chrono::hours(field(24, 2)) + std::chrono::minutes(field(27, 2))) *
+                          (text[23] == '-' ? -1 : 1);
+        if (!ok || !date.ok())
+        {
+            return std::nullopt;
+        }
+        const auto utc = std::chrono::sys_days(date) + timeOfDay - zone;
+        return spdlog::log_clock::time_point(
+            std::chrono::duration_cast<spdlog::log_clock::duration>(utc.time_since_epoch()));
+    }
+} // namespace sacnlogger
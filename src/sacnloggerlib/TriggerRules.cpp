@@ -0,0 +1,154 @@
+/**
+ * @file TriggerRules.cpp
+ *
+ * @author Dan Keenan
+ * @date 10/17/26
+ * @copyright GPL-3.0-or-later
+ * Copyright (C) 2024-2026 Dan Keenan
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "sacnloggerlib/TriggerRules.h"
+#include <algorithm>
+#include <fmt/format.h>
+#include <utility>
+
+namespace sacnlogger
+{
+    void TriggerRules::Capture::merge(const Capture& other)
+    {
+        from = std::min(from, other.from);
+        until = std::max(until, other.until);
+    }
+
+    TriggerRules::TriggerRules(uint16_t universe, const std::vector<Trigger>& triggers)
+    {
+        const auto widen = [](std::optional<Window>& rule, const Window& window)
+        {
+            rule = rule ? Window{std::max(rule->pre, window.pre), std::max(rule->post, window.post)} : window;
+        };
+        for (const auto& trigger : triggers)
+        {
+            if (trigger.universe != 0 && trigger.universe != universe)
+            {
+                continue;
+            }
+            const Window window{std::chrono::seconds(trigger.pre), std::chrono::seconds(trigger.post)};
+            const bool hasAddress = trigger.address >= 1 && trigger.address <= SACN_MERGE_RECEIVER_MAX_SLOTS;
+            switch (trigger.event)
+            {
+            case TriggerEvent::Level:
+                if (!hasAddress)
+                {
+                    continue;
+                }
+                levelRules_.push_back({.slot = trigger.address - 1u, .level = trigger.level, .window = window});
+                break;
+            case TriggerEvent::OwnerChange:
+                if (hasAddress)
+                {
+                    ownerRules_.push_back({.slot = trigger.address - 1u, .window = window});
+                }
+                else
+                {
+                    widen(anyOwnerRule_, window);
+                }
+                break;
+            case TriggerEvent::SourceLost:
+                widen(sourceLostRule_, window);
+                break;
+            }
+            longestCapture_ = std::max(longestCapture_, window.pre + window.post);
+        }
+    }
+
+    void TriggerRules::fire(std::optional<Capture>& capture, spdlog::log_clock::time_point time, const Window& window,
+                            std::string reason)
+    {
+        const Capture fired{
+            .reason = std::move(reason), .at = time, .from = time - window.pre, .until = time + window.post};
+        if (capture)
+        {
+            capture->merge(fired);
+        }
+        else
+        {
+            capture = fired;
+        }
+    }
+
+    std::optional<TriggerRules::Capture> TriggerRules::checkFrame(spdlog::log_clock::time_point time,
+                                                                  const ComparableData& previous,
+                                                                  const SacnRecvMergedData& mergedData,
+                                                                  const SlotMask& changedSlots)
+    {
+        std::optional<Capture> capture;
+        const std::size_t offset = mergedData.slot_range.start_address - 1;
+        const std::size_t count = mergedData.slot_range.address_count;
+        const auto inRange = [offset, count](std::size_t slot) { return slot >= offset && slot < offset + count; };
+        const bool started = std::exchange(started_, true);
+
+        for (auto& rule : levelRules_)
+        {
+            if (started && !changedSlots.test(rule.slot))
+            {
+                continue;
+            }
+            // Slots outside of the received range are zero, with no owner.
+            const bool atLevel = (inRange(rule.slot) ? mergedData.levels[rule.slot - offset] : 0) == rule.level;
+            if (atLevel && !rule.atLevel && started)
+            {
+                fire(capture, time, rule.window, fmt::format("address {} went to {}", rule.slot + 1, rule.level));
+            }
+            rule.atLevel = atLevel;
+        }
+        if (!started)
+        {
+            return capture;
+        }
+
+        for (const auto& rule : ownerRules_)
+        {
+            const auto owner =
+                inRange(rule.slot) ? mergedData.owners[rule.slot - offset] : sacn::kInvalidRemoteSourceHandle;
+            if (changedSlots.test(rule.slot) && previous.owners_[rule.slot] != owner)
+            {
+                fire(capture, time, rule.window, fmt::format("owner of address {} changed", rule.slot + 1));
+            }
+        }
+        if (anyOwnerRule_)
+        {
+            const auto changedOwners = previous.diffOwners(mergedData);
+            if (changedOwners.any())
+            {
+                std::optional<std::size_t> first;
+                changedOwners.forEach([&first](std::size_t slot) { first = first.value_or(slot); });
+                fire(capture, time, *anyOwnerRule_,
+                     fmt::format("owner of {} addresses changed, starting at {}", changedOwners.count(), *first + 1));
+            }
+        }
+        return capture;
+    }
+
+    std::optional<TriggerRules::Capture> TriggerRules::checkSourceLost(spdlog::log_clock::time_point time,
+                                                                       std::string_view name) const
+    {
+        std::optional<Capture> capture;
+        if (sourceLostRule_)
+        {
+            fire(capture, time, *sourceLostRule_, fmt::format("{} lost", name));
+        }
+        return capture;
+    }
+} // namespace sacnlogger
@@ -23,95 +23,578 @@
 #include <fmt/format.h>
 #include <fmt/ranges.h>
 #include <sacnloggerlib/CsvRow.h>
-#include <spdlog/async.h>
-#include <spdlog/sinks/rotating_file_sink.h>
 #include <spdlog/spdlog.h>
 
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <ctime>
 #include <memory>
 
 namespace sacnlogger
 {
-    ComparableData::ComparableData(const SacnRecvMergedData& mergedData)
+    namespace
     {
-        const auto addrStartOffset = mergedData.slot_range.start_address - 1;
-        const auto addrCount = mergedData.slot_range.address_count;
-        if (addrStartOffset + addrCount > levels_.size())
+        /**
+         * Name for a flight recorder dump of @p universe made at @p time, e.g.
+         * `U00001_flight.20261017-130806.123.sacnlog`.
+         */
+        std::string dumpFilename(uint16_t universe, spdlog::log_clock::time_point time)
         {
-            SPDLOG_CRITICAL("Received more slots than expected: Got {}, wanted no more than {}", addrCount,
-                            levels_.size());
-            return;
+            const auto sinceEpoch = time.time_since_epoch();
+            const auto second = std::chrono::floor<std::chrono::seconds>(sinceEpoch);
+            const std::time_t secondCount = second.count();
+            std::tm tm{};
+            localtime_r(&secondCount, &tm);
+            std::array<char, 32> timeText{};
+            const auto timeLen = std::strftime(timeText.data(), timeText.size(), "%Y%m%d-%H%M%S", &tm);
+            const auto millis = std::chrono::duration_cast<std::chrono::milliseconds>(sinceEpoch - second).count();
+            return fmt::format("U{:05d}_flight.{}.{:03d}.sacnlog", universe, std::string_view(timeText.data(), timeLen),
+                               millis);
         }
-        std::memcpy(levels_.data() + addrStartOffset, mergedData.levels, addrCount);
-        std::memcpy(priorities_.data() + addrStartOffset, mergedData.priorities, addrCount);
-        std::memcpy(owners_.data() + (addrStartOffset * sizeof(sacn_remote_source_t)), mergedData.owners,
-                    addrCount * sizeof(sacn_remote_source_t));
-    }
+    } // namespace
 
-    ComparableSources::ComparableSources(sacn::MergeReceiver* mergeReceiver, const SacnRecvMergedData& mergedData)
+    uint64_t ComparableSources::fingerprint(const SacnRecvMergedData& mergedData)
     {
+        uint64_t r = mergedData.num_active_sources;
         for (std::size_t ix = 0; ix < mergedData.num_active_sources; ++ix)
         {
-            const auto sourceHandle = mergedData.active_sources[ix];
-            if (const auto source = mergeReceiver->GetSource(sourceHandle))
+            // splitmix64 finalizer, so that different sets of handles with the same sum don't collide.
+            uint64_t x = mergedData.active_sources[ix] + 0x9E3779B97F4A7C15ull;
+            x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+            x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+            r += x ^ (x >> 31);
+        }
+        return r;
+    }
+
+    std::vector<ComparableSources::ComparableSource>
+    ComparableSources::update(sacn::MergeReceiver* mergeReceiver, const SacnRecvMergedData& mergedData,
+                              bool recheckAll)
+    {
+        std::vector<sacn_remote_source_t> handles(mergedData.active_sources,
+                                                  mergedData.active_sources + mergedData.num_active_sources);
+        std::ranges::sort(handles);
+        fingerprint_ = fingerprint(mergedData);
+
+        std::vector<ComparableSource> updated;
+        updated.reserve(handles.size());
+        std::vector<ComparableSource> changed;
+        auto lastIt = sources_.begin();
+        for (const auto handle : handles)
+        {
+            // Handles skipped over here are no longer active.
+            while (lastIt != sources_.end() && lastIt->handle < handle)
+            {
+                ++lastIt;
+            }
+            const bool known = lastIt != sources_.end() && lastIt->handle == handle;
+            if (known && !recheckAll)
+            {
+                updated.push_back(std::move(*lastIt));
+                continue;
+            }
+
+            const auto source = mergeReceiver->GetSource(handle);
+            if (!source)
+            {
+                if (known)
+                {
+                    updated.push_back(std::move(*lastIt));
+                }
+                // Try again with the next packet.
+                fingerprint_.reset();
+                continue;
+            }
+            ComparableSource current{handle, source->cid, source->addr, source->name};
+            if (!known || current != *lastIt)
             {
-                sources_.emplace(source->cid, source->addr, source->name);
+                changed.push_back(current);
             }
+            updated.push_back(std::move(current));
         }
+        sources_ = std::move(updated);
+
+        return changed;
+    }
+
+    void FrameSnapshot::assign(const SacnRecvMergedData& mergedData, spdlog::log_clock::time_point capturedAt)
+    {
+        this->capturedAt = capturedAt;
+        universe = mergedData.universe_id;
+        slotRange = mergedData.slot_range;
+        // Out of range slots are reported when the snapshot is compared.
+        const std::size_t addrCount =
+            std::min<std::size_t>(mergedData.slot_range.address_count, SACN_MERGE_RECEIVER_MAX_SLOTS);
+        std::memcpy(levels.data(), mergedData.levels, addrCount);
+        std::memcpy(priorities.data(), mergedData.priorities, addrCount);
+        std::memcpy(owners.data(), mergedData.owners, addrCount * sizeof(sacn_remote_source_t));
+        activeSources.assign(mergedData.active_sources, mergedData.active_sources + mergedData.num_active_sources);
+    }
+
+    SacnRecvMergedData FrameSnapshot::mergedData() const
+    {
+        SacnRecvMergedData r{};
+        r.universe_id = universe;
+        r.slot_range = slotRange;
+        r.levels = levels.data();
+        r.priorities = priorities.data();
+        r.owners = owners.data();
+        r.active_sources = activeSources.data();
+        r.num_active_sources = activeSources.size();
+        return r;
+    }
+
+    UniverseNotifyHandler::UniverseNotifyHandler(sacn::MergeReceiver* mergeReceiver,
+                                                 std::unique_ptr<LogWriter::Stream> sourceStream,
+                                                 std::unique_ptr<LogWriter::Stream> dataStream,
+                                                 const LogConfig& logConfig, const QueueConfig& queueConfig,
+                                                 std::unique_ptr<SacnLogEncoder> sacnLogEncoder,
+                                                 std::unique_ptr<FlightRecorder> flightRecorder) :
+        mergeReceiver_(mergeReceiver), sourceStream_(std::move(sourceStream)), dataStream_(std::move(dataStream)),
+        dataRowFormatter_(logConfig), selfContained_(logConfig.selfContained),
+        checkpointPeriod_(logConfig.checkpointSeconds),
+        sacnLogEncoder_(std::move(sacnLogEncoder)), flightRecorder_(std::move(flightRecorder)),
+        snapshots_(queueConfig.queueSize)
+    {
+        if (flightRecorder_)
+        {
+            triggerRules_.emplace(flightRecorder_->universe(), logConfig.flightRecorder.triggers);
+        }
+        // Log a header line as a marker for beginning of monitoring.  The data header depends on how many slots the
+        // universe uses, so it is logged with the first row of data.
+        const auto now = spdlog::log_clock::now();
+        writeSourceRow(now, kSourceHeader);
+        if (sourceStream_->takeRecoveredBytes() > 0)
+        {
+            CsvRow row;
+            row << "recovered" << "" << "" << "" << "";
+            writeSourceRow(now, row.view());
+        }
+        worker_ = std::jthread([this](std::stop_token stopToken) { run(std::move(stopToken)); });
+    }
+
+    UniverseNotifyHandler::OverflowCounters UniverseNotifyHandler::overflowCounters() const
+    {
+        // There is no data log when using a flight recorder.
+        const uint64_t dataWaits = dataStream_ ? dataStream_->counters().waits.load() : 0;
+        const uint64_t droppedBlocks = dataStream_ ? dataStream_->counters().droppedBlocks.load() : 0;
+        return {
+            .droppedPackets = snapshots_.overruns(),
+            .writerWaits = sourceStream_->counters().waits + dataWaits,
+            .droppedBlocks = droppedBlocks,
+            .degradedPeriods = degradedPeriods_,
+            .skippedRows = skippedRows_,
+        };
+    }
+
+    void UniverseNotifyHandler::reportOverflow(uint16_t universe)
+    {
+        const auto counters = overflowCounters();
+        if (counters == reportedOverflow_)
+        {
+            return;
+        }
+        SPDLOG_WARN("Universe {}: logging fell behind; {} packets dropped, waited {} times, {} blocks dropped, {} rows "
+                    "skipped",
+                    universe, counters.droppedPackets - reportedOverflow_.droppedPackets,
+                    counters.writerWaits - reportedOverflow_.writerWaits,
+                    counters.droppedBlocks - reportedOverflow_.droppedBlocks,
+                    counters.skippedRows - reportedOverflow_.skippedRows);
+        reportedOverflow_ = counters;
     }
 
     void UniverseNotifyHandler::HandleMergedData(sacn::MergeReceiver::Handle handle,
                                                  const SacnRecvMergedData& mergedData)
     {
-        ComparableSources newSources(mergeReceiver_, mergedData);
-        if (newSources != lastSources_)
+        // Runs on the sACN receive thread, so do as little as possible.
+        const auto capturedAt = spdlog::log_clock::now();
+        auto* snapshot = snapshots_.beginPush();
+        if (snapshot == nullptr)
         {
-            // Sources have changed!
-            for (const auto& newSource : newSources.sources_)
+            // Worker has fallen behind; the next packet that fits will still be compared to the last one logged.
+            return;
+        }
+        snapshot->assign(mergedData, capturedAt);
+        snapshots_.commitPush();
+        wake();
+    }
+
+    void UniverseNotifyHandler::wake()
+    {
+        wakeups_.fetch_add(1, std::memory_order_release);
+        wakeups_.notify_one();
+    }
+
+    void UniverseNotifyHandler::run(std::stop_token stopToken)
+    {
+        const std::stop_callback stopCallback(stopToken, [this]() { wake(); });
+        std::vector<SacnLostSource> lostSources;
+        while (!stopToken.stop_requested())
+        {
+            const auto wakeups = wakeups_.load(std::memory_order_acquire);
+            while (const auto* snapshot = snapshots_.front())
+            {
+                processSnapshot(*snapshot);
+                snapshots_.pop();
+            }
+            if (sacnLogEncoder_ && sacnLogEncoder_->flushDue(spdlog::log_clock::now()))
             {
-                if (!lastSources_.sources_.contains(newSource))
+                sacnLogEncoder_->flush(*dataStream_);
+            }
+            {
+                const std::scoped_lock lock(lostSourcesMutex_);
+                lostSources.swap(lostSources_);
+            }
+            if (!lostSources.empty())
+            {
+                processSourcesLost(lostSources);
+                lostSources.clear();
+            }
+            std::optional<std::string> dumpRequest;
+            {
+                const std::scoped_lock lock(dumpRequestMutex_);
+                dumpRequest.swap(dumpRequest_);
+            }
+            if (dumpRequest)
+            {
+                dumpAll(*dumpRequest);
+            }
+            dumpPending(false);
+            // Rows collect in a block until it is full or has waited long enough, so each write carries many.
+            if (flushDueStreams())
+            {
+                std::this_thread::sleep_for(kFlushPollInterval);
+                continue;
+            }
+            if (pendingCapture_)
+            {
+                // The capture may come due while no packets arrive, e.g. once every source is lost.
+                while (wakeups_.load(std::memory_order_acquire) == wakeups && !stopToken.stop_requested() &&
+                       !captureDue())
                 {
-                    std::string action = "started";
-                    const auto ipAddr = newSource.ipAddr.ip().ToString();
-                    const auto ipAddrIt = cidIpAddrMap_.find(newSource.cid);
-                    if (ipAddrIt != cidIpAddrMap_.end())
-                    {
-                        action = "moved";
-                    }
-                    cidIpAddrMap_.insert_or_assign(newSource.cid, ipAddr);
-                    CsvRow row;
-                    row << action << abbreviationMap_.abbreviationForUuid(newSource.cid) << newSource.cid.ToString()
-                        << ipAddr << newSource.name;
-                    sourceLogger_->info(row.string());
+                    std::this_thread::sleep_for(kCapturePollInterval);
                 }
+                continue;
             }
-            lastSources_ = std::move(newSources);
+            wakeups_.wait(wakeups, std::memory_order_acquire);
+        }
+        if (sacnLogEncoder_)
+        {
+            sacnLogEncoder_->flush(*dataStream_);
+        }
+        sourceStream_->flush();
+        if (dataStream_)
+        {
+            dataStream_->flush();
+        }
+        dumpPending(true);
+    }
+
+    bool UniverseNotifyHandler::flushDueStreams()
+    {
+        const auto now = std::chrono::steady_clock::now();
+        bool pending = false;
+        for (auto* stream : {sourceStream_.get(), dataStream_.get()})
+        {
+            if (stream == nullptr)
+            {
+                continue;
+            }
+            if (stream->flushDue(now))
+            {
+                stream->flush();
+            }
+            pending = pending || stream->pending();
+        }
+        return pending;
+    }
+
+    void UniverseNotifyHandler::requestDump(std::string_view reason)
+    {
+        {
+            const std::scoped_lock lock(dumpRequestMutex_);
+            dumpRequest_ = reason;
         }
+        wake();
+    }
+
+    void UniverseNotifyHandler::triggerDump(const TriggerRules::Capture& capture)
+    {
+        if (!pendingCapture_)
+        {
+            pendingCapture_ = capture;
+        }
+        else
+        {
+            // A trigger that keeps firing can't hold the capture open for longer than the recorder keeps data.
+            pendingCapture_->merge(capture);
+            auto& until = pendingCapture_->until;
+            until = std::min(until, pendingCapture_->from + flightRecorder_->window());
+        }
+        dumpPending(false);
+    }
 
-        ComparableData newData(mergedData);
-        if (newData != lastData_)
+    void UniverseNotifyHandler::dumpPending(bool force)
+    {
+        if (!pendingCapture_ || !flightRecorder_)
         {
+            return;
+        }
+        if (!force && !captureDue())
+        {
+            return;
+        }
+        const auto universe = flightRecorder_->universe();
+        const auto& capture = *pendingCapture_;
+        if (const auto oldest = flightRecorder_->oldest(); oldest && *oldest > capture.from)
+        {
+            SPDLOG_WARN("Universe {}: flight recorder is too small for all of the {} s before {}", universe,
+                        std::chrono::duration_cast<std::chrono::seconds>(capture.at - capture.from).count(),
+                        capture.reason);
+        }
+        const auto path = std::filesystem::path(dumpFilename(universe, capture.at));
+        if (flightRecorder_->dump(path, capture.from, capture.until))
+        {
+            SPDLOG_INFO("Universe {}: {}, wrote {} s around it to {}", universe, capture.reason,
+                        std::chrono::duration_cast<std::chrono::seconds>(capture.until - capture.from).count(),
+                        path.string());
+        }
+        pendingCapture_.reset();
+        lastDumpAt_ = std::chrono::steady_clock::now();
+    }
+
+    bool UniverseNotifyHandler::captureDue() const
+    {
+        return pendingCapture_ && spdlog::log_clock::now() >= pendingCapture_->until &&
+               (!lastDumpAt_ || std::chrono::steady_clock::now() - *lastDumpAt_ >= kMinDumpInterval);
+    }
+
+    void UniverseNotifyHandler::dumpAll(std::string_view reason)
+    {
+        if (!flightRecorder_)
+        {
+            return;
+        }
+        const auto path = std::filesystem::path(dumpFilename(flightRecorder_->universe(), spdlog::log_clock::now()));
+        if (flightRecorder_->dump(path))
+        {
+            SPDLOG_INFO("Universe {}: {}, wrote the last {} changes to {}", flightRecorder_->universe(), reason,
+                        flightRecorder_->frameCount(), path.string());
+        }
+        lastDumpAt_ = std::chrono::steady_clock::now();
+    }
+
+    void UniverseNotifyHandler::processSnapshot(const FrameSnapshot& snapshot)
+    {
+        const auto mergedData = snapshot.mergedData();
+        const auto now = std::chrono::steady_clock::now();
+        const bool recheckSources = now - lastSourceRecheck_ >= kSourceRecheckInterval;
+        if (recheckSources || lastSources_.handlesChanged(mergedData))
+        {
+            if (recheckSources)
+            {
+                lastSourceRecheck_ = now;
+                reportOverflow(snapshot.universe);
+            }
+            const auto changedSources = lastSources_.update(mergeReceiver_, mergedData, recheckSources);
+            for (const auto& newSource : changedSources)
+            {
+                // Sources have changed!
+                std::string action = "started";
+                const auto ipAddr = newSource.ipAddr.ip().ToString();
+                const auto ipAddrIt = cidIpAddrMap_.find(newSource.cid);
+                if (ipAddrIt != cidIpAddrMap_.end())
+                {
+                    action = "moved";
+                }
+                cidIpAddrMap_.insert_or_assign(newSource.cid, ipAddr);
+                const auto abbreviation = abbreviationMap_.abbreviationForUuid(newSource.cid);
+                CsvRow row;
+                row << action << abbreviation << newSource.cid.ToString() << ipAddr << newSource.name;
+                writeSourceRow(snapshot.capturedAt, row.view());
+                if (selfContained_ && !sacnLogEncoder_)
+                {
+                    pendingDataSources_.push_back(
+                        DataRowFormatter::sourceRow(abbreviation, newSource.cid.ToString(), ipAddr, newSource.name));
+                }
+            }
+            updateOwnerTable();
+        }
+
+        const auto changedSlots = lastData_.diff(mergedData);
+        if (changedSlots.any())
+        {
+            if (flightRecorder_)
+            {
+                recordSnapshot(snapshot, mergedData, changedSlots);
+                return;
+            }
+            if (dataStream_->overflowPolicy() == OverflowPolicy::Degrade && skipWhileDegraded(snapshot.capturedAt))
+            {
+                // lastData_ is left alone, so these changes are included in the next row.
+                return;
+            }
+            lastData_.assign(mergedData);
+            lastRowAt_ = snapshot.capturedAt;
+            const auto slotCount = mergedData.slot_range.start_address - 1 + mergedData.slot_range.address_count;
+
             // Data has changed!
-            std::unordered_map<sacn_remote_source_t, std::string> sourceNames;
-            for (std::size_t ix = 0; ix < mergedData.num_active_sources; ++ix)
+            if (sacnLogEncoder_)
+            {
+                dataRowFormatter_.widen(slotCount);
+                sacnLogEncoder_->addFrame(*dataStream_, snapshot.capturedAt, lastData_, dataRowFormatter_.slotCount());
+                return;
+            }
+            if (dataStream_->wouldOverflow(kRotateHeadroom))
+            {
+                dataStream_->rotate();
+            }
+            // Only log as many slots as this universe has used, starting a new header whenever that grows.  New files
+            // also get a header so each one can be read on its own.
+            const bool widened = dataRowFormatter_.widen(slotCount);
+            const bool fileStarted = dataStream_->takeFileStarted();
+            const auto droppedBytes = dataStream_->takeDroppedBytes();
+            const auto recoveredBytes = dataStream_->takeRecoveredBytes();
+            const bool dataLost = droppedBytes > 0;
+            const bool headerDue = fileStarted || dataLost || widened;
+            if (headerDue)
             {
-                const auto sourceHandle = mergedData.active_sources[ix];
-                if (const auto source = mergeReceiver_->GetSource(sourceHandle))
+                dataRowFormatter_.requestFullRow();
+            }
+            // Full rows are keyframes for the time index.  Besides the regular checkpoints, there is one at the start
+            // of each file and at least every checkpointPeriod_.
+            const bool keyframeDue =
+                fileStarted || dataLost || snapshot.capturedAt - lastKeyframeAt_ >= checkpointPeriod_;
+            if (keyframeDue)
+            {
+                dataRowFormatter_.requestFullRow();
+            }
+            const bool keyframe = keyframeDue || (dataRowFormatter_.deltaRows() && dataRowFormatter_.fullRowNext());
+            if (keyframe)
+            {
+                dataStream_->markKeyframe(snapshot.capturedAt);
+                lastKeyframeAt_ = snapshot.capturedAt;
+            }
+            // The header always comes first in a file, so readers that expect the usual columns find them there.
+            if (headerDue)
+            {
+                dataStream_->write(snapshot.capturedAt, dataRowFormatter_.header());
+            }
+            if (selfContained_)
+            {
+                if (recoveredBytes > 0)
+                {
+                    dataStream_->write(snapshot.capturedAt, DataRowFormatter::recoveryRow(recoveredBytes));
+                }
+                if (dataLost)
+                {
+                    dataStream_->write(snapshot.capturedAt, DataRowFormatter::droppedRow(droppedBytes));
+                }
+                if (keyframe)
+                {
+                    // Keyframes start with the active sources, so owners can be looked up from there on.
+                    pendingDataSources_.clear();
+                    writeDataSources(snapshot.capturedAt);
+                }
+                for (const auto& sourceRow : pendingDataSources_)
                 {
-                    sourceNames.emplace(sourceHandle, abbreviationMap_.abbreviationForUuid(source->cid));
+                    dataStream_->write(snapshot.capturedAt, sourceRow);
                 }
             }
+            pendingDataSources_.clear();
+            dataStream_->write(snapshot.capturedAt, dataRowFormatter_.format(lastData_, changedSlots, ownerTable_));
+        }
+    }
 
-            CsvRow row;
-            auto levelsIt = newData.levels_.cbegin();
-            auto prioritiesIt = newData.priorities_.cbegin();
-            auto ownersIt = newData.owners_.cbegin();
-            for (; levelsIt != newData.levels_.cend(); ++levelsIt, ++prioritiesIt, ++ownersIt)
+    void UniverseNotifyHandler::recordSnapshot(const FrameSnapshot& snapshot, const SacnRecvMergedData& mergedData,
+                                               const SlotMask& changedSlots)
+    {
+        // Checked before lastData_ is updated, so owner triggers can see what changed.
+        const auto capture = triggerRules_->checkFrame(snapshot.capturedAt, lastData_, mergedData, changedSlots);
+        lastData_.assign(mergedData);
+        dataRowFormatter_.widen(mergedData.slot_range.start_address - 1 + mergedData.slot_range.address_count);
+        flightRecorder_->addFrame(snapshot.capturedAt, lastData_, dataRowFormatter_.slotCount());
+        if (capture)
+        {
+            triggerDump(*capture);
+        }
+    }
+
+    void UniverseNotifyHandler::writeSourceRow(spdlog::log_clock::time_point time, std::string_view row)
+    {
+        if (sourceStream_->wouldOverflow(kRotateHeadroom))
+        {
+            sourceStream_->rotate();
+        }
+        if (sourceStream_->takeFileStarted() && row != kSourceHeader)
+        {
+            // Restate the sources that started in earlier files, so each file can be read on its own.
+            sourceStream_->write(time, kSourceHeader);
+            for (const auto& source : lastSources_.sources_)
+            {
+                CsvRow activeRow;
+                activeRow << "active" << abbreviationMap_.abbreviationForUuid(source.cid) << source.cid.ToString()
+                          << source.ipAddr.ip().ToString() << source.name;
+                sourceStream_->write(time, activeRow.view());
+            }
+        }
+        sourceStream_->write(time, row);
+    }
+
+    void UniverseNotifyHandler::writeDataSources(spdlog::log_clock::time_point time)
+    {
+        for (const auto& source : lastSources_.sources_)
+        {
+            dataStream_->write(time, DataRowFormatter::sourceRow(abbreviationMap_.abbreviationForUuid(source.cid),
+                                                                 source.cid.ToString(), source.ipAddr.ip().ToString(),
+                                                                 source.name));
+        }
+    }
+
+    bool UniverseNotifyHandler::skipWhileDegraded(spdlog::log_clock::time_point time)
+    {
+        const auto freeBlockRatio = dataStream_->freeBlockRatio();
+        if (!degraded_ && freeBlockRatio < kDegradeBelow)
+        {
+            degraded_ = true;
+            degradedPeriods_.fetch_add(1, std::memory_order_relaxed);
+        }
+        else if (degraded_ && freeBlockRatio > kRecoverAbove)
+        {
+            degraded_ = false;
+        }
+        if (degraded_ && time - lastRowAt_ < kDegradedRowInterval)
+        {
+            skippedRows_.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+        return false;
+    }
+
+    void UniverseNotifyHandler::updateOwnerTable()
+    {
+        ownerTable_.clear();
+        if (sacnLogEncoder_)
+        {
+            sacnLogEncoder_->clearHandles();
+        }
+        if (flightRecorder_)
+        {
+            flightRecorder_->sources().clearHandles();
+        }
+        for (const auto& source : lastSources_.sources_)
+        {
+            const auto abbreviation = abbreviationMap_.abbreviationForUuid(source.cid);
+            ownerTable_.set(source.handle, abbreviation);
+            if (sacnLogEncoder_)
             {
-                const auto sourceName = *ownersIt == sacn::kInvalidRemoteSourceHandle ? "-" : sourceNames.at(*ownersIt);
-                row << static_cast<unsigned int>(*levelsIt) << static_cast<unsigned int>(*prioritiesIt) << sourceName;
+                sacnLogEncoder_->setSource(source.handle, source.cid, abbreviation, source.name);
+            }
+            if (flightRecorder_)
+            {
+                flightRecorder_->sources().setSource(source.handle, source.cid, abbreviation, source.name);
             }
-            dataLogger_->info(row.string());
-            lastData_ = std::move(newData);
         }
     }
 
@@ -124,6 +607,16 @@ namespace sacnlogger
 
     void UniverseNotifyHandler::HandleSourcesLost(sacn::MergeReceiver::Handle handle, uint16_t universe,
                                                   const std::vector<SacnLostSource>& lostSources)
+    {
+        // Sources are rarely lost, so a lock is fine here.
+        {
+            const std::scoped_lock lock(lostSourcesMutex_);
+            lostSources_.insert(lostSources_.end(), lostSources.begin(), lostSources.end());
+        }
+        wake();
+    }
+
+    void UniverseNotifyHandler::processSourcesLost(const std::vector<SacnLostSource>& lostSources)
     {
         for (const auto& source : lostSources)
         {
@@ -140,43 +633,73 @@ namespace sacnlogger
             CsvRow row;
             row << "stopped" << abbreviationMap_.abbreviationForUuid(source.cid) << etcpal::Uuid(source.cid).ToString()
                 << sourceIpAddr << source.name;
-            sourceLogger_->info(row.string());
+            writeSourceRow(spdlog::log_clock::now(), row.view());
             cidIpAddrMap_.erase(sourceCid);
         }
+        if (triggerRules_)
+        {
+            const auto now = spdlog::log_clock::now();
+            for (const auto& source : lostSources)
+            {
+                if (const auto capture = triggerRules_->checkSourceLost(now, source.name))
+                {
+                    triggerDump(*capture);
+                }
+            }
+        }
+    }
+
+    UniverseMonitor::~UniverseMonitor()
+    {
+        // The sACN thread must stop calling the handler before it goes, but its worker still looks up sources in the
+        // receiver until it has stopped, so the receiver is only deleted after that.
+        if (mergeReceiver_)
+        {
+            mergeReceiver_->Shutdown();
+        }
+        notifyHandler_.reset();
     }
 
     void UniverseMonitor::start()
     {
         SPDLOG_INFO("Starting universe monitor for universe {}", universe_);
         // Setup loggers.
-        // Source logger.
-        const auto sourceLoggerName = fmt::format("U{:05d}_sources", universe_);
-        sourceLogger_ = spdlog::rotating_logger_mt<spdlog::async_factory>(
-            sourceLoggerName, fmt::format("{}.csv", sourceLoggerName), maxLogFileSize, maxLogFileCount);
-        sourceLogger_->set_pattern(kLoggerPattern);
-
-        // Data logger.
-        const auto dataLoggerName = fmt::format("U{:05d}_data", universe_);
-        dataLogger_ = spdlog::rotating_logger_mt<spdlog::async_factory>(
-            dataLoggerName, fmt::format("{}.csv", dataLoggerName), maxLogFileSize, maxLogFileCount);
-        dataLogger_->set_pattern(kLoggerPattern);
-
-        // Log a header line as a marker for beginning of monitoring.
-        sourceLogger_->info("State,Marker,CID,IP Address,Name");
-        CsvRow dataLoggerHeader;
-        for (unsigned int addr = 1; addr <= SACN_MERGE_RECEIVER_MAX_SLOTS; ++addr)
+        if (!logWriter_)
         {
-            dataLoggerHeader << fmt::format("{:03d} Lvl", addr) << fmt::format("{:03d} Pri", addr)
-                             << fmt::format("{:03d} Src", addr);
+            logWriter_ = std::make_shared<LogWriter>();
+        }
+        const auto& queueConfig = logConfig_.queueFor(universe_);
+        // Source changes are rare and important, so they get their own lane that never drops.
+        auto sourceStream = logWriter_->openStream(fmt::format("U{:05d}_sources.csv", universe_), maxLogFileSize_,
+                                                   maxLogFileCount_, OverflowPolicy::Block, true);
+        std::unique_ptr<LogWriter::Stream> dataStream;
+        std::unique_ptr<SacnLogEncoder> sacnLogEncoder;
+        std::unique_ptr<FlightRecorder> flightRecorder;
+        if (logConfig_.flightRecorder.size > 0)
+        {
+            // Keep enough to capture the longest trigger.
+            const TriggerRules triggerRules(universe_, logConfig_.flightRecorder.triggers);
+            flightRecorder = std::make_unique<FlightRecorder>(
+                universe_, std::size_t(logConfig_.flightRecorder.size) * 1024 * 1024,
+                std::max(std::chrono::seconds(logConfig_.flightRecorder.window), triggerRules.longestCapture()));
+        }
+        else
+        {
+            const bool sacnLog = logConfig_.dataFormat == DataFormat::SacnLog;
+            dataStream = logWriter_->openStream(
+                fmt::format("U{:05d}_data.{}", universe_, sacnLog ? "sacnlog" : "csv"), maxLogFileSize_,
+                maxLogFileCount_, queueConfig.overflowPolicy, false,
+                logConfig_.compression == Compression::Zstd ? logConfig_.compressionLevel : 0);
+            sacnLogEncoder = sacnLog ? std::make_unique<SacnLogEncoder>(universe_) : nullptr;
         }
-        dataLogger_->info(dataLoggerHeader.string());
 
         // Setup merge receiver.
         sacn::MergeReceiver::Settings settings(universe_);
         settings.use_pap = usePap_;
         mergeReceiver_.reset(new sacn::MergeReceiver);
-        notifyHandler_ =
-            std::make_unique<UniverseNotifyHandler>(mergeReceiver_.get(), sourceLogger_.get(), dataLogger_.get());
+        notifyHandler_ = std::make_unique<UniverseNotifyHandler>(mergeReceiver_.get(), std::move(sourceStream),
+                                                                 std::move(dataStream), logConfig_, queueConfig,
+                                                                 std::move(sacnLogEncoder), std::move(flightRecorder));
         const auto err = mergeReceiver_->Startup(settings, *notifyHandler_);
         if (!err.IsOk())
         {
@@ -188,4 +711,12 @@ namespace sacnlogger
         }
     }
 
+    void UniverseMonitor::requestDump(std::string_view reason)
+    {
+        if (notifyHandler_)
+        {
+            notifyHandler_->requestDump(reason);
+        }
+    }
+
 } // namespace sacnlogger
@@ -0,0 +1,233 @@
+/**
+ * @file UringQueue.cpp
+ *
+ * @author Dan Keenan
+ * @date 10/17/26
+ * @copyright GPL-3.0-or-later
+ * Copyright (C) 2024-2026 Dan Keenan
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "sacnloggerlib/UringQueue.h"
+
+#ifdef PLATFORM_LINUX
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+namespace sacnlogger
+{
+#ifdef PLATFORM_LINUX
+    namespace
+    {
+        template <typename T>
+        T* at(void* ring, unsigned int offset)
+        {
+            return reinterpret_cast<T*>(static_cast<char*>(ring) + offset);
+        }
+    } // namespace
+
+    std::unique_ptr<UringQueue> UringQueue::create(unsigned int depth)
+    {
+        io_uring_params params{};
+        const auto fd = static_cast<int>(::syscall(__NR_io_uring_setup, depth, &params));
+        if (fd < 0)
+        {
+            return nullptr;
+        }
+        std::unique_ptr<UringQueue> queue(new UringQueue());
+        queue->depth_ = depth;
+        queue->ringFd_ = fd;
+        queue->sqRingSize_ = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+        queue->cqRingSize_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        const bool singleMmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (singleMmap)
+        {
+            queue->sqRingSize_ = queue->cqRingSize_ = std::max(queue->sqRingSize_, queue->cqRingSize_);
+        }
+        queue->sqRing_ = ::mmap(nullptr, queue->sqRingSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                                IORING_OFF_SQ_RING);
+        if (queue->sqRing_ == MAP_FAILED)
+        {
+            queue->sqRing_ = nullptr;
+            return nullptr;
+        }
+        if (singleMmap)
+        {
+            queue->cqRing_ = queue->sqRing_;
+        }
+        else
+        {
+            queue->cqRing_ = ::mmap(nullptr, queue->cqRingSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                    fd, IORING_OFF_CQ_RING);
+            if (queue->cqRing_ == MAP_FAILED)
+            {
+                queue->cqRing_ = nullptr;
+                return nullptr;
+            }
+        }
+        queue->sqesSize_ = params.sq_entries * sizeof(io_uring_sqe);
+        auto* sqes = ::mmap(nullptr, queue->sqesSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                            IORING_OFF_SQES);
+        if (sqes == MAP_FAILED)
+        {
+            return nullptr;
+        }
+        queue->sqes_ = static_cast<io_uring_sqe*>(sqes);
+
+        queue->sqHead_ = at<unsigned int>(queue->sqRing_, params.sq_off.head);
+        queue->sqTail_ = at<unsigned int>(queue->sqRing_, params.sq_off.tail);
+        queue->sqMask_ = *at<unsigned int>(queue->sqRing_, params.sq_off.ring_mask);
+        queue->sqEntries_ = params.sq_entries;
+        queue->sqArray_ = at<unsigned int>(queue->sqRing_, params.sq_off.array);
+        queue->cqHead_ = at<unsigned int>(queue->cqRing_, params.cq_off.head);
+        queue->cqTail_ = at<unsigned int>(queue->cqRing_, params.cq_off.tail);
+        queue->cqMask_ = *at<unsigned int>(queue->cqRing_, params.cq_off.ring_mask);
+        queue->cqes_ = at<io_uring_cqe>(queue->cqRing_, params.cq_off.cqes);
+        return queue;
+    }
+
+    UringQueue::~UringQueue()
+    {
+        if (sqes_ != nullptr)
+        {
+            ::munmap(sqes_, sqesSize_);
+        }
+        if (cqRing_ != nullptr && cqRing_ != sqRing_)
+        {
+            ::munmap(cqRing_, cqRingSize_);
+        }
+        if (sqRing_ != nullptr)
+        {
+            ::munmap(sqRing_, sqRingSize_);
+        }
+        if (ringFd_ >= 0)
+        {
+            ::close(ringFd_);
+        }
+    }
+
+    bool UringQueue::registerBuffer(void* data, std::size_t size)
+    {
+        iovec iov{.iov_base = data, .iov_len = size};
+        if (::syscall(__NR_io_uring_register, ringFd_, IORING_REGISTER_BUFFERS, &iov, 1) != 0)
+        {
+            return false;
+        }
+        buffer_ = static_cast<const char*>(data);
+        bufferSize_ = size;
+        return true;
+    }
+
+    io_uring_sqe* UringQueue::nextSqe()
+    {
+        // Only this thread moves the tail, while the kernel moves the head as it takes entries.
+        const auto tail = *sqTail_;
+        if (tail - std::atomic_ref(*sqHead_).load(std::memory_order_acquire) >= sqEntries_)
+        {
+            enter(0);
+        }
+        const auto index = tail & sqMask_;
+        auto* sqe = &sqes_[index];
+        std::memset(sqe, 0, sizeof(*sqe));
+        sqArray_[index] = index;
+        return sqe;
+    }
+
+    void UringQueue::write(int fd, const void* data, std::size_t size, uint64_t offset, uint64_t tag, bool sync)
+    {
+        auto* sqe = nextSqe();
+        const auto* bytes = static_cast<const char*>(data);
+        if (bytes >= buffer_ && bytes + size <= buffer_ + bufferSize_)
+        {
+            sqe->opcode = IORING_OP_WRITE_FIXED;
+            sqe->buf_index = 0;
+        }
+        else
+        {
+            sqe->opcode = IORING_OP_WRITE;
+        }
+        sqe->fd = fd;
+        sqe->addr = reinterpret_cast<uintptr_t>(data);
+        sqe->len = static_cast<uint32_t>(size);
+        sqe->off = offset;
+        sqe->user_data = tag;
+        if (sync)
+        {
+            sqe->flags = IOSQE_IO_LINK;
+        }
+        std::atomic_ref(*sqTail_).store(*sqTail_ + 1, std::memory_order_release);
+        ++toSubmit_;
+        ++inFlight_;
+
+        if (sync)
+        {
+            sqe = nextSqe();
+            sqe->opcode = IORING_OP_FSYNC;
+            sqe->fd = fd;
+            sqe->fsync_flags = IORING_FSYNC_DATASYNC;
+            sqe->user_data = tag;
+            std::atomic_ref(*sqTail_).store(*sqTail_ + 1, std::memory_order_release);
+            ++toSubmit_;
+            ++inFlight_;
+        }
+    }
+
+    UringQueue::Completion UringQueue::wait()
+    {
+        while (true)
+        {
+            const auto head = *cqHead_;
+            if (head != std::atomic_ref(*cqTail_).load(std::memory_order_acquire))
+            {
+                const auto& cqe = cqes_[head & cqMask_];
+                const Completion completion{.tag = cqe.user_data, .result = cqe.res};
+                std::atomic_ref(*cqHead_).store(head + 1, std::memory_order_release);
+                --inFlight_;
+                return completion;
+            }
+            enter(1);
+        }
+    }
+
+    void UringQueue::enter(unsigned int minComplete)
+    {
+        const auto submitted = ::syscall(__NR_io_uring_enter, ringFd_, toSubmit_, minComplete,
+                                         minComplete > 0 ? IORING_ENTER_GETEVENTS : 0, nullptr, 0);
+        if (submitted > 0)
+        {
+            toSubmit_ -= std::min<unsigned int>(toSubmit_, submitted);
+        }
+    }
+#else
+    std::unique_ptr<UringQueue> UringQueue::create(unsigned int) { return nullptr; }
+
+    UringQueue::~UringQueue() = default;
+
+    bool UringQueue::registerBuffer(void*, std::size_t) { return false; }
+
+    void UringQueue::write(int, const void*, std::size_t, uint64_t, uint64_t, bool) {}
+
+    UringQueue::Completion UringQueue::wait() { return {}; }
+
+    void UringQueue::enter(unsigned int) {}
+#endif
+} // namespace sacnlogger
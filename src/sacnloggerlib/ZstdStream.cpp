@@ -0,0 +1,177 @@
+/**
+ * @file ZstdStream.cpp
+ *
+ * @author Dan Keenan
+ * @date 10/17/26
+ * @copyright GPL-3.0-or-later
+ * Copyright (C) 2024-2026 Dan Keenan
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "sacnloggerlib/ZstdStream.h"
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <new>
+#include <zstd.h>
+
+namespace sacnlogger
+{
+    ZstdCompressor::ZstdCompressor(int level) : cctx_(ZSTD_createCCtx(), &ZSTD_freeCCtx)
+    {
+        if (!cctx_)
+        {
+            throw std::bad_alloc();
+        }
+        ZSTD_CCtx_setParameter(cctx_.get(), ZSTD_c_compressionLevel,
+                               std::clamp(level, ZSTD_minCLevel(), ZSTD_maxCLevel()));
+        ZSTD_CCtx_setParameter(cctx_.get(), ZSTD_c_checksumFlag, 1);
+    }
+
+    ZstdCompressor::~ZstdCompressor() = default;
+
+    void ZstdCompressor::compress(std::string_view data, std::vector<char>& out)
+    {
+        while (!data.empty())
+        {
+            const auto count = std::min(data.size(), kMaxFrameInput - frameInput_);
+            frameInput_ += count;
+            if (frameInput_ >= kMaxFrameInput)
+            {
+                run(data.substr(0, count), out, ZSTD_e_end);
+                frameInput_ = 0;
+            }
+            else
+            {
+                run(data.substr(0, count), out, ZSTD_e_flush);
+            }
+            data.remove_prefix(count);
+        }
+    }
+
+    void ZstdCompressor::endFrame(std::vector<char>& out)
+    {
+        if (frameInput_ == 0)
+        {
+            return;
+        }
+        run({}, out, ZSTD_e_end);
+        frameInput_ = 0;
+    }
+
+    void ZstdCompressor::reset()
+    {
+        ZSTD_CCtx_reset(cctx_.get(), ZSTD_reset_session_only);
+        frameInput_ = 0;
+    }
+
+    void ZstdCompressor::run(std::string_view data, std::vector<char>& out, int directive)
+    {
+        ZSTD_inBuffer input{data.data(), data.size(), 0};
+        while (true)
+        {
+            const auto start = out.size();
+            out.resize(start + ZSTD_CStreamOutSize());
+            ZSTD_outBuffer output{out.data() + start, out.size() - start, 0};
+            const auto remaining =
+                ZSTD_compressStream2(cctx_.get(), &output, &input, static_cast<ZSTD_EndDirective>(directive));
+            out.resize(start + output.pos);
+            // Only fails for bad parameters or running out of memory.
+            if (ZSTD_isError(remaining) || (remaining == 0 && input.pos == input.size))
+            {
+                return;
+            }
+        }
+    }
+
+    ZstdDecompressor::ZstdDecompressor() : dctx_(ZSTD_createDCtx(), &ZSTD_freeDCtx)
+    {
+        if (!dctx_)
+        {
+            throw std::bad_alloc();
+        }
+    }
+
+    ZstdDecompressor::~ZstdDecompressor() = default;
+
+    bool ZstdDecompressor::decompress(std::string_view data, std::vector<char>& out)
+    {
+        ZSTD_inBuffer input{data.data(), data.size(), 0};
+        bool outputFull = false;
+        while (input.pos < input.size || outputFull)
+        {
+            const auto start = out.size();
+            out.resize(start + ZSTD_DStreamOutSize());
+            ZSTD_outBuffer output{out.data() + start, out.size() - start, 0};
+            const auto result = ZSTD_decompressStream(dctx_.get(), &output, &input);
+            out.resize(start + output.pos);
+            if (ZSTD_isError(result))
+            {
+                return false;
+            }
+            outputFull = output.pos == output.size;
+            frameComplete_ = result == 0;
+        }
+        return true;
+    }
+
+    std::vector<char> decompressFile(const std::filesystem::path& path, std::uintmax_t offset)
+    {
+        // Frame magic number, little-endian.
+        static constexpr std::string_view kMagic("\x28\xB5\x2F\xFD", 4);
+
+        std::string compressed;
+        {
+            std::ifstream file(path, std::ios::binary);
+            file.seekg(static_cast<std::streamoff>(offset));
+            compressed.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        }
+
+        std::vector<char> r;
+        const std::unique_ptr<ZSTD_DCtx, std::size_t (*)(ZSTD_DCtx*)> dctx(ZSTD_createDCtx(), &ZSTD_freeDCtx);
+        if (!dctx)
+        {
+            throw std::bad_alloc();
+        }
+        ZSTD_inBuffer input{compressed.data(), compressed.size(), 0};
+        std::size_t frameStart = 0;
+        // A full output buffer may mean there is more to come even when all the input has been used.
+        bool outputFull = false;
+        while (input.pos < input.size || outputFull)
+        {
+            const auto start = r.size();
+            r.resize(start + ZSTD_DStreamOutSize());
+            ZSTD_outBuffer output{r.data() + start, r.size() - start, 0};
+            const auto result = ZSTD_decompressStream(dctx.get(), &output, &input);
+            r.resize(start + output.pos);
+            outputFull = output.pos == output.size;
+            if (ZSTD_isError(result))
+            {
+                // Skip to the next frame.
+                frameStart = compressed.find(kMagic, frameStart + 1);
+                if (frameStart == std::string::npos)
+                {
+                    break;
+                }
+                ZSTD_DCtx_reset(dctx.get(), ZSTD_reset_session_only);
+                input.pos = frameStart;
+            }
+            else if (result == 0)
+            {
+                frameStart = input.pos;
+            }
+        }
+        return r;
+    }
+} // namespace sacnlogger
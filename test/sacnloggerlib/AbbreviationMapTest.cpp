@@ -76,4 +76,31 @@ TEST_CASE("Abbreviation Map")
         CHECK(abbreviationMap.abbreviationForUuid(uuid1) == kExpectedAbbreviations.at(1));
         CHECK(abbreviationMap.abbreviationForUuid(uuid0) == kExpectedAbbreviations.at(0));
     }
+
+    SECTION("Stable across growth")
+    {
+        const auto first = abbreviationMap.abbreviationForUuid(etcpal::Uuid::V5(nsUuid, "first"));
+        for (unsigned int i = 0; i < 1000; ++i)
+        {
+            abbreviationMap.abbreviationForUuid(etcpal::Uuid::V5(nsUuid, fmt::format("source {}", i)));
+        }
+        CHECK(abbreviationMap.size() == 1001);
+        CHECK(first == "A");
+        CHECK(abbreviationMap.abbreviationForUuid(etcpal::Uuid::V5(nsUuid, "first")).data() == first.data());
+        CHECK(abbreviationMap.abbreviationForUuid(etcpal::Uuid::V5(nsUuid, "source 999")) == "ALM");
+    }
+}
+
+TEST_CASE("Abbreviation For Index")
+{
+    const auto abbreviation = [](std::size_t index)
+    {
+        const auto r = sacnlogger::AbbreviationMap::abbreviationForIndex(index);
+        return std::string(r.data(), r.back());
+    };
+    CHECK(abbreviation(0) == "A");
+    CHECK(abbreviation(25) == "Z");
+    CHECK(abbreviation(26) == "AA");
+    CHECK(abbreviation(701) == "ZZ");
+    CHECK(abbreviation(702) == "AAA");
 }
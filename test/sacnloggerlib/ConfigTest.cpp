@@ -34,6 +34,52 @@ static const std::map<std::string, sacnlogger::Config> expectedConfigs{
     {"one_univ.json", {.universes = {1}, .usePap = false}},
     {"five_univ.json", {.universes = {1, 2, 3, 4, 5}, .usePap = false}},
     {"use_pap.json", {.universes = {1}, .usePap = true}},
+    {"delta_rows.json",
+     {.universes = {1},
+      .usePap = false,
+      .logConfig = {.deltaRows = true, .checkpointInterval = 50, .checkpointSeconds = 5, .selfContained = true}}},
+    {"overflow_policy.json",
+     {.universes = {1, 2},
+      .usePap = false,
+      .logConfig = {
+          .queue = {.overflowPolicy = sacnlogger::OverflowPolicy::DropOldest},
+          .universeQueues = {{2, {.queueSize = 256, .overflowPolicy = sacnlogger::OverflowPolicy::Degrade}}},
+      }}},
+    {"universe_queue_partial.json",
+     {.universes = {1, 2},
+      .usePap = false,
+      .logConfig = {
+          .queue = {.overflowPolicy = sacnlogger::OverflowPolicy::DropOldest},
+          // The policy comes from the log's, not the schema's default.
+          .universeQueues = {{2, {.queueSize = 256, .overflowPolicy = sacnlogger::OverflowPolicy::DropOldest}}},
+      }}},
+    {"sacnlog.json", {.universes = {1}, .usePap = false, .logConfig = {.dataFormat = sacnlogger::DataFormat::SacnLog}}},
+    {"compression.json",
+     {.universes = {1},
+      .usePap = false,
+      .logConfig = {.compression = sacnlogger::Compression::Zstd, .compressionLevel = 9}}},
+    {"compress_rotated.json",
+     {.universes = {1}, .usePap = false, .logConfig = {.compressRotated = true, .compressRotatedRate = 1024}}},
+    {"group_commit.json",
+     {.universes = {1}, .usePap = false, .logConfig = {.commitInterval = 500, .commitSize = 256}}},
+    {"io_uring.json", {.universes = {1}, .usePap = false, .logConfig = {.ioUring = true}}},
+    {"retention.json", {.universes = {1}, .usePap = false, .logConfig = {.retentionBudget = 4096}}},
+    {"staging.json", {.universes = {1}, .usePap = false, .logConfig = {.stagingSize = 32, .stagingAge = 2000}}},
+    {"flight_recorder.json",
+     {.universes = {1},
+      .usePap = false,
+      .logConfig = {.flightRecorder = {.size = 16,
+                                       .window = 300,
+                                       .triggers = {{.event = sacnlogger::TriggerEvent::Level,
+                                                     .universe = 1,
+                                                     .address = 101,
+                                                     .level = 0,
+                                                     .pre = 30,
+                                                     .post = 5},
+                                                    {.event = sacnlogger::TriggerEvent::OwnerChange},
+                                                    {.event = sacnlogger::TriggerEvent::SourceLost,
+                                                     .universe = 2,
+                                                     .pre = 120}}}}}},
 };
 
 namespace Catch
@@ -52,7 +98,35 @@ namespace Catch
 #else
             const auto systemConfig = "";
 #endif
-            return fmt::format("<Config: Univs {}, PAP {}{}>", config.universes, config.usePap, systemConfig);
+            std::string queues = fmt::format("{}/{}", config.logConfig.queue.queueSize,
+                                             static_cast<int>(config.logConfig.queue.overflowPolicy));
+            for (const auto& [universe, queueConfig] : config.logConfig.universeQueues)
+            {
+                queues += fmt::format(", U{} {}/{}", universe, queueConfig.queueSize,
+                                      static_cast<int>(queueConfig.overflowPolicy));
+            }
+            std::string triggers;
+            for (const auto& trigger : config.logConfig.flightRecorder.triggers)
+            {
+                triggers += fmt::format(", {} U{}/{}@{} -{}s+{}s", static_cast<int>(trigger.event), trigger.universe,
+                                        trigger.address, trigger.level, trigger.pre, trigger.post);
+            }
+            return fmt::format("<Config: Univs {}, PAP {}{}, Format {}, Compression {}/{}, "
+                               "compress rotated {}/{}, Delta rows {}, checkpoint {}/{}s, self-contained {}, commit {}ms/{}KiB, "
+                               "io_uring {}, retention {}MiB, staging {}MiB/{}ms, flight recorder {}MiB/{}s{}, "
+                               "queues {}>",
+                               config.universes, config.usePap, systemConfig,
+                               static_cast<int>(config.logConfig.dataFormat),
+                               static_cast<int>(config.logConfig.compression), config.logConfig.compressionLevel,
+                               config.logConfig.compressRotated, config.logConfig.compressRotatedRate,
+                               config.logConfig.deltaRows,
+                               config.logConfig.checkpointInterval, config.logConfig.checkpointSeconds,
+                               config.logConfig.selfContained,
+                               config.logConfig.commitInterval, config.logConfig.commitSize,
+                               config.logConfig.ioUring, config.logConfig.retentionBudget,
+                               config.logConfig.stagingSize, config.logConfig.stagingAge,
+                               config.logConfig.flightRecorder.size, config.logConfig.flightRecorder.window,
+                               triggers, queues);
         }
     };
 } // namespace Catch
@@ -125,6 +199,28 @@ TEST_CASE("Config Load")
             sacnlogger::Config actual;
             REQUIRE_THROWS_AS(sacnlogger::Config::loadFromFile(filePath), sacnlogger::ConfigException);
         }
+        SECTION("bad_trigger.json")
+        {
+            const auto filePath = fmt::format("{}/ConfigTest/{}", RESOURCES_PATH, "bad_trigger.json");
+            sacnlogger::Config actual;
+            REQUIRE_THROWS_AS(sacnlogger::Config::loadFromFile(filePath), sacnlogger::ConfigException);
+        }
+        SECTION("bad_universe_queue.json")
+        {
+            const auto filePath = fmt::format("{}/ConfigTest/{}", RESOURCES_PATH, "bad_universe_queue.json");
+            sacnlogger::Config actual;
+            REQUIRE_THROWS_AS(sacnlogger::Config::loadFromFile(filePath), sacnlogger::ConfigException);
+        }
+        SECTION("Unvalidated universe queues")
+        {
+            // Without the schema, bad universe numbers still don't wrap around or escape as other errors.
+            for (const auto* universe : {"0", "70000", "99999999999999999999", "1a", ""})
+            {
+                INFO(universe);
+                const nlohmann::json json = {{"universes", {{universe, nlohmann::json::object()}}}};
+                REQUIRE_THROWS_AS(json.get<sacnlogger::LogConfig>(), sacnlogger::ConfigException);
+            }
+        }
     }
 }
 
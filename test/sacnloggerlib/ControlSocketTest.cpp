@@ -0,0 +1,84 @@
+/**
+ * @file ControlSocketTest.cpp
+ *
+ * @author Dan Keenan
+ * @date 10/17/26
+ * @copyright GPL-3.0-or-later
+ * Copyright (C) 2024-2026 Dan Keenan
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <vector>
+#include "TempDir.h"
+#include "sacnloggerlib/ControlSocket.h"
+
+using namespace std::chrono_literals;
+
+TEST_CASE("Control Socket")
+{
+    const TempDir tempDir;
+    const auto path = tempDir.path / "run" / "control";
+    std::mutex mutex;
+    std::condition_variable dumped;
+    std::vector<std::optional<uint16_t>> dumps;
+
+    {
+        sacnlogger::ControlSocket controlSocket(path);
+        REQUIRE(controlSocket.listening());
+        CHECK(std::filesystem::exists(path));
+        controlSocket.sigDump.connect(
+            [&](std::optional<uint16_t> universe)
+            {
+                const std::scoped_lock lock(mutex);
+                dumps.push_back(universe);
+                dumped.notify_all();
+            });
+
+        SECTION("Commands")
+        {
+            controlSocket.handle("dump");
+            controlSocket.handle("  dump 3\n");
+            controlSocket.handle("dump three");
+            controlSocket.handle("dump 70000");
+            controlSocket.handle("restart");
+            controlSocket.handle("");
+            CHECK(dumps == std::vector<std::optional<uint16_t>>{std::nullopt, 3});
+        }
+
+        SECTION("Socket")
+        {
+            const int fd = ::socket(AF_UNIX, SOCK_DGRAM, 0);
+            REQUIRE(fd >= 0);
+            sockaddr_un addr{};
+            addr.sun_family = AF_UNIX;
+            std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+            constexpr std::string_view kCommand = "dump 5\n";
+            CHECK(::sendto(fd, kCommand.data(), kCommand.size(), 0, reinterpret_cast<const sockaddr*>(&addr),
+                           sizeof(addr)) == kCommand.size());
+            ::close(fd);
+            std::unique_lock lock(mutex);
+            CHECK(dumped.wait_for(lock, 5s, [&dumps]() { return !dumps.empty(); }));
+            CHECK(dumps == std::vector<std::optional<uint16_t>>{5});
+        }
+    }
+    // Stopping removes the socket.
+    CHECK_FALSE(std::filesystem::exists(path));
+}
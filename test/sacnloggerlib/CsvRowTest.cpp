@@ -20,6 +20,7 @@
  */
 
 #include <catch2/catch_test_macros.hpp>
+#include <fmt/format.h>
 #include <sacnloggerlib/CsvRow.h>
 
 TEST_CASE("CSV Row")
@@ -57,4 +58,32 @@ TEST_CASE("CSV Row")
         sacnlogger::CsvRow row;
         REQUIRE(row.string() == "");
     }
+
+    SECTION("Byte values")
+    {
+        for (unsigned int val = 0; val <= 255; ++val)
+        {
+            sacnlogger::CsvRow row;
+            row << static_cast<uint8_t>(val) << val;
+            CHECK(row.string() == fmt::format("{},{}", val, val));
+        }
+    }
+
+    SECTION("Quotes at edges")
+    {
+        sacnlogger::CsvRow row;
+        row << "\"" << "\"\"start" << "end\"";
+        REQUIRE(row.string() == "\"\"\"\",\"\"\"\"\"start\",\"end\"\"\"");
+    }
+
+    SECTION("Reuse")
+    {
+        sacnlogger::CsvRow row(64);
+        row << 1 << "one";
+        REQUIRE(row.view() == "1,\"one\"");
+        row.clear();
+        REQUIRE(row.view().empty());
+        row << -2 << "two";
+        REQUIRE(row.view() == "-2,\"two\"");
+    }
 }
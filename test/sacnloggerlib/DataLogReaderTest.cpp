@@ -0,0 +1,128 @@
+/**
+ * @file DataLogReaderTest.cpp
+ *
+ * @author Dan Keenan
+ * @date 10/17/26
+ * @copyright GPL-3.0-or-later
+ * Copyright (C) 2024-2026 Dan Keenan
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <spdlog/pattern_formatter.h>
+#include "TempDir.h"
+#include "sacnloggerlib/DataLogReader.h"
+#include "sacnloggerlib/LogWriter.h"
+#include "sacnloggerlib/SegmentManifest.h"
+#include "sacnloggerlib/TimestampFormatter.h"
+
+TEST_CASE("Timestamp Parse")
+{
+    // Timestamps only have millisecond precision.
+    const auto time = std::chrono::floor<std::chrono::milliseconds>(spdlog::log_clock::now());
+    sacnlogger::TimestampFormatter formatter;
+    CHECK(sacnlogger::TimestampFormatter::parse(formatter.format(time)) == time);
+    CHECK(sacnlogger::TimestampFormatter::parse("2024-01-02 03:04:05.006+01:00") ==
+          spdlog::log_clock::time_point(std::chrono::sys_days(std::chrono::year(2024) / 1 / 2) +
+                                        std::chrono::hours(2) + std::chrono::minutes(4) + std::chrono::seconds(5) +
+                                        std::chrono::milliseconds(6)));
+    CHECK_FALSE(sacnlogger::TimestampFormatter::parse("\"001 Lvl\""));
+    CHECK_FALSE(sacnlogger::TimestampFormatter::parse("2024-13-02 03:04:05.006+01:00"));
+    // Written before the zone had a colon.
+    CHECK_FALSE(sacnlogger::TimestampFormatter::parse("2024-01-02 03:04:05.006+0100"));
+}
+
+TEST_CASE("Timestamp Format")
+{
+    // Must match what the loggers wrote before the formatter existed.
+    spdlog::pattern_formatter patternFormatter("%Y-%m-%d %H:%M:%S.%e%z");
+    sacnlogger::TimestampFormatter formatter;
+    const auto now = spdlog::log_clock::now();
+    for (const auto time : {now, now + std::chrono::milliseconds(1), now + std::chrono::hours(24 * 183)})
+    {
+        spdlog::details::log_msg msg(spdlog::source_loc{}, "", spdlog::level::info, "");
+        msg.time = time;
+        spdlog::memory_buf_t expected;
+        patternFormatter.format(msg, expected);
+        // Without the end of line.
+        CHECK(formatter.format(time) == std::string_view(expected.data(), expected.size() - 1));
+    }
+}
+
+TEST_CASE("Data Log State")
+{
+    const TempDir tempDir;
+    const auto time = std::chrono::floor<std::chrono::seconds>(spdlog::log_clock::now());
+    const auto at = [&time](int seconds) { return time + std::chrono::seconds(seconds); };
+    int compressionLevel = 0;
+    const auto logPath = tempDir.path / "U00001_data.csv";
+    auto path = sacnlogger::segmentPath(logPath, 1);
+    SECTION("Uncompressed") {}
+    SECTION("Compressed")
+    {
+        compressionLevel = 3;
+    }
+
+    {
+        sacnlogger::LogWriter writer;
+        auto stream =
+            writer.openStream(logPath, 1024 * 1024, 2, sacnlogger::OverflowPolicy::Block, false, compressionLevel);
+        stream->write(at(0), "\"001 Lvl\",\"001 Pri\",\"001 Src\",\"002 Lvl\",\"002 Pri\",\"002 Src\"");
+        stream->markKeyframe(at(0));
+        stream->write(at(0), "\"Source\",\"A\",\"cid-a\",\"192.0.2.1\",\"Console\"");
+        stream->write(at(0), "0,100,\"A\",0,100,\"A\"");
+        stream->write(at(1), "\"1:255:100:A\"");
+        stream->write(at(2), "\"Source\",\"B\",\"cid-b\",\"192.0.2.2\",\"Backup\"");
+        stream->write(at(2), "\"2:50:120:B\"");
+        stream->markKeyframe(at(10));
+        stream->write(at(10), "\"Source\",\"A\",\"cid-a\",\"192.0.2.1\",\"Console\"");
+        stream->write(at(10), "\"Source\",\"C\",\"cid-c\",\"192.0.2.3\",\"Remote\"");
+        stream->write(at(10), "10,100,\"A\",20,100,\"-\"");
+        stream->write(at(11), "\"3:1:100:C\"");
+    }
+    if (compressionLevel != 0)
+    {
+        path += ".zst";
+    }
+
+    CHECK_FALSE(sacnlogger::readDataLogState(path, at(-1)));
+    CHECK_FALSE(sacnlogger::readDataLogState(tempDir.path / "missing.csv", at(0)));
+
+    auto state = sacnlogger::readDataLogState(path, at(0));
+    REQUIRE(state);
+    CHECK(state->time == at(0));
+    CHECK(state->levels == std::vector<uint8_t>{0, 0});
+    CHECK(state->sourceNames == std::map<std::string, std::string>{{"A", "Console"}});
+
+    state = sacnlogger::readDataLogState(path, at(5));
+    REQUIRE(state);
+    CHECK(state->time == at(2));
+    CHECK(state->levels == std::vector<uint8_t>{255, 50});
+    CHECK(state->priorities == std::vector<uint8_t>{100, 120});
+    CHECK(state->owners == std::vector<std::string>{"A", "B"});
+    CHECK(state->sourceNames == std::map<std::string, std::string>{{"A", "Console"}, {"B", "Backup"}});
+
+    state = sacnlogger::readDataLogState(path, at(20));
+    REQUIRE(state);
+    CHECK(state->time == at(11));
+    CHECK(state->levels == std::vector<uint8_t>{10, 20, 1});
+    CHECK(state->owners == std::vector<std::string>{"A", "-", "C"});
+    CHECK(state->sourceNames == std::map<std::string, std::string>{{"A", "Console"}, {"C", "Remote"}});
+
+    // Without the index.
+    std::filesystem::remove(path.string() + ".idx");
+    state = sacnlogger::readDataLogState(path, at(5));
+    REQUIRE(state);
+    CHECK(state->levels == std::vector<uint8_t>{255, 50});
+}
@@ -0,0 +1,142 @@
+/**
+ * @file DataRowFormatterTest.cpp
+ *
+ * @author Dan Keenan
+ * @date 10/17/26
+ * @copyright GPL-3.0-or-later
+ * Copyright (C) 2024-2026 Dan Keenan
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <fmt/format.h>
+#include <sacn/cpp/common.h>
+#include "sacnloggerlib/DataRowFormatter.h"
+
+namespace
+{
+    sacnlogger::ComparableData makeData()
+    {
+        sacnlogger::ComparableData data;
+        data.owners_.fill(sacn::kInvalidRemoteSourceHandle);
+        return data;
+    }
+
+    std::string fullRow(const sacnlogger::ComparableData& data, const sacnlogger::OwnerTable& names,
+                        std::size_t slotCount = SACN_MERGE_RECEIVER_MAX_SLOTS)
+    {
+        std::string r;
+        for (std::size_t slot = 0; slot < slotCount; ++slot)
+        {
+            r += fmt::format("{},{},\"{}\",", data.levels_[slot], data.priorities_[slot], names[data.owners_[slot]]);
+        }
+        r.pop_back();
+        return r;
+    }
+} // namespace
+
+TEST_CASE("Data Row Formatter")
+{
+    sacnlogger::OwnerTable names;
+    names.set(7, "A");
+    names.set(9, "B");
+    auto data = makeData();
+    data.levels_[0] = 255;
+    data.priorities_[0] = 100;
+    data.owners_[0] = 7;
+    sacnlogger::SlotMask changed;
+    changed.set(0);
+
+    SECTION("Header")
+    {
+        const auto header = sacnlogger::DataRowFormatter::header(SACN_MERGE_RECEIVER_MAX_SLOTS);
+        CHECK(header.starts_with("\"001 Lvl\",\"001 Pri\",\"001 Src\",\"002 Lvl\""));
+        CHECK(header.ends_with("\"512 Src\""));
+        CHECK(sacnlogger::DataRowFormatter::header(2) ==
+              "\"001 Lvl\",\"001 Pri\",\"001 Src\",\"002 Lvl\",\"002 Pri\",\"002 Src\"");
+    }
+
+    SECTION("Source rows")
+    {
+        CHECK(sacnlogger::DataRowFormatter::sourceRow("A", "cid", "192.0.2.1", "Console \"Main\"") ==
+              "\"Source\",\"A\",\"cid\",\"192.0.2.1\",\"Console \"\"Main\"\"\"");
+    }
+
+    SECTION("Full rows")
+    {
+        sacnlogger::DataRowFormatter formatter;
+        formatter.widen(SACN_MERGE_RECEIVER_MAX_SLOTS);
+        CHECK(formatter.format(data, changed, names) == fullRow(data, names));
+        CHECK(formatter.format(data, changed, names) == fullRow(data, names));
+    }
+
+    SECTION("Owners")
+    {
+        CHECK(names[7] == "A");
+        CHECK(names[sacn::kInvalidRemoteSourceHandle] == "-");
+        CHECK(names[8] == "?");
+        CHECK(names[1000] == "?");
+    }
+
+    SECTION("Delta rows")
+    {
+        sacnlogger::DataRowFormatter formatter({.deltaRows = true, .checkpointInterval = 2});
+        formatter.widen(SACN_MERGE_RECEIVER_MAX_SLOTS);
+        // First row is always full.
+        CHECK(formatter.format(data, changed, names) == fullRow(data, names));
+
+        data.levels_[9] = 50;
+        data.priorities_[9] = 100;
+        data.owners_[9] = 9;
+        data.levels_[0] = 0;
+        changed.reset();
+        changed.set(0);
+        changed.set(9);
+        CHECK(formatter.format(data, changed, names) == "\"1:0:100:A\",\"10:50:100:B\"");
+
+        data.owners_[9] = sacn::kInvalidRemoteSourceHandle;
+        changed.reset();
+        changed.set(9);
+        CHECK(formatter.format(data, changed, names) == "\"10:50:100:-\"");
+
+        // Checkpoint.
+        CHECK(formatter.format(data, changed, names) == fullRow(data, names));
+        CHECK(formatter.format(data, changed, names) == "\"10:50:100:-\"");
+
+        formatter.requestFullRow();
+        CHECK(formatter.format(data, changed, names) == fullRow(data, names));
+    }
+
+    SECTION("Partial universes")
+    {
+        sacnlogger::DataRowFormatter formatter({.deltaRows = true});
+        CHECK(formatter.slotCount() == 0);
+        CHECK(formatter.widen(24));
+        CHECK(formatter.header() == sacnlogger::DataRowFormatter::header(24));
+        CHECK(formatter.format(data, changed, names) == fullRow(data, names, 24));
+        CHECK(formatter.format(data, changed, names) == "\"1:255:100:A\"");
+
+        // Narrower ranges don't change anything.
+        CHECK_FALSE(formatter.widen(12));
+        CHECK(formatter.slotCount() == 24);
+        CHECK(formatter.format(data, changed, names) == "\"1:255:100:A\"");
+
+        // Growing needs a full row for the new header.
+        CHECK(formatter.widen(96));
+        CHECK(formatter.format(data, changed, names) == fullRow(data, names, 96));
+
+        CHECK(formatter.widen(1000));
+        CHECK(formatter.slotCount() == SACN_MERGE_RECEIVER_MAX_SLOTS);
+    }
+}
@@ -0,0 +1,155 @@
+/**
+ * @file DiskSpaceMonitorTest.cpp
+ *
+ * @author Dan Keenan
+ * @date 10/17/26
+ * @copyright GPL-3.0-or-later
+ * Copyright (C) 2024-2026 Dan Keenan
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <condition_variable>
+#include <future>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include "TempDir.h"
+#include "sacnloggerlib/DiskSpaceMonitor.h"
+
+using namespace std::chrono_literals;
+
+TEST_CASE("Disk Space Monitor")
+{
+    const TempDir tempDir;
+    const auto timeout = 5s;
+
+    SECTION("Forecast")
+    {
+        const auto forecast = sacnlogger::DiskSpaceForecast::make(1000, 10);
+        CHECK(forecast.available == 1000);
+        CHECK(forecast.timeToFull == 100s);
+        // Not filling.
+        CHECK_FALSE(sacnlogger::DiskSpaceForecast::make(1000, 0).timeToFull);
+        CHECK_FALSE(sacnlogger::DiskSpaceForecast::make(1000, -10).timeToFull);
+    }
+
+    SECTION("Low Time")
+    {
+        std::promise<sacnlogger::DiskSpaceForecast> signalled;
+        sacnlogger::DiskSpaceMonitor monitor;
+        monitor.setLowSpaceThreshold(0);
+        monitor.setCriticalSpaceThreshold(0);
+        // However fast the drive, writing this much this quickly won't last a million hours.
+        monitor.setLowTimeThreshold(std::chrono::hours(1000000));
+        monitor.setCriticalTimeThreshold(0min);
+        monitor.setPollPeriod(10ms);
+        monitor.sigLowSpace.connect([&signalled](const sacnlogger::DiskSpaceForecast& forecast)
+                                    { signalled.set_value(forecast); });
+        monitor.addWritten(1024 * 1024 * 1024);
+        monitor.setPath(tempDir.path);
+        auto future = signalled.get_future();
+        REQUIRE(future.wait_for(timeout) == std::future_status::ready);
+        const auto forecast = future.get();
+        CHECK(forecast.writeRate > 0);
+        CHECK(forecast.timeToFull);
+        CHECK(monitor.writtenBytes() == 1024 * 1024 * 1024);
+    }
+
+    SECTION("Critical Space")
+    {
+        std::promise<sacnlogger::DiskSpaceForecast> signalled;
+        sacnlogger::DiskSpaceMonitor monitor;
+        // Whatever the rate.
+        monitor.setCriticalSpaceThreshold(std::numeric_limits<std::uintmax_t>::max());
+        monitor.sigCriticalSpace.connect([&signalled](const sacnlogger::DiskSpaceForecast& forecast)
+                                         { signalled.set_value(forecast); });
+        monitor.setPath(tempDir.path);
+        auto future = signalled.get_future();
+        REQUIRE(future.wait_for(timeout) == std::future_status::ready);
+        CHECK_FALSE(future.get().timeToFull);
+    }
+
+    SECTION("Critical Again")
+    {
+        std::mutex mutex;
+        std::condition_variable changed;
+        unsigned int criticalCount = 0;
+        unsigned int lowCount = 0;
+        sacnlogger::DiskSpaceMonitor monitor;
+        monitor.setPollPeriod(10ms);
+        monitor.setCriticalSpaceThreshold(std::numeric_limits<std::uintmax_t>::max());
+        monitor.sigCriticalSpace.connect(
+            [&](const sacnlogger::DiskSpaceForecast&)
+            {
+                {
+                    const std::scoped_lock lock(mutex);
+                    ++criticalCount;
+                }
+                changed.notify_all();
+            });
+        monitor.sigLowSpace.connect(
+            [&](const sacnlogger::DiskSpaceForecast&)
+            {
+                {
+                    const std::scoped_lock lock(mutex);
+                    ++lowCount;
+                }
+                changed.notify_all();
+            });
+        monitor.setPath(tempDir.path);
+        std::unique_lock lock(mutex);
+        REQUIRE(changed.wait_for(lock, timeout, [&]() { return criticalCount == 1; }));
+
+        // Room was made, but not enough to leave low space.
+        monitor.setLowSpaceThreshold(std::numeric_limits<std::uintmax_t>::max());
+        monitor.setCriticalSpaceThreshold(0);
+        REQUIRE(changed.wait_for(lock, timeout, [&]() { return lowCount == 1; }));
+
+        // The next critical episode is signalled too.
+        monitor.setCriticalSpaceThreshold(std::numeric_limits<std::uintmax_t>::max());
+        REQUIRE(changed.wait_for(lock, timeout, [&]() { return criticalCount == 2; }));
+    }
+
+    SECTION("Freed Space")
+    {
+        sacnlogger::DiskSpaceMonitor monitor;
+        monitor.setPollPeriod(10ms);
+        // Removing old logs as fast as they are written doesn't fill the drive.
+        monitor.addWritten(1024 * 1024);
+        monitor.addReclaimed(512 * 1024);
+        monitor.addRemoved(512 * 1024);
+        monitor.setPath(tempDir.path);
+        const auto start = std::chrono::steady_clock::now();
+        while (monitor.forecast().available == 0 && std::chrono::steady_clock::now() - start < timeout)
+        {
+            std::this_thread::sleep_for(10ms);
+        }
+        const auto forecast = monitor.forecast();
+        CHECK(forecast.available > 0);
+        CHECK(forecast.writeRate == 0);
+        CHECK_FALSE(forecast.timeToFull);
+    }
+
+    SECTION("Stop")
+    {
+        const auto start = std::chrono::steady_clock::now();
+        {
+            sacnlogger::DiskSpaceMonitor monitor(tempDir.path);
+            monitor.setPollPeriod(1h);
+        }
+        // Doesn't wait for the next poll.
+        CHECK(std::chrono::steady_clock::now() - start < timeout);
+    }
+}
@@ -0,0 +1,183 @@
+/**
+ * @file FlightRecorderTest.cpp
+ *
+ * @author Dan Keenan
+ * @date 10/17/26
+ * @copyright GPL-3.0-or-later
+ * Copyright (C) 2024-2026 Dan Keenan
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <sacn/cpp/common.h>
+#include <vector>
+#include "TempDir.h"
+#include "sacnloggerlib/FlightRecorder.h"
+#include "sacnloggerlib/SacnLogReader.h"
+
+using namespace std::chrono_literals;
+
+namespace
+{
+    /**
+     * Read the first level of every frame in @p path.
+     */
+    std::vector<unsigned int> readLevels(const std::filesystem::path& path)
+    {
+        sacnlogger::SacnLogReader reader(path);
+        sacnlogger::SacnLogReader::Frame frame;
+        std::vector<unsigned int> r;
+        while (reader.next(frame))
+        {
+            r.push_back(frame.levels[0]);
+        }
+        return r;
+    }
+} // namespace
+
+TEST_CASE("Flight Recorder")
+{
+    const TempDir tempDir;
+    const auto path = tempDir.path / "U00001_flight.sacnlog";
+    const auto time = spdlog::log_clock::now();
+
+    sacnlogger::ComparableData data;
+    data.owners_.fill(sacn::kInvalidRemoteSourceHandle);
+
+    SECTION("Dump")
+    {
+        sacnlogger::FlightRecorder recorder(1, 1024 * 1024, 10min);
+        const auto cid = etcpal::Uuid::OsPreferred();
+        recorder.sources().setSource(7, cid, "A", "Console");
+        // More frames than fit in a block, then a wider one.
+        for (unsigned int frame = 0; frame < sacnlogger::SacnLogEncoder::kFramesPerBlock + 1; ++frame)
+        {
+            data.levels_[0] = frame;
+            data.priorities_[0] = 100;
+            data.owners_[0] = 7;
+            recorder.addFrame(time + std::chrono::milliseconds(frame), data, 2);
+        }
+        data.owners_[2] = 8;
+        recorder.addFrame(time + 1s, data, 3);
+        CHECK(recorder.frameCount() == sacnlogger::SacnLogEncoder::kFramesPerBlock + 2);
+        CHECK(recorder.oldest() == time);
+        REQUIRE(recorder.dump(path));
+        // Nothing is removed by dumping.
+        CHECK(recorder.frameCount() == sacnlogger::SacnLogEncoder::kFramesPerBlock + 2);
+
+        sacnlogger::SacnLogReader reader(path);
+        CHECK(reader.universe() == 1);
+        sacnlogger::SacnLogReader::Frame frame;
+        for (unsigned int ix = 0; ix < sacnlogger::SacnLogEncoder::kFramesPerBlock + 1; ++ix)
+        {
+            REQUIRE(reader.next(frame));
+            CHECK(frame.time == time + std::chrono::milliseconds(ix));
+            REQUIRE(frame.levels.size() == 2);
+            CHECK(frame.levels[0] == ix);
+            CHECK(frame.priorities[0] == 100);
+            CHECK(frame.owners[0] == 0);
+            CHECK(frame.owners[1] == sacnlogger::sacnlog::kNoOwner);
+        }
+        REQUIRE(reader.next(frame));
+        REQUIRE(frame.levels.size() == 3);
+        CHECK(frame.owners[2] == sacnlogger::sacnlog::kUnknownOwner);
+        const auto* source = reader.source(0);
+        REQUIRE(source != nullptr);
+        CHECK(source->cid == cid);
+        CHECK(source->abbreviation == "A");
+        CHECK(source->name == "Console");
+        CHECK_FALSE(reader.next(frame));
+    }
+
+    SECTION("Full")
+    {
+        // Room for 3 full universes. Mixed widths make records wrap at different places.
+        sacnlogger::FlightRecorder recorder(1, 3 * sacnlogger::FlightRecorder::kMinCapacity, 10min);
+        const std::vector<std::size_t> slotCounts{512, 100, 300, 512, 1, 200};
+        for (unsigned int frame = 0; frame < 200; ++frame)
+        {
+            data.levels_[0] = frame;
+            recorder.addFrame(time + std::chrono::milliseconds(frame), data, slotCounts[frame % slotCounts.size()]);
+
+            // Whatever is kept is always the newest frames, in order.
+            REQUIRE(recorder.dump(path));
+            const auto levels = readLevels(path);
+            REQUIRE(levels.size() == recorder.frameCount());
+            for (std::size_t ix = 0; ix < levels.size(); ++ix)
+            {
+                CHECK(levels[ix] == frame + 1 - levels.size() + ix);
+            }
+            std::size_t keptBytes = 0;
+            for (std::size_t ix = 0; ix < levels.size(); ++ix)
+            {
+                keptBytes += sacnlogger::FlightRecorder::recordSize(slotCounts[levels[ix] % slotCounts.size()]);
+            }
+            CHECK(keptBytes <= recorder.capacity());
+        }
+        CHECK(recorder.frameCount() >= 3);
+    }
+
+    SECTION("Window")
+    {
+        sacnlogger::FlightRecorder recorder(1, 1024 * 1024, 1min);
+        for (unsigned int frame = 0; frame < 10; ++frame)
+        {
+            data.levels_[0] = frame;
+            recorder.addFrame(time + std::chrono::seconds(frame * 10), data, 1);
+        }
+        // Frame 3 is before the window, but is what the universe looked like when it starts.
+        CHECK(recorder.oldest() == time + 30s);
+        REQUIRE(recorder.dump(path));
+        CHECK(readLevels(path) == std::vector<unsigned int>{3, 4, 5, 6, 7, 8, 9});
+
+        // Even if nothing has changed for longer than the window.
+        data.levels_[0] = 10;
+        recorder.addFrame(time + 1h, data, 1);
+        CHECK(recorder.frameCount() == 2);
+        REQUIRE(recorder.dump(path));
+        CHECK(readLevels(path) == std::vector<unsigned int>{9, 10});
+    }
+
+    SECTION("Range")
+    {
+        sacnlogger::FlightRecorder recorder(1, 1024 * 1024, 10min);
+        for (unsigned int frame = 0; frame < 10; ++frame)
+        {
+            data.levels_[0] = frame;
+            recorder.addFrame(time + std::chrono::seconds(frame * 10), data, 1);
+        }
+        // Frame 2 is what the universe looked like at the start.
+        REQUIRE(recorder.dump(path, time + 25s, time + 60s));
+        CHECK(readLevels(path) == std::vector<unsigned int>{2, 3, 4, 5, 6});
+        REQUIRE(recorder.dump(path, time + 20s, time + 20s));
+        CHECK(readLevels(path) == std::vector<unsigned int>{2});
+        // Before anything was recorded.
+        REQUIRE(recorder.dump(path, time - 1h, time + 5s));
+        CHECK(readLevels(path) == std::vector<unsigned int>{0});
+        // After everything that was recorded.
+        REQUIRE(recorder.dump(path, time + 1h, time + 2h));
+        CHECK(readLevels(path) == std::vector<unsigned int>{9});
+    }
+
+    SECTION("Empty")
+    {
+        sacnlogger::FlightRecorder recorder(1, 0, 10min);
+        CHECK(recorder.capacity() == sacnlogger::FlightRecorder::kMinCapacity);
+        CHECK_FALSE(recorder.oldest());
+        REQUIRE(recorder.dump(path));
+        CHECK(readLevels(path).empty());
+        // No temporary files are left.
+        CHECK(std::distance(std::filesystem::directory_iterator(tempDir.path), {}) == 1);
+    }
+}
@@ -0,0 +1,227 @@
+/**
+ * @file FrameDiffTest.cpp
+ *
+ * @author Dan Keenan
+ * @date 10/17/26
+ * @copyright GPL-3.0-or-later
+ * Copyright (C) 2024-2026 Dan Keenan
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+#include <random>
+#include <sacn/cpp/common.h>
+#include <vector>
+#include "sacnloggerlib/FrameDiff.h"
+#include "sacnloggerlib/UniverseMonitor.h"
+
+namespace
+{
+    /**
+     * Owns the buffers behind a SacnRecvMergedData.
+     */
+    struct MergedFrame
+    {
+        std::array<uint8_t, SACN_MERGE_RECEIVER_MAX_SLOTS> levels{};
+        std::array<uint8_t, SACN_MERGE_RECEIVER_MAX_SLOTS> priorities{};
+        std::array<sacn_remote_source_t, SACN_MERGE_RECEIVER_MAX_SLOTS> owners{};
+
+        MergedFrame() { owners.fill(sacn::kInvalidRemoteSourceHandle); }
+
+        [[nodiscard]] SacnRecvMergedData data(uint16_t startAddress = 1,
+                                              uint16_t addressCount = SACN_MERGE_RECEIVER_MAX_SLOTS) const
+        {
+            SacnRecvMergedData r{};
+            r.universe_id = 1;
+            r.slot_range.start_address = startAddress;
+            r.slot_range.address_count = addressCount;
+            r.levels = levels.data() + startAddress - 1;
+            r.priorities = priorities.data() + startAddress - 1;
+            r.owners = owners.data() + startAddress - 1;
+            return r;
+        }
+    };
+
+    sacnlogger::SlotMask scalarDiff(const sacnlogger::ComparableData& lhs, const MergedFrame& rhs)
+    {
+        sacnlogger::SlotMask r;
+        sacnlogger::detail::diffSlotsScalar(lhs.levels_.data(), rhs.levels.data(), rhs.levels.size(), 0, r);
+        sacnlogger::detail::diffSlotsScalar(lhs.priorities_.data(), rhs.priorities.data(), rhs.priorities.size(), 0,
+                                            r);
+        sacnlogger::detail::diffSlotsScalar(lhs.owners_.data(), rhs.owners.data(), rhs.owners.size(), 0, r);
+        return r;
+    }
+} // namespace
+
+TEST_CASE("Slot Mask")
+{
+    sacnlogger::SlotMask mask;
+    REQUIRE_FALSE(mask.any());
+
+    SECTION("Set and test")
+    {
+        mask.set(0);
+        mask.set(63);
+        mask.set(64);
+        mask.set(511);
+        CHECK(mask.any());
+        CHECK(mask.count() == 4);
+        CHECK(mask.test(63));
+        CHECK(mask.test(64));
+        CHECK_FALSE(mask.test(62));
+
+        std::vector<std::size_t> slots;
+        mask.forEach([&slots](std::size_t slot) { slots.push_back(slot); });
+        CHECK(slots == std::vector<std::size_t>{0, 63, 64, 511});
+    }
+
+    SECTION("Bits crossing a word boundary")
+    {
+        mask.orBits(56, 0xFFFF, 16);
+        CHECK(mask.count() == 16);
+        CHECK_FALSE(mask.test(55));
+        CHECK(mask.test(56));
+        CHECK(mask.test(71));
+        CHECK_FALSE(mask.test(72));
+    }
+}
+
+TEST_CASE("Frame Diff")
+{
+    INFO("Kernel: " << sacnlogger::diffSlotsKernel());
+    std::mt19937 rng(GENERATE(1u, 2u, 3u));
+    std::uniform_int_distribution<unsigned int> byteDist(0, 255);
+    std::uniform_int_distribution<std::size_t> slotDist(0, SACN_MERGE_RECEIVER_MAX_SLOTS - 1);
+
+    MergedFrame frame;
+    sacnlogger::ComparableData last(frame.data());
+    REQUIRE_FALSE(last.diff(frame.data()).any());
+
+    SECTION("Single slot changes")
+    {
+        for (unsigned int i = 0; i < 64; ++i)
+        {
+            const auto slot = slotDist(rng);
+            MergedFrame changed = frame;
+            switch (i % 3)
+            {
+                case 0:
+                    changed.levels[slot] ^= 0x80;
+                    break;
+                case 1:
+                    changed.priorities[slot] ^= 0x01;
+                    break;
+                default:
+                    changed.owners[slot] = 0x0100;
+                    break;
+            }
+            sacnlogger::SlotMask expected;
+            expected.set(slot);
+            CHECK(last.diff(changed.data()) == expected);
+        }
+    }
+
+    SECTION("Random frames match scalar comparison")
+    {
+        for (unsigned int i = 0; i < 32; ++i)
+        {
+            MergedFrame changed = frame;
+            for (unsigned int j = 0; j < 40; ++j)
+            {
+                changed.levels[slotDist(rng)] = byteDist(rng);
+                changed.priorities[slotDist(rng)] = byteDist(rng);
+                changed.owners[slotDist(rng)] = byteDist(rng) << 4;
+            }
+            CHECK(last.diff(changed.data()) == scalarDiff(last, changed));
+        }
+    }
+
+    SECTION("Partial slot range")
+    {
+        MergedFrame changed = frame;
+        changed.levels[0] = 255;
+        changed.levels[20] = 255;
+        changed.owners[40] = 1;
+        changed.levels[100] = 255;
+        const sacnlogger::ComparableData partial(frame.data(3, 97));
+        sacnlogger::SlotMask expected;
+        expected.set(20);
+        expected.set(40);
+        CHECK(partial.diff(changed.data(3, 97)) == expected);
+    }
+
+    SECTION("Shrinking slot range")
+    {
+        MergedFrame full = frame;
+        full.levels[100] = 50;
+        full.owners[100] = 0;
+        full.owners[200] = 3;
+        full.owners[23] = 0;
+        sacnlogger::ComparableData data(full.data());
+        // Slots that are no longer received go to level 0 with no owner.
+        sacnlogger::SlotMask expected;
+        expected.set(100);
+        expected.set(200);
+        CHECK(data.diff(full.data(1, 24)) == expected);
+        CHECK(data.diffOwners(full.data(1, 24)) == expected);
+
+        data.assign(full.data(1, 24));
+        CHECK(data.levels_[100] == 0);
+        CHECK(data.owners_[100] == sacn::kInvalidRemoteSourceHandle);
+        CHECK(data.owners_[200] == sacn::kInvalidRemoteSourceHandle);
+        CHECK(data.owners_[23] == 0);
+        CHECK_FALSE(data.diff(full.data(1, 24)).any());
+    }
+
+    SECTION("No owners by default")
+    {
+        CHECK(sacnlogger::ComparableData().owners_ == sacnlogger::ComparableData::kNoOwners);
+        CHECK(sacnlogger::ComparableData().owners_[0] == sacn::kInvalidRemoteSourceHandle);
+    }
+}
+
+// Not run by default.  Use `sacnloggerlib_test "[benchmark]"`.
+TEST_CASE("Frame Diff Benchmark", "[.][benchmark]")
+{
+    MergedFrame frame;
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<unsigned int> byteDist(0, 255);
+    for (std::size_t slot = 0; slot < SACN_MERGE_RECEIVER_MAX_SLOTS; ++slot)
+    {
+        frame.levels[slot] = byteDist(rng);
+        frame.priorities[slot] = 100;
+        frame.owners[slot] = slot % 4;
+    }
+    const sacnlogger::ComparableData last(frame.data());
+    MergedFrame changed = frame;
+    changed.levels.back() ^= 1;
+
+    BENCHMARK("ComparableData operator<=> (unchanged)")
+    {
+        sacnlogger::ComparableData newData(frame.data());
+        return newData != last;
+    };
+    BENCHMARK("Scalar diff (unchanged)") { return scalarDiff(last, frame).any(); };
+    BENCHMARK("Kernel diff (unchanged)") { return last.diff(frame.data()).any(); };
+
+    BENCHMARK("ComparableData operator<=> (last slot changed)")
+    {
+        sacnlogger::ComparableData newData(changed.data());
+        return newData != last;
+    };
+    BENCHMARK("Scalar diff (last slot changed)") { return scalarDiff(last, changed).any(); };
+    BENCHMARK("Kernel diff (last slot changed)") { return last.diff(changed.data()).any(); };
+}
@@ -0,0 +1,608 @@
+/**
+ * @file LogWriterTest.cpp
+ *
+ * @author Dan Keenan
+ * @date 10/17/26
+ * @copyright GPL-3.0-or-later
+ * Copyright (C) 2024-2026 Dan Keenan
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+#include <filesystem>
+#include <fmt/chrono.h>
+#include <fstream>
+#include <future>
+#include <spdlog/async.h>
+#include <spdlog/sinks/rotating_file_sink.h>
+#include <sys/stat.h>
+#include <sys/statvfs.h>
+#include <thread>
+#include "TempDir.h"
+#include "sacnloggerlib/LogWriter.h"
+#include "sacnloggerlib/SegmentManifest.h"
+#include "sacnloggerlib/TimeIndex.h"
+#include "sacnloggerlib/ZstdStream.h"
+
+TEST_CASE("Buffer Pool")
+{
+    sacnlogger::BufferPool pool(2, 16);
+    auto* block0 = pool.tryAcquire();
+    auto* block1 = pool.tryAcquire();
+    REQUIRE(block0 != nullptr);
+    REQUIRE(block1 != nullptr);
+    CHECK(block0->data != block1->data);
+    CHECK(block0->available() == 16);
+    CHECK(pool.tryAcquire() == nullptr);
+    CHECK(pool.freeCount() == 0);
+
+    block0->size = 4;
+    pool.release(block0);
+    CHECK(pool.freeCount() == 1);
+    auto* block = pool.acquire();
+    CHECK(block == block0);
+    CHECK(block->size == 0);
+
+    SECTION("Reserve")
+    {
+        pool.release(block0);
+        CHECK(pool.tryAcquire(1) == nullptr);
+        CHECK(pool.tryAcquire(0) == block0);
+    }
+}
+
+TEST_CASE("Log Writer Block Count")
+{
+    using sacnlogger::LogWriter;
+    CHECK(LogWriter::blockCountFor(0) == LogWriter::kDefaultBlockCount);
+    // Enough for every stream, with the default to spare.
+    CHECK(LogWriter::blockCountFor(2) == LogWriter::kDefaultBlockCount + 2 * LogWriter::kBlocksPerStream);
+    CHECK(LogWriter::blockCountFor(1000) - LogWriter::kDefaultBlockCount >= 1000 * LogWriter::kBlocksPerStream);
+}
+
+TEST_CASE("Log Writer")
+{
+    const TempDir tempDir;
+    const auto path = tempDir.path / "U00001_data.csv";
+    const auto firstPath = tempDir.path / "U00001_data.000001.csv";
+    const auto time = spdlog::log_clock::now();
+    const auto timestamp = fmt::format("{:%Y-%m-%d %H:%M:%S}.", fmt::localtime(spdlog::log_clock::to_time_t(time)));
+
+    SECTION("Lines")
+    {
+        std::uintmax_t written = 0;
+        {
+            // Small blocks, so lines cross them.
+            sacnlogger::LogWriter writer(4, 8);
+            writer.sigWritten.connect([&written](std::uintmax_t bytes) { written += bytes; });
+            auto stream = writer.openStream(path, 1024, 2);
+            CHECK(stream->takeFileStarted());
+            CHECK_FALSE(stream->takeFileStarted());
+            stream->write(time, "\"header\"");
+            stream->write(time, "1,2,3");
+        }
+        CHECK_FALSE(std::filesystem::exists(path));
+        const auto contents = readFile(firstPath);
+        CHECK(contents.starts_with(timestamp));
+        CHECK(contents.find(",\"header\"\n") != std::string::npos);
+        CHECK(contents.ends_with(",1,2,3\n"));
+        CHECK(std::count(contents.begin(), contents.end(), '\n') == 2);
+        CHECK(written == contents.size());
+    }
+
+    SECTION("Small Rows Share a Block")
+    {
+        unsigned int writes = 0;
+        {
+            sacnlogger::LogWriter writer(4, 1024);
+            writer.sigWritten.connect([&writes](std::uintmax_t) { ++writes; });
+            auto stream = writer.openStream(path, 1024 * 1024, 2);
+            for (unsigned int ix = 0; ix < 10; ++ix)
+            {
+                stream->write(time, fmt::format("{},100,\"A\"", ix));
+            }
+            CHECK(stream->pending());
+            CHECK(writer.pool().freeCount() == 3);
+            // Only the timer hands a partly filled block over.
+            const auto now = std::chrono::steady_clock::now();
+            CHECK_FALSE(stream->flushDue(now));
+            CHECK(stream->flushDue(now + sacnlogger::LogWriter::Stream::kMaxBlockAge));
+            stream->flush();
+            CHECK_FALSE(stream->pending());
+        }
+        CHECK(std::ranges::count(readFile(firstPath), '\n') == 10);
+        CHECK(writes == 1);
+    }
+
+    SECTION("Drop Oldest")
+    {
+        // Lines of up to two blocks, so some cross them. The first one to be dropped does.
+        const auto line = [](unsigned int ix)
+        { return fmt::format("{},{}", ix, std::string(40 + (ix * 97 + 300) % 400, char('a' + ix % 26))); };
+        unsigned int lineCount = 1;
+        std::promise<void> stalled;
+        std::promise<void> resume;
+        std::uintmax_t droppedBytes = 0;
+        uint64_t droppedBlocks = 0;
+        {
+            sacnlogger::LogWriter writer(8, 256);
+            // Hold up the writer thread after its first batch, so blocks pile up.
+            bool first = true;
+            writer.sigWritten.connect(
+                [&stalled, &first, resumed = resume.get_future().share()](std::uintmax_t)
+                {
+                    if (std::exchange(first, false))
+                    {
+                        stalled.set_value();
+                    }
+                    resumed.wait_for(std::chrono::seconds(5));
+                });
+            auto stream = writer.openStream(path, 1024 * 1024, 2, sacnlogger::OverflowPolicy::DropOldest);
+            stream->write(time, line(0));
+            stream->flush();
+            REQUIRE(stalled.get_future().wait_for(std::chrono::seconds(5)) == std::future_status::ready);
+            // Stop once something has been dropped, so what is left of it would be written.
+            for (; lineCount < 200 && stream->counters().droppedBlocks == 0; ++lineCount)
+            {
+                stream->write(time, line(lineCount));
+            }
+            stream->flush();
+            droppedBytes = stream->takeDroppedBytes();
+            droppedBlocks = stream->counters().droppedBlocks;
+            resume.set_value();
+        }
+        CHECK(droppedBlocks > 0);
+
+        // Whole lines are dropped, and the rest are intact and in order.
+        std::ifstream file(firstPath);
+        std::string text;
+        std::optional<unsigned int> last;
+        std::uintmax_t missingBytes = 0;
+        while (std::getline(file, text))
+        {
+            REQUIRE(text.starts_with(timestamp));
+            const auto fields = text.substr(text.find(',') + 1);
+            const auto ix = static_cast<unsigned int>(std::stoul(fields));
+            REQUIRE(fields == line(ix));
+            for (auto missing = last ? *last + 1 : 0; missing < ix; ++missing)
+            {
+                missingBytes += text.find(',') + line(missing).size() + 2;
+            }
+            CHECK((!last || ix > *last));
+            last = ix;
+        }
+        CHECK(last == lineCount - 1);
+        CHECK(missingBytes == droppedBytes);
+        CHECK(droppedBytes > 0);
+    }
+
+    SECTION("Append")
+    {
+        {
+            std::ofstream existing(firstPath);
+            existing << "existing\n";
+        }
+        {
+            sacnlogger::LogWriter writer;
+            auto stream = writer.openStream(path, 20, 2);
+            CHECK(stream->wouldOverflow(12));
+            CHECK_FALSE(stream->wouldOverflow(11));
+            stream->write(time, "1");
+        }
+        CHECK(readFile(firstPath).starts_with("existing\n" + timestamp));
+    }
+
+    SECTION("Rotation")
+    {
+        const auto openedAt = spdlog::log_clock::now();
+        {
+            sacnlogger::LogWriter writer;
+            auto stream = writer.openStream(path, 1024, 2);
+            CHECK(stream->takeFileStarted());
+            for (const auto line : {"a", "b", "c", "d"})
+            {
+                stream->write(time, line);
+                stream->rotate();
+                CHECK(stream->takeFileStarted());
+            }
+            stream->write(time, "e");
+        }
+        CHECK(readFile(tempDir.path / "U00001_data.000005.csv").ends_with(",e\n"));
+        CHECK(readFile(tempDir.path / "U00001_data.000004.csv").ends_with(",d\n"));
+        CHECK(readFile(tempDir.path / "U00001_data.000003.csv").ends_with(",c\n"));
+        CHECK_FALSE(std::filesystem::exists(tempDir.path / "U00001_data.000002.csv"));
+        CHECK_FALSE(std::filesystem::exists(firstPath));
+
+        // The manifest still lists the removed segments until it is rewritten.
+        const auto manifestText = readFile(tempDir.path / "U00001_data.csv.manifest");
+        CHECK(std::count(manifestText.begin(), manifestText.end(), '\n') == 5);
+        CHECK(manifestText.ends_with(",\"U00001_data.000005.csv\"\n"));
+        const sacnlogger::SegmentManifest manifest(path);
+        REQUIRE(manifest.segments().size() == 3);
+        CHECK(manifest.segments()[0].sequence == 3);
+        CHECK(manifest.segments()[2].path == tempDir.path / "U00001_data.000005.csv");
+        REQUIRE(manifest.segments()[0].startedAt);
+        // Timestamps only keep milliseconds.
+        CHECK(*manifest.segments()[0].startedAt >= openedAt - std::chrono::milliseconds(1));
+        CHECK(manifest.segmentAt(openedAt - std::chrono::seconds(1)) == nullptr);
+        CHECK(manifest.segmentAt(spdlog::log_clock::now())->sequence == 5);
+
+        SECTION("Resume")
+        {
+            {
+                sacnlogger::LogWriter writer;
+                auto stream = writer.openStream(path, 1024, 2);
+                stream->write(time, "f");
+            }
+            const auto contents = readFile(tempDir.path / "U00001_data.000005.csv");
+            CHECK(contents.find(",e\n") != std::string::npos);
+            CHECK(contents.ends_with(",f\n"));
+            CHECK_FALSE(std::filesystem::exists(tempDir.path / "U00001_data.000006.csv"));
+            const auto rewrittenText = readFile(tempDir.path / "U00001_data.csv.manifest");
+            CHECK(std::count(rewrittenText.begin(), rewrittenText.end(), '\n') == 3);
+        }
+    }
+
+    SECTION("Time Index")
+    {
+        {
+            // Keyframes go in new blocks, so make sure there are enough.
+            sacnlogger::LogWriter writer(4, 64);
+            auto stream = writer.openStream(path, 1024, 2);
+            stream->write(time, "header");
+            stream->markKeyframe(time);
+            stream->write(time, "key1");
+            stream->write(time + std::chrono::seconds(1), "delta");
+            stream->markKeyframe(time + std::chrono::seconds(2));
+            stream->write(time + std::chrono::seconds(2), "key2");
+            stream->rotate();
+            stream->markKeyframe(time + std::chrono::seconds(3));
+            stream->write(time + std::chrono::seconds(3), "key3");
+        }
+        const sacnlogger::TimeIndex rotatedIndex(firstPath);
+        REQUIRE(rotatedIndex.entries().size() == 2);
+        const auto rotated = readFile(firstPath);
+        CHECK(rotated.substr(rotated.find(',', rotatedIndex.entries()[0].offset)).starts_with(",key1\n"));
+        CHECK(rotated.substr(rotated.find(',', rotatedIndex.entries()[1].offset)).starts_with(",key2\n"));
+
+        CHECK(rotatedIndex.keyframeAt(time - std::chrono::seconds(1)) == nullptr);
+        CHECK(rotatedIndex.keyframeAt(time) == &rotatedIndex.entries()[0]);
+        CHECK(rotatedIndex.keyframeAt(time + std::chrono::seconds(1)) == &rotatedIndex.entries()[0]);
+        CHECK(rotatedIndex.keyframeAt(time + std::chrono::seconds(5)) == &rotatedIndex.entries()[1]);
+
+        const sacnlogger::TimeIndex index(tempDir.path / "U00001_data.000002.csv");
+        REQUIRE(index.entries().size() == 1);
+        CHECK(index.entries()[0].offset == 0);
+    }
+
+    SECTION("Preallocation")
+    {
+        const auto allocated = [&firstPath]()
+        {
+            struct stat st{};
+            REQUIRE(::stat(firstPath.c_str(), &st) == 0);
+            return std::uintmax_t(st.st_blocks) * 512;
+        };
+        {
+            sacnlogger::LogWriter writer;
+            auto stream = writer.openStream(path, 1024 * 1024, 2);
+            stream->write(time, "1");
+            stream->flush();
+            while (writer.pool().freeCount() < writer.pool().blockCount())
+            {
+                std::this_thread::yield();
+            }
+            // Reserved, where the filesystem supports it, but only the line is in the file.
+            CHECK(std::filesystem::file_size(firstPath) == readFile(firstPath).size());
+            CHECK(readFile(firstPath).ends_with(",1\n"));
+            if (allocated() < 1024 * 1024)
+            {
+                WARN("Preallocation isn't supported in " << tempDir.path);
+            }
+        }
+        // Closing gives back what wasn't used.
+        CHECK(allocated() < 1024 * 1024);
+        CHECK(readFile(firstPath).ends_with(",1\n"));
+    }
+
+    SECTION("Staging")
+    {
+        const auto stagingDir = tempDir.path / "staging";
+        const auto stagingArea =
+            std::make_shared<sacnlogger::StagingArea>(stagingDir, 1024 * 1024, std::chrono::hours(1));
+        {
+            sacnlogger::LogWriter writer(4, 64, nullptr, {}, false, stagingArea);
+            auto stream = writer.openStream(path, 1024, 2);
+            stream->write(time, "header");
+            stream->markKeyframe(time);
+            stream->write(time, "key1");
+            stream->rotate();
+            stream->write(time, "1,2,3");
+        }
+        // Not old enough to have been moved yet.
+        CHECK(readFile(firstPath).empty());
+        CHECK(sacnlogger::SegmentManifest(path).segments().size() == 2);
+        stagingArea->flush();
+        const auto rotated = readFile(firstPath);
+        CHECK(rotated.find(",header\n") != std::string::npos);
+        CHECK(readFile(tempDir.path / "U00001_data.000002.csv").ends_with(",1,2,3\n"));
+        const sacnlogger::TimeIndex index(firstPath);
+        REQUIRE(index.entries().size() == 1);
+        CHECK(rotated.substr(rotated.find(',', index.entries()[0].offset)).starts_with(",key1\n"));
+        CHECK(std::filesystem::is_empty(stagingDir));
+    }
+
+    SECTION("Group Commit")
+    {
+        struct statvfs vfs{};
+        REQUIRE(::statvfs(tempDir.path.c_str(), &vfs) == 0);
+        const std::uintmax_t clusterSize = vfs.f_bsize;
+        const auto waitForFile = [&firstPath]()
+        {
+            const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+            while (std::filesystem::file_size(firstPath) == 0 && std::chrono::steady_clock::now() < deadline)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+        };
+
+        SECTION("Interval")
+        {
+            sacnlogger::LogWriter writer(sacnlogger::LogWriter::kDefaultBlockCount,
+                                         sacnlogger::LogWriter::kDefaultBlockSize, nullptr,
+                                         {.interval = std::chrono::milliseconds(200)});
+            auto stream = writer.openStream(path, 1024 * 1024, 2);
+            stream->write(time, "1");
+            stream->flush();
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            CHECK(std::filesystem::file_size(firstPath) == 0);
+            waitForFile();
+            CHECK(readFile(firstPath).ends_with(",1\n"));
+            while (writer.longestCommitWait().count() == 0)
+            {
+                std::this_thread::yield();
+            }
+            CHECK(writer.longestCommitWait() >= std::chrono::milliseconds(200));
+        }
+
+        SECTION("Size")
+        {
+            std::uintmax_t committedSize;
+            {
+                sacnlogger::LogWriter writer(sacnlogger::LogWriter::kDefaultBlockCount,
+                                             sacnlogger::LogWriter::kDefaultBlockSize, nullptr,
+                                             {.interval = std::chrono::hours(1), .bytes = clusterSize});
+                auto stream = writer.openStream(path, 1024 * 1024, 2);
+                // A few clusters, and then some.
+                const std::string line(99, 'x');
+                for (std::uintmax_t lineCount = 0; lineCount < 3 * clusterSize / 100; ++lineCount)
+                {
+                    stream->write(time, line);
+                }
+                stream->flush();
+                waitForFile();
+                committedSize = std::filesystem::file_size(firstPath);
+            }
+            // Only whole clusters are committed early, and the rest when the file is closed.
+            const auto size = std::filesystem::file_size(firstPath);
+            CHECK(committedSize == size / clusterSize * clusterSize);
+            CHECK(committedSize < size);
+            CHECK(readFile(firstPath).ends_with("x\n"));
+        }
+    }
+
+    SECTION("io_uring")
+    {
+        const auto commitInterval = GENERATE(std::chrono::milliseconds(0), std::chrono::milliseconds(20));
+        constexpr unsigned int kStreamCount = 40;
+        constexpr unsigned int kLineCount = 2000;
+        {
+            // More files than can be in flight, with small blocks, so the queue fills up. Each stream holds a block.
+            sacnlogger::LogWriter writer(64, 256, nullptr, {.interval = commitInterval}, true);
+            if (!writer.usingIoUring())
+            {
+                WARN("io_uring isn't available, so the usual writes were tested");
+            }
+            std::vector<std::unique_ptr<sacnlogger::LogWriter::Stream>> streams;
+            for (unsigned int ix = 0; ix < kStreamCount; ++ix)
+            {
+                // The last one is compressed, which reuses its output buffer between writes.
+                streams.push_back(writer.openStream(tempDir.path / fmt::format("U{:05}_data.csv", ix), 1024 * 1024, 2,
+                                                    sacnlogger::OverflowPolicy::Block, false,
+                                                    ix == kStreamCount - 1 ? 3 : 0));
+            }
+            for (unsigned int line = 0; line < kLineCount; ++line)
+            {
+                for (auto& stream : streams)
+                {
+                    stream->write(time, fmt::format("{}", line));
+                }
+            }
+        }
+        for (unsigned int ix = 0; ix < kStreamCount; ++ix)
+        {
+            const auto segment = tempDir.path / fmt::format("U{:05}_data.000001.csv", ix);
+            std::string contents;
+            if (ix == kStreamCount - 1)
+            {
+                const auto decompressed = sacnlogger::decompressFile(segment.string() + ".zst");
+                contents.assign(decompressed.begin(), decompressed.end());
+            }
+            else
+            {
+                contents = readFile(segment);
+                // Writes may finish out of order, but must not leave holes.
+                CHECK(contents.find('\0') == std::string::npos);
+            }
+            CHECK(std::count(contents.begin(), contents.end(), '\n') == kLineCount);
+            CHECK(contents.ends_with(fmt::format(",{}\n", kLineCount - 1)));
+        }
+    }
+
+    SECTION("Compression")
+    {
+        const auto existingPath = tempDir.path / "U00001_data.000001.csv.zst";
+        const auto compressedPath = tempDir.path / "U00001_data.000002.csv.zst";
+        {
+            std::ofstream existing(existingPath);
+            existing << "existing\n";
+        }
+        double compressionRatio;
+        {
+            sacnlogger::LogWriter writer;
+            auto stream = writer.openStream(path, 1024 * 1024, 2, sacnlogger::OverflowPolicy::Block, false, 3);
+            CHECK(stream->compressed());
+            for (unsigned int line = 0; line < 1000; ++line)
+            {
+                if (line == 500)
+                {
+                    stream->markKeyframe(time);
+                }
+                stream->write(time, fmt::format("{},100,\"A\"", line));
+            }
+            stream->flush();
+            // Wait for the writer.
+            while (writer.pool().freeCount() < writer.pool().blockCount())
+            {
+                std::this_thread::yield();
+            }
+            compressionRatio = stream->compressionRatio();
+        }
+        CHECK(compressionRatio > 2);
+        // The existing file isn't appended to.
+        CHECK(readFile(existingPath) == "existing\n");
+        CHECK_FALSE(std::filesystem::exists(tempDir.path / "U00001_data.000002.csv"));
+
+        const auto contents = sacnlogger::decompressFile(compressedPath);
+        const std::string text(contents.begin(), contents.end());
+        CHECK(text.starts_with(timestamp));
+        CHECK(text.ends_with(",999,100,\"A\"\n"));
+        CHECK(std::count(text.begin(), text.end(), '\n') == 1000);
+
+        // Keyframes start a new frame.
+        const sacnlogger::TimeIndex index(compressedPath);
+        REQUIRE(index.entries().size() == 1);
+        const auto fromKeyframe = sacnlogger::decompressFile(compressedPath, index.entries()[0].offset);
+        const std::string keyframeText(fromKeyframe.begin(), fromKeyframe.end());
+        CHECK(keyframeText.substr(keyframeText.find(',')).starts_with(",500,100,\"A\"\n"));
+    }
+}
+
+TEST_CASE("Log Writer Benchmark", "[.][benchmark]")
+{
+    // Like a busy appliance: a frame's row for each universe, flushed together, as fast as the writer will take them.
+    // The figures in doc/config.rst are from x86 only; this still needs to be run on a Raspberry Pi 5.
+    constexpr unsigned int kUniverseCount = 64;
+    constexpr unsigned int kFrameCount = 4000;
+    const std::string row(600, 'x');
+
+    const auto report = [&row](std::string_view backend, std::string_view commit,
+                               std::vector<std::chrono::nanoseconds>& latencies,
+                               std::chrono::duration<double> elapsed)
+    {
+        std::ranges::sort(latencies);
+        const auto percentile = [&latencies](double p)
+        {
+            const auto ix = static_cast<std::size_t>(p * double(latencies.size() - 1));
+            return std::chrono::duration_cast<std::chrono::microseconds>(latencies[ix]);
+        };
+        const double mib = double(kUniverseCount) * kFrameCount * row.size() / (1024 * 1024);
+        fmt::print("{:<10} {:>8} {:>10.1f} {:>10} {:>10} {:>10}\n", backend, commit, mib / elapsed.count(),
+                   percentile(0.5).count(), percentile(0.99).count(), percentile(1).count());
+    };
+
+    fmt::print("{:<10} {:>8} {:>10} {:>10} {:>10} {:>10}\n", "Backend", "Commit", "MiB/s", "p50 us", "p99 us",
+               "max us");
+
+    // The async rotating spdlog loggers LogWriter replaced, set up the way UniverseMonitor used them.  They never sync.
+    {
+        const TempDir tempDir;
+        std::vector<std::chrono::nanoseconds> latencies;
+        latencies.reserve(kFrameCount);
+        const auto start = std::chrono::steady_clock::now();
+        {
+            auto threadPool = std::make_shared<spdlog::details::thread_pool>(spdlog::details::default_async_q_size, 1);
+            std::vector<std::shared_ptr<spdlog::logger>> loggers;
+            for (unsigned int ix = 0; ix < kUniverseCount; ++ix)
+            {
+                auto sink = std::make_shared<spdlog::sinks::rotating_file_sink_mt>(
+                    (tempDir.path / fmt::format("U{:05}_data.csv", ix)).string(), 1024 * 1024 * 1024, 2);
+                auto& logger = loggers.emplace_back(std::make_shared<spdlog::async_logger>(
+                    fmt::format("U{:05}_data", ix), std::move(sink), threadPool));
+                logger->set_pattern("%Y-%m-%d %H:%M:%S.%e%z,%v");
+            }
+            for (unsigned int frame = 0; frame < kFrameCount; ++frame)
+            {
+                const auto frameStart = std::chrono::steady_clock::now();
+                for (auto& logger : loggers)
+                {
+                    logger->info(row);
+                }
+                latencies.push_back(std::chrono::steady_clock::now() - frameStart);
+            }
+            // The thread pool writes everything queued before it stops.
+        }
+        report("spdlog", "-", latencies, std::chrono::steady_clock::now() - start);
+    }
+
+    for (const auto commitInterval : {std::chrono::milliseconds(0), std::chrono::milliseconds(100)})
+    {
+        for (const bool ioUring : {false, true})
+        {
+            const TempDir tempDir;
+            std::vector<std::chrono::nanoseconds> latencies;
+            latencies.reserve(kFrameCount);
+            const auto start = std::chrono::steady_clock::now();
+            bool usingIoUring;
+            {
+                sacnlogger::LogWriter writer(sacnlogger::LogWriter::kDefaultBlockCount,
+                                             sacnlogger::LogWriter::kDefaultBlockSize, nullptr,
+                                             {.interval = commitInterval}, ioUring);
+                usingIoUring = writer.usingIoUring();
+                std::vector<std::unique_ptr<sacnlogger::LogWriter::Stream>> streams;
+                for (unsigned int ix = 0; ix < kUniverseCount; ++ix)
+                {
+                    streams.push_back(
+                        writer.openStream(tempDir.path / fmt::format("U{:05}_data.csv", ix), 1024 * 1024 * 1024, 2));
+                }
+                const auto time = spdlog::log_clock::now();
+                for (unsigned int frame = 0; frame < kFrameCount; ++frame)
+                {
+                    // Includes waiting for free blocks, which is where a slow writer shows up.
+                    const auto frameStart = std::chrono::steady_clock::now();
+                    // Flushed like UniverseMonitor's workers do, once a block has waited long enough.
+                    const auto now = std::chrono::steady_clock::now();
+                    for (auto& stream : streams)
+                    {
+                        stream->write(time, row);
+                        if (stream->flushDue(now))
+                        {
+                            stream->flush();
+                        }
+                    }
+                    latencies.push_back(std::chrono::steady_clock::now() - frameStart);
+                }
+            }
+            const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            if (ioUring && !usingIoUring)
+            {
+                WARN("io_uring isn't available");
+                continue;
+            }
+            report(ioUring ? "io_uring" : "write", fmt::format("{}ms", commitInterval.count()), latencies, elapsed);
+        }
+    }
+}
@@ -0,0 +1,168 @@
+/**
+ * @file RetentionManagerTest.cpp
+ *
+ * @author Dan Keenan
+ * @date 10/17/26
+ * @copyright GPL-3.0-or-later
+ * Copyright (C) 2024-2026 Dan Keenan
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <catch2/catch_test_macros.hpp>
+#include <filesystem>
+#include <fmt/format.h>
+#include <fstream>
+#include "TempDir.h"
+#include "sacnloggerlib/RetentionManager.h"
+#include "sacnloggerlib/SegmentManifest.h"
+#include "sacnloggerlib/TimeIndex.h"
+
+namespace
+{
+    /**
+     * Write segments of @p logPath, each @p size bytes and started at @p startedAt, in order.
+     */
+    void writeLog(const std::filesystem::path& logPath, std::initializer_list<spdlog::log_clock::time_point> startedAt,
+                  std::size_t size)
+    {
+        std::ofstream manifest(sacnlogger::segmentManifestPath(logPath));
+        uint64_t sequence = 0;
+        for (const auto time : startedAt)
+        {
+            const auto segment = sacnlogger::segmentPath(logPath, ++sequence);
+            std::ofstream(segment) << std::string(size, 'x');
+            manifest << sacnlogger::SegmentManifest::line(time, segment);
+        }
+    }
+
+    std::vector<uint64_t> sequences(const std::filesystem::path& logPath)
+    {
+        const sacnlogger::SegmentManifest manifest(logPath);
+        std::vector<uint64_t> r;
+        for (const auto& segment : manifest.segments())
+        {
+            r.push_back(segment.sequence);
+        }
+        return r;
+    }
+} // namespace
+
+TEST_CASE("Retention Manager")
+{
+    const TempDir tempDir;
+    const auto busy = tempDir.path / "U00001_data.csv";
+    const auto busySources = tempDir.path / "U00001_sources.csv";
+    const auto quiet = tempDir.path / "U00002_data.csv";
+    const auto time = spdlog::log_clock::now();
+    const auto at = [time](int seconds) { return time + std::chrono::seconds(seconds); };
+    // The quiet universe has the oldest segment, but the busy one uses more than its share.
+    writeLog(busy, {at(1), at(2), at(3), at(4), at(5)}, 1000);
+    writeLog(busySources, {at(1)}, 100);
+    writeLog(quiet, {at(0), at(6)}, 1000);
+    // Time indexes count too.
+    std::ofstream(sacnlogger::timeIndexPath(sacnlogger::segmentPath(busy, 1))) << std::string(100, 'x');
+    const std::chrono::hours pollPeriod(1);
+
+    SECTION("Budget")
+    {
+        // Enforced once when started.
+        const sacnlogger::RetentionManager retentionManager(tempDir.path, 4100, nullptr, pollPeriod);
+        CHECK(retentionManager.budget() == 4100);
+        // Busiest first, down to its quota of 2050 bytes.
+        CHECK(sequences(busy) == std::vector<uint64_t>{4, 5});
+        CHECK_FALSE(std::filesystem::exists(sacnlogger::timeIndexPath(sacnlogger::segmentPath(busy, 1))));
+        CHECK(sequences(busySources) == std::vector<uint64_t>{1});
+        CHECK(sequences(quiet) == std::vector<uint64_t>{1, 2});
+        CHECK(retentionManager.removedBytes() == 3100);
+    }
+
+    SECTION("Segments Being Written")
+    {
+        // Too small for anything, but the newest segment of each log is never removed.
+        const sacnlogger::RetentionManager retentionManager(tempDir.path, 1, nullptr, pollPeriod);
+        CHECK(sequences(busy) == std::vector<uint64_t>{5});
+        CHECK(sequences(busySources) == std::vector<uint64_t>{1});
+        CHECK(sequences(quiet) == std::vector<uint64_t>{2});
+    }
+
+    SECTION("Reclaim")
+    {
+        sacnlogger::RetentionManager retentionManager(tempDir.path, 6000, nullptr, pollPeriod);
+        CHECK(sequences(busy) == std::vector<uint64_t>{3, 4, 5});
+        // Universes over their quota first, then the oldest segments.
+        CHECK(retentionManager.reclaim(1500) == 2000);
+        CHECK(sequences(busy) == std::vector<uint64_t>{4, 5});
+        CHECK(sequences(quiet) == std::vector<uint64_t>{2});
+        CHECK(retentionManager.reclaim(1) == 1000);
+        CHECK(sequences(busy) == std::vector<uint64_t>{5});
+        // Nothing left to remove.
+        CHECK(retentionManager.reclaim(1000) == 0);
+        CHECK(retentionManager.removedBytes() == 5100);
+    }
+
+    SECTION("Manifest Changes")
+    {
+        sacnlogger::RetentionManager retentionManager(tempDir.path, 100000, nullptr, pollPeriod);
+        {
+            std::ofstream manifest(sacnlogger::segmentManifestPath(quiet), std::ios::app);
+            for (const uint64_t sequence : {3, 4})
+            {
+                const auto segment = sacnlogger::segmentPath(quiet, sequence);
+                std::ofstream(segment) << std::string(1000, 'x');
+                manifest << sacnlogger::SegmentManifest::line(at(sequence + 7), segment);
+            }
+        }
+        // Segments started since the last check are known to be new, so the oldest is still removed first.
+        CHECK(retentionManager.reclaim(1) == 1000);
+        CHECK(sequences(quiet) == std::vector<uint64_t>{2, 3, 4});
+    }
+
+    SECTION("Drive Budget")
+    {
+        const sacnlogger::RetentionManager retentionManager(tempDir.path, 0, nullptr, pollPeriod);
+        const auto space = std::filesystem::space(tempDir.path);
+        const auto logBytes = 7200;
+        const auto reserve = std::max(space.capacity / 20, std::min(sacnlogger::RetentionManager::kMinReserve,
+                                                                    space.capacity / 4));
+        CHECK(retentionManager.budget() <= space.available + logBytes);
+        // Other things may be using the drive too, so only roughly.
+        if (space.available > reserve * 2)
+        {
+            CHECK(retentionManager.budget() >= space.available - reserve * 2);
+        }
+    }
+
+    SECTION("Budget For Drive")
+    {
+        constexpr std::uintmax_t kMiB = 1024 * 1024;
+        constexpr std::uintmax_t kGiB = 1024 * kMiB;
+        // Large drives keep kMinReserve, or 5%.
+        CHECK(sacnlogger::RetentionManager::budgetFor(10 * kGiB, 32 * kGiB, 20 * kGiB) == 28 * kGiB);
+        CHECK(sacnlogger::RetentionManager::budgetFor(0, 1000 * kGiB, 1000 * kGiB) == 950 * kGiB);
+        // Small drives keep a quarter of the drive, not all of it.
+        CHECK(sacnlogger::RetentionManager::budgetFor(300 * kMiB, 1 * kGiB, 600 * kMiB) == 644 * kMiB);
+        CHECK(sacnlogger::RetentionManager::budgetFor(0, 2 * kGiB, 2 * kGiB) == 1536 * kMiB);
+        // Nearly full of other files, logs still get something.
+        CHECK(sacnlogger::RetentionManager::budgetFor(50 * kMiB, 1 * kGiB, 100 * kMiB) == 75 * kMiB);
+        CHECK(sacnlogger::RetentionManager::budgetFor(kMiB, 1 * kGiB, 0) > 0);
+    }
+
+    SECTION("Segment Size")
+    {
+        CHECK(sacnlogger::RetentionManager::segmentSizeFor(0) == 1024 * 1024);
+        CHECK(sacnlogger::RetentionManager::segmentSizeFor(100 * 1024 * 1024) == 5 * 1024 * 1024);
+        CHECK(sacnlogger::RetentionManager::segmentSizeFor(100ULL * 1024 * 1024 * 1024) == 20 * 1024 * 1024);
+    }
+}
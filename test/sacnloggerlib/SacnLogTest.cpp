@@ -0,0 +1,174 @@
+/**
+ * @file SacnLogTest.cpp
+ *
+ * @author Dan Keenan
+ * @date 10/17/26
+ * @copyright GPL-3.0-or-later
+ * Copyright (C) 2024-2026 Dan Keenan
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <filesystem>
+#include <fstream>
+#include <sacn/cpp/common.h>
+#include <sstream>
+#include "TempDir.h"
+#include "sacnloggerlib/SacnLogEncoder.h"
+#include "sacnloggerlib/SacnLogReader.h"
+#include "sacnloggerlib/SegmentManifest.h"
+#include "sacnloggerlib/ZstdStream.h"
+
+TEST_CASE("SacnLog")
+{
+    const TempDir tempDir;
+    const auto logPath = tempDir.path / "U00001_data.sacnlog";
+    const auto path = sacnlogger::segmentPath(logPath, 1);
+    const auto time = spdlog::log_clock::now();
+    const auto cid = etcpal::Uuid::OsPreferred();
+
+    sacnlogger::ComparableData data;
+    data.owners_.fill(sacn::kInvalidRemoteSourceHandle);
+    {
+        sacnlogger::LogWriter writer;
+        auto stream = writer.openStream(logPath, 1024 * 1024, 2);
+        sacnlogger::SacnLogEncoder encoder(1);
+        encoder.setSource(7, cid, "A", "Console");
+        // More frames than fit in a block.
+        for (unsigned int frame = 0; frame < sacnlogger::SacnLogEncoder::kFramesPerBlock + 1; ++frame)
+        {
+            data.levels_[0] = frame;
+            data.priorities_[0] = 100;
+            data.owners_[0] = 7;
+            encoder.addFrame(*stream, time + std::chrono::milliseconds(frame), data, 2);
+        }
+        // Wider, with an owner that was never set.
+        data.owners_[2] = 8;
+        encoder.addFrame(*stream, time + std::chrono::seconds(1), data, 3);
+        CHECK_FALSE(encoder.flushDue(time + std::chrono::seconds(1)));
+        CHECK(encoder.flushDue(time + std::chrono::seconds(2)));
+        encoder.flush(*stream);
+    }
+
+    SECTION("Read")
+    {
+        sacnlogger::SacnLogReader reader(path);
+        CHECK(reader.universe() == 1);
+        sacnlogger::SacnLogReader::Frame frame;
+        unsigned int frameCount = 0;
+        while (reader.next(frame) && frameCount < sacnlogger::SacnLogEncoder::kFramesPerBlock + 1)
+        {
+            CHECK(frame.time == time + std::chrono::milliseconds(frameCount));
+            REQUIRE(frame.levels.size() == 2);
+            CHECK(frame.levels[0] == frameCount);
+            CHECK(frame.priorities[0] == 100);
+            CHECK(frame.owners[0] == 0);
+            CHECK(frame.owners[1] == sacnlogger::sacnlog::kNoOwner);
+            ++frameCount;
+        }
+        CHECK(frameCount == sacnlogger::SacnLogEncoder::kFramesPerBlock + 1);
+        REQUIRE(frame.levels.size() == 3);
+        CHECK(frame.owners[2] == sacnlogger::sacnlog::kUnknownOwner);
+        CHECK_FALSE(reader.next(frame));
+
+        const auto* source = reader.source(0);
+        REQUIRE(source != nullptr);
+        CHECK(source->cid == cid);
+        CHECK(source->abbreviation == "A");
+        CHECK(source->name == "Console");
+        CHECK(reader.source(1) == nullptr);
+
+        reader.rewind();
+        REQUIRE(reader.next(frame));
+        CHECK(frame.levels[0] == 0);
+    }
+
+    SECTION("Truncated")
+    {
+        std::filesystem::resize_file(path, std::filesystem::file_size(path) - 1);
+        sacnlogger::SacnLogReader reader(path);
+        sacnlogger::SacnLogReader::Frame frame;
+        unsigned int frameCount = 0;
+        while (reader.next(frame))
+        {
+            ++frameCount;
+        }
+        CHECK(frameCount == sacnlogger::SacnLogEncoder::kFramesPerBlock + 1);
+    }
+
+    SECTION("Damaged")
+    {
+        // The last block's owner column, zeroed as if it never reached the disk.
+        const auto size = std::filesystem::file_size(path);
+        std::filesystem::resize_file(path, size - 8);
+        std::filesystem::resize_file(path, size);
+        sacnlogger::SacnLogReader reader(path);
+        sacnlogger::SacnLogReader::Frame frame;
+        unsigned int frameCount = 0;
+        while (reader.next(frame))
+        {
+            ++frameCount;
+        }
+        CHECK(frameCount == sacnlogger::SacnLogEncoder::kFramesPerBlock + 1);
+    }
+
+    SECTION("Export")
+    {
+        sacnlogger::SacnLogReader reader(path);
+        std::stringstream out;
+        sacnlogger::exportCsv(reader, out);
+        const auto csv = out.str();
+        CHECK(csv.find(",\"001 Lvl\",\"001 Pri\",\"001 Src\",\"002 Lvl\",\"002 Pri\",\"002 Src\"\n") !=
+              std::string::npos);
+        CHECK(csv.find(",0,100,\"A\",0,0,\"-\"\n") != std::string::npos);
+        CHECK(csv.find(",\"003 Src\"\n") != std::string::npos);
+        CHECK(csv.ends_with(",0,0,\"?\"\n"));
+    }
+
+    SECTION("Compressed")
+    {
+        const auto contents = readFile(path);
+        std::vector<char> compressed;
+        sacnlogger::ZstdCompressor compressor;
+        compressor.compress(contents, compressed);
+        compressor.endFrame(compressed);
+        const auto compressedPath = tempDir.path / "U00001_data.sacnlog.zst";
+        {
+            std::ofstream file(compressedPath, std::ios::binary);
+            file.write(compressed.data(), static_cast<std::streamsize>(compressed.size()));
+        }
+
+        sacnlogger::SacnLogReader reader(compressedPath);
+        CHECK(reader.universe() == 1);
+        sacnlogger::SacnLogReader::Frame frame;
+        unsigned int frameCount = 0;
+        while (reader.next(frame))
+        {
+            ++frameCount;
+        }
+        CHECK(frameCount == sacnlogger::SacnLogEncoder::kFramesPerBlock + 2);
+        REQUIRE(reader.source(0) != nullptr);
+        CHECK(reader.source(0)->name == "Console");
+    }
+
+    SECTION("Not a sacnlog file")
+    {
+        {
+            std::ofstream other(tempDir.path / "other.csv");
+            other << "1,2,3\n";
+        }
+        CHECK_THROWS_AS(sacnlogger::SacnLogReader(tempDir.path / "other.csv"), sacnlogger::SacnLogException);
+        CHECK_THROWS_AS(sacnlogger::SacnLogReader(tempDir.path / "missing.sacnlog"), sacnlogger::SacnLogException);
+    }
+}
@@ -0,0 +1,171 @@
+/**
+ * @file SegmentCompressorTest.cpp
+ *
+ * @author Dan Keenan
+ * @date 10/17/26
+ * @copyright GPL-3.0-or-later
+ * Copyright (C) 2024-2026 Dan Keenan
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <catch2/catch_test_macros.hpp>
+#include <filesystem>
+#include <fmt/format.h>
+#include <fstream>
+#include "TempDir.h"
+#include "sacnloggerlib/LogWriter.h"
+#include "sacnloggerlib/SegmentCompressor.h"
+#include "sacnloggerlib/SegmentManifest.h"
+#include "sacnloggerlib/TimeIndex.h"
+#include "sacnloggerlib/ZstdStream.h"
+
+namespace
+{
+    std::string decompressed(const std::filesystem::path& path, std::uintmax_t offset = 0)
+    {
+        const auto contents = sacnlogger::decompressFile(path, offset);
+        return {contents.begin(), contents.end()};
+    }
+
+    std::string makeSegment(const std::filesystem::path& path)
+    {
+        std::string contents;
+        for (unsigned int line = 0; line < 1000; ++line)
+        {
+            contents += fmt::format("{},100,\"A\"\n", line);
+        }
+        std::ofstream(path, std::ios::binary) << contents;
+        return contents;
+    }
+
+    /**
+     * Only leftovers from compression start with a dot.
+     */
+    bool hasTempFiles(const std::filesystem::path& dir)
+    {
+        return std::ranges::any_of(std::filesystem::directory_iterator(dir), [](const auto& entry)
+                                   { return entry.path().filename().string().starts_with("."); });
+    }
+} // namespace
+
+TEST_CASE("Segment Compressor")
+{
+    const TempDir tempDir;
+    const auto path = tempDir.path / "U00001_data.000001.csv";
+
+    SECTION("Rotated logs")
+    {
+        const auto basePath = tempDir.path / "U00001_data.csv";
+        const auto time = spdlog::log_clock::now();
+        std::uintmax_t signalled = 0;
+        std::uintmax_t reclaimed;
+        {
+            const auto segmentCompressor = std::make_shared<sacnlogger::SegmentCompressor>(3, 0);
+            segmentCompressor->sigReclaimed.connect([&signalled](std::uintmax_t bytes) { signalled += bytes; });
+            {
+                sacnlogger::LogWriter writer(4, 4096, segmentCompressor);
+                auto stream = writer.openStream(basePath, 1024 * 1024, 2);
+                for (unsigned int line = 0; line < 1000; ++line)
+                {
+                    if (line == 500)
+                    {
+                        stream->markKeyframe(time);
+                    }
+                    stream->write(time, fmt::format("{},100,\"A\"", line));
+                }
+                stream->rotate();
+                stream->write(time, "current");
+            }
+            segmentCompressor->waitIdle();
+            reclaimed = segmentCompressor->reclaimedBytes();
+        }
+        CHECK(reclaimed > 0);
+        CHECK(signalled == reclaimed);
+        CHECK_FALSE(std::filesystem::exists(path));
+        CHECK_FALSE(std::filesystem::exists(sacnlogger::timeIndexPath(path)));
+        CHECK_FALSE(hasTempFiles(tempDir.path));
+        // The current segment is left alone.
+        CHECK(readFile(tempDir.path / "U00001_data.000002.csv").ends_with(",current\n"));
+
+        const auto compressedPath = tempDir.path / "U00001_data.000001.csv.zst";
+        const auto text = decompressed(compressedPath);
+        CHECK(text.ends_with(",999,100,\"A\"\n"));
+        CHECK(std::count(text.begin(), text.end(), '\n') == 1000);
+
+        // The index now points to frames in the compressed file.
+        const sacnlogger::TimeIndex index(compressedPath);
+        REQUIRE(index.entries().size() == 1);
+        const auto fromKeyframe = decompressed(compressedPath, index.entries()[0].offset);
+        CHECK(fromKeyframe.substr(fromKeyframe.find(',')).starts_with(",500,100,\"A\"\n"));
+
+        SECTION("Removing compressed logs")
+        {
+            {
+                sacnlogger::LogWriter writer(4, 4096, std::make_shared<sacnlogger::SegmentCompressor>(3, 0));
+                auto stream = writer.openStream(basePath, 1024 * 1024, 0);
+                stream->rotate();
+                stream->write(time, "next");
+            }
+            CHECK_FALSE(std::filesystem::exists(compressedPath));
+            CHECK_FALSE(std::filesystem::exists(sacnlogger::timeIndexPath(compressedPath)));
+            const sacnlogger::SegmentManifest manifest(basePath);
+            REQUIRE(manifest.segments().size() == 1);
+            CHECK(manifest.segments()[0].sequence == 3);
+        }
+    }
+
+    SECTION("Renamed while compressing")
+    {
+        const auto contents = makeSegment(path);
+        const auto renamedPath = tempDir.path / "U00001_data.000002.csv";
+        // Slow enough that the rename happens first.
+        sacnlogger::SegmentCompressor segmentCompressor(3, contents.size());
+        segmentCompressor.enqueue(path);
+        {
+            const std::scoped_lock lock(segmentCompressor.renameMutex());
+            std::filesystem::rename(path, renamedPath);
+        }
+        segmentCompressor.waitIdle();
+        CHECK_FALSE(std::filesystem::exists(renamedPath));
+        CHECK_FALSE(std::filesystem::exists(tempDir.path / "U00001_data.000001.csv.zst"));
+        CHECK(decompressed(tempDir.path / "U00001_data.000002.csv.zst") == contents);
+    }
+
+    SECTION("Removed while compressing")
+    {
+        const auto contents = makeSegment(path);
+        sacnlogger::SegmentCompressor segmentCompressor(3, contents.size());
+        segmentCompressor.enqueue(path);
+        {
+            const std::scoped_lock lock(segmentCompressor.renameMutex());
+            std::filesystem::remove(path);
+        }
+        segmentCompressor.waitIdle();
+        CHECK(segmentCompressor.reclaimedBytes() == 0);
+        CHECK(std::filesystem::is_empty(tempDir.path));
+    }
+
+    SECTION("Stopped")
+    {
+        const auto contents = makeSegment(path);
+        {
+            sacnlogger::SegmentCompressor segmentCompressor(3, 1024);
+            segmentCompressor.enqueue(path);
+        }
+        CHECK(readFile(path) == contents);
+        CHECK_FALSE(std::filesystem::exists(tempDir.path / "U00001_data.000001.csv.zst"));
+        CHECK_FALSE(hasTempFiles(tempDir.path));
+    }
+}
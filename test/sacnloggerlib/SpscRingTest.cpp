@@ -0,0 +1,84 @@
+/**
+ * @file SpscRingTest.cpp
+ *
+ * @author Dan Keenan
+ * @date 10/17/26
+ * @copyright GPL-3.0-or-later
+ * Copyright (C) 2024-2026 Dan Keenan
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <thread>
+#include "sacnloggerlib/SpscRing.h"
+
+TEST_CASE("SPSC Ring")
+{
+    sacnlogger::SpscRing<unsigned int> ring(3);
+    REQUIRE(ring.capacity() == 4);
+    CHECK(ring.front() == nullptr);
+
+    SECTION("Order and overruns")
+    {
+        for (unsigned int i = 0; i < 4; ++i)
+        {
+            auto* item = ring.beginPush();
+            REQUIRE(item != nullptr);
+            *item = i;
+            ring.commitPush();
+        }
+        CHECK(ring.occupancy() == 4);
+        CHECK(ring.beginPush() == nullptr);
+        CHECK(ring.overruns() == 1);
+
+        for (unsigned int i = 0; i < 4; ++i)
+        {
+            const auto* item = ring.front();
+            REQUIRE(item != nullptr);
+            CHECK(*item == i);
+            ring.pop();
+        }
+        CHECK(ring.front() == nullptr);
+        CHECK(ring.occupancy() == 0);
+        CHECK(ring.highWater() == 4);
+    }
+
+    SECTION("Threads")
+    {
+        static constexpr unsigned int kCount = 100000;
+        std::jthread producer(
+            [&ring]()
+            {
+                for (unsigned int i = 0; i < kCount;)
+                {
+                    if (auto* item = ring.beginPush())
+                    {
+                        *item = i++;
+                        ring.commitPush();
+                    }
+                }
+            });
+        unsigned int expected = 0;
+        while (expected < kCount)
+        {
+            if (const auto* item = ring.front())
+            {
+                REQUIRE(*item == expected);
+                ++expected;
+                ring.pop();
+            }
+        }
+        CHECK(ring.highWater() <= ring.capacity());
+    }
+}
@@ -0,0 +1,128 @@
+/**
+ * @file StagingAreaTest.cpp
+ *
+ * @author Dan Keenan
+ * @date 10/17/26
+ * @copyright GPL-3.0-or-later
+ * Copyright (C) 2024-2026 Dan Keenan
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include "TempDir.h"
+#include "sacnloggerlib/StagingArea.h"
+
+using namespace std::chrono_literals;
+
+namespace
+{
+    /**
+     * Append @p data to the staged file @p stagedPath, as a writer would.
+     */
+    void write(sacnlogger::StagingArea& stagingArea, const std::filesystem::path& stagedPath, const std::string& data)
+    {
+        stagingArea.reserve(data.size());
+        std::ofstream(stagedPath, std::ios::binary | std::ios::app) << data;
+    }
+} // namespace
+
+TEST_CASE("Staging Area")
+{
+    const TempDir tempDir;
+    const auto directory = tempDir.path / "staging";
+    const auto path = tempDir.path / "U00001_data.000001.csv";
+
+    SECTION("Flush")
+    {
+        sacnlogger::StagingArea stagingArea(directory, 1024 * 1024, 1h);
+        const auto stagedPath = stagingArea.stage(path, true);
+        CHECK(stagedPath.string().starts_with(directory.string()));
+        CHECK(std::filesystem::exists(path));
+        write(stagingArea, stagedPath, "1,2,3\n");
+        // Not old enough yet.
+        std::this_thread::sleep_for(50ms);
+        CHECK(readFile(path).empty());
+        stagingArea.flush();
+        CHECK(readFile(path) == "1,2,3\n");
+        CHECK(stagingArea.movedBytes() == 6);
+        // Still staged until it is finished.
+        CHECK(std::filesystem::exists(stagedPath));
+        write(stagingArea, stagedPath, "4,5,6\n");
+        stagingArea.finish(path);
+        bool moved = false;
+        stagingArea.whenMoved(path, [&moved]() { moved = true; });
+        stagingArea.flush();
+        CHECK(moved);
+        CHECK(readFile(path) == "1,2,3\n4,5,6\n");
+        CHECK(std::filesystem::is_empty(directory));
+    }
+
+    SECTION("Age")
+    {
+        sacnlogger::StagingArea stagingArea(directory, 1024 * 1024, 20ms);
+        const auto stagedPath = stagingArea.stage(path, true);
+        write(stagingArea, stagedPath, "1,2,3\n");
+        const auto start = std::chrono::steady_clock::now();
+        while (stagingArea.movedBytes() == 0 && std::chrono::steady_clock::now() - start < 5s)
+        {
+            std::this_thread::sleep_for(5ms);
+        }
+        CHECK(readFile(path) == "1,2,3\n");
+    }
+
+    SECTION("Size")
+    {
+        sacnlogger::StagingArea stagingArea(directory, 16, 1h);
+        const auto stagedPath = stagingArea.stage(path, true);
+        // Half full starts moving, and full waits for it.
+        write(stagingArea, stagedPath, "1,2,3,4,5\n");
+        write(stagingArea, stagedPath, "6,7,8,9,0\n");
+        CHECK(stagingArea.movedBytes() >= 10);
+    }
+
+    SECTION("Append")
+    {
+        std::ofstream(path) << "existing\n";
+        {
+            sacnlogger::StagingArea stagingArea(directory, 1024 * 1024, 1h);
+            const auto stagedPath = stagingArea.stage(path, false, 1024 * 1024);
+            CHECK(std::filesystem::file_size(stagedPath) == 9);
+            write(stagingArea, stagedPath, "1,2,3\n");
+            stagingArea.finish(path);
+        }
+        // Everything is moved when stopping, and the unused reserved space given back.
+        CHECK(readFile(path) == "existing\n1,2,3\n");
+        CHECK(std::filesystem::file_size(path) == 15);
+    }
+
+    SECTION("Recovery")
+    {
+        // Left from a crash: the first line had been moved, and punched out of the staged file.
+        std::ofstream(path) << "1,2,3\n";
+        const auto stagedPath = directory / std::filesystem::absolute(path).relative_path();
+        std::filesystem::create_directories(stagedPath.parent_path());
+        std::ofstream(stagedPath) << std::string(6, '\0') << "4,5,6\n";
+        // Removed since it was staged.
+        const auto removedPath = directory / std::filesystem::absolute(tempDir.path / "removed.csv").relative_path();
+        std::ofstream(removedPath) << "7,8,9\n";
+
+        const sacnlogger::StagingArea stagingArea(directory, 1024 * 1024, 1h);
+        CHECK(readFile(path) == "1,2,3\n4,5,6\n");
+        CHECK_FALSE(std::filesystem::exists(tempDir.path / "removed.csv"));
+        CHECK(std::filesystem::is_empty(directory));
+    }
+}
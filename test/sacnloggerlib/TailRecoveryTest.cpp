@@ -0,0 +1,172 @@
+/**
+ * @file TailRecoveryTest.cpp
+ *
+ * @author Dan Keenan
+ * @date 10/17/26
+ * @copyright GPL-3.0-or-later
+ * Copyright (C) 2024-2026 Dan Keenan
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <filesystem>
+#include <fstream>
+#include <sacn/cpp/common.h>
+#include "TempDir.h"
+#include "sacnloggerlib/Crc32c.h"
+#include "sacnloggerlib/LogWriter.h"
+#include "sacnloggerlib/SacnLogEncoder.h"
+#include "sacnloggerlib/SacnLogReader.h"
+#include "sacnloggerlib/SegmentManifest.h"
+#include "sacnloggerlib/TailRecovery.h"
+#include "sacnloggerlib/TimeIndex.h"
+
+namespace
+{
+    void appendFile(const std::filesystem::path& path, std::string_view contents)
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::app);
+        file.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+    }
+} // namespace
+
+TEST_CASE("CRC-32C")
+{
+    constexpr std::string_view kCheck = "123456789";
+    CHECK(sacnlogger::crc32c(kCheck.data(), kCheck.size()) == 0xE3069283);
+    CHECK(sacnlogger::crc32c(kCheck.data() + 4, kCheck.size() - 4, sacnlogger::crc32c(kCheck.data(), 4)) ==
+          0xE3069283);
+    CHECK(sacnlogger::crc32c(nullptr, 0) == 0);
+}
+
+TEST_CASE("Tail Recovery")
+{
+    const TempDir tempDir;
+    const auto time = spdlog::log_clock::now();
+
+    SECTION("Text")
+    {
+        const auto path = tempDir.path / "U00001_data.000001.csv";
+        appendFile(path, "one\ntwo\n");
+        CHECK(sacnlogger::recoverTail(path) == 0);
+        CHECK(readFile(path) == "one\ntwo\n");
+
+        appendFile(path, "thr");
+        CHECK(sacnlogger::recoverTail(path) == 3);
+        CHECK(readFile(path) == "one\ntwo\n");
+
+        // Zeros where data never made it to the disk, even with a newline after them.
+        appendFile(path, std::string("th\0\0\0\nfour", 10));
+        CHECK(sacnlogger::recoverTail(path) == 10);
+        CHECK(readFile(path) == "one\ntwo\n");
+
+        std::filesystem::resize_file(path, 0);
+        appendFile(path, "no newline");
+        CHECK(sacnlogger::recoverTail(path) == 10);
+        CHECK(readFile(path).empty());
+
+        CHECK(sacnlogger::recoverTail(tempDir.path / "missing.csv") == 0);
+    }
+
+    SECTION("Index")
+    {
+        const auto logPath = tempDir.path / "U00001_data.csv";
+        const auto path = sacnlogger::segmentPath(logPath, 1);
+        {
+            sacnlogger::LogWriter writer;
+            auto stream = writer.openStream(logPath, 1024 * 1024, 2);
+            stream->markKeyframe(time);
+            stream->write(time, "1");
+            stream->markKeyframe(time + std::chrono::seconds(1));
+            stream->write(time + std::chrono::seconds(1), "2");
+        }
+        REQUIRE(sacnlogger::TimeIndex(path).entries().size() == 2);
+        const auto keyframeOffset = sacnlogger::TimeIndex(path).entries().back().offset;
+        std::filesystem::resize_file(path, keyframeOffset + 4);
+
+        CHECK(sacnlogger::recoverTail(path) == 4);
+        CHECK(std::filesystem::file_size(path) == keyframeOffset);
+        CHECK(sacnlogger::TimeIndex(path).entries().size() == 1);
+    }
+
+    SECTION("SacnLog")
+    {
+        const auto logPath = tempDir.path / "U00001_data.sacnlog";
+        const auto path = sacnlogger::segmentPath(logPath, 1);
+        sacnlogger::ComparableData data;
+        data.owners_.fill(sacn::kInvalidRemoteSourceHandle);
+        {
+            sacnlogger::LogWriter writer;
+            auto stream = writer.openStream(logPath, 1024 * 1024, 2);
+            sacnlogger::SacnLogEncoder encoder(1);
+            for (unsigned int frame = 0; frame < 3; ++frame)
+            {
+                // Far enough apart for every block to be a keyframe.
+                const auto frameTime = time + frame * sacnlogger::SacnLogEncoder::kKeyframeInterval;
+                encoder.addFrame(*stream, frameTime, data, 2);
+                encoder.flush(*stream);
+            }
+        }
+        const auto size = std::filesystem::file_size(path);
+        CHECK(sacnlogger::TimeIndex(path).entries().size() == 3);
+        CHECK(sacnlogger::recoverTail(path) == 0);
+
+        const auto chunkSize = sizeof(sacnlogger::sacnlog::ChunkHeader) + sacnlogger::sacnlog::frameChunkSize(1, 2);
+        SECTION("Torn")
+        {
+            std::filesystem::resize_file(path, size - 1);
+            CHECK(sacnlogger::recoverTail(path) == chunkSize - 1);
+        }
+        SECTION("Damaged")
+        {
+            // Same size, but the end of the last block is zeros.
+            std::filesystem::resize_file(path, size - 8);
+            std::filesystem::resize_file(path, size);
+            CHECK(sacnlogger::recoverTail(path) == chunkSize);
+        }
+        CHECK(std::filesystem::file_size(path) == size - chunkSize);
+        CHECK(sacnlogger::TimeIndex(path).entries().size() == 2);
+
+        // Appending notes the recovery.
+        {
+            sacnlogger::LogWriter writer;
+            auto stream = writer.openStream(logPath, 1024 * 1024, 2);
+            CHECK(stream->takeRecoveredBytes() == 0);
+            sacnlogger::SacnLogEncoder encoder(1);
+            encoder.addFrame(*stream, time + std::chrono::minutes(1), data, 2);
+            encoder.flush(*stream);
+        }
+        sacnlogger::SacnLogReader reader(path);
+        sacnlogger::SacnLogReader::Frame frame;
+        unsigned int frameCount = 0;
+        while (reader.next(frame))
+        {
+            ++frameCount;
+        }
+        CHECK(frameCount == 3);
+    }
+
+    SECTION("Log Writer")
+    {
+        const auto logPath = tempDir.path / "U00001_data.csv";
+        const auto path = sacnlogger::segmentPath(logPath, 1);
+        appendFile(path, "one\ntw");
+        sacnlogger::LogWriter writer;
+        auto stream = writer.openStream(logPath, 1024 * 1024, 2);
+        CHECK(stream->takeRecoveredBytes() == 2);
+        CHECK(stream->takeRecoveredBytes() == 0);
+        CHECK(stream->wouldOverflow(1024 * 1024 - 3));
+        CHECK_FALSE(stream->wouldOverflow(1024 * 1024 - 4));
+    }
+}
@@ -0,0 +1,169 @@
+/**
+ * @file TriggerRulesTest.cpp
+ *
+ * @author Dan Keenan
+ * @date 10/17/26
+ * @copyright GPL-3.0-or-later
+ * Copyright (C) 2024-2026 Dan Keenan
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <catch2/catch_test_macros.hpp>
+#include <sacn/cpp/common.h>
+#include "sacnloggerlib/TriggerRules.h"
+
+using namespace std::chrono_literals;
+
+namespace
+{
+    /**
+     * Universe data as the flight recorder sees it, one change after another.
+     */
+    class Universe
+    {
+    public:
+        explicit Universe(sacnlogger::TriggerRules& rules) : rules_(rules)
+        {
+            current_.owners_.fill(sacn::kInvalidRemoteSourceHandle);
+        }
+
+        /**
+         * Check the rules against the current data, as received @p after the start.
+         */
+        std::optional<sacnlogger::TriggerRules::Capture> check(std::chrono::seconds after)
+        {
+            SacnRecvMergedData mergedData{};
+            mergedData.universe_id = 1;
+            mergedData.slot_range.start_address = 1;
+            mergedData.slot_range.address_count = addressCount_;
+            mergedData.levels = current_.levels_.data();
+            mergedData.priorities = current_.priorities_.data();
+            mergedData.owners = current_.owners_.data();
+            const auto r = rules_.checkFrame(kStart + after, previous_, mergedData, previous_.diff(mergedData));
+            previous_ = current_;
+            return r;
+        }
+
+        void setLevel(std::size_t address, uint8_t level) { current_.levels_[address - 1] = level; }
+        void setOwner(std::size_t address, sacn_remote_source_t owner) { current_.owners_[address - 1] = owner; }
+        /** Only send the first @p count addresses, which leaves the rest at 0 without an owner. */
+        void setAddressCount(uint16_t count)
+        {
+            addressCount_ = count;
+            std::fill(current_.levels_.begin() + count, current_.levels_.end(), 0);
+            std::fill(current_.owners_.begin() + count, current_.owners_.end(), sacn::kInvalidRemoteSourceHandle);
+        }
+
+        static inline const spdlog::log_clock::time_point kStart = spdlog::log_clock::now();
+
+    private:
+        sacnlogger::TriggerRules& rules_;
+        sacnlogger::ComparableData previous_;
+        sacnlogger::ComparableData current_;
+        uint16_t addressCount_ = SACN_MERGE_RECEIVER_MAX_SLOTS;
+    };
+} // namespace
+
+TEST_CASE("Trigger Rules")
+{
+    using sacnlogger::TriggerEvent;
+    const auto& start = Universe::kStart;
+
+    SECTION("Universe")
+    {
+        const sacnlogger::TriggerRules rules(3, {{.event = TriggerEvent::Level, .universe = 4, .address = 1},
+                                                 {.event = TriggerEvent::OwnerChange, .universe = 4}});
+        CHECK(rules.empty());
+        CHECK(rules.longestCapture() == 0s);
+        CHECK_FALSE(rules.checkSourceLost(start, "Console"));
+
+        const sacnlogger::TriggerRules anyUniverse(3, {{.event = TriggerEvent::SourceLost, .pre = 30, .post = 5}});
+        CHECK_FALSE(anyUniverse.empty());
+        CHECK(anyUniverse.longestCapture() == 35s);
+        CHECK(anyUniverse.checkSourceLost(start, "Console") ==
+              sacnlogger::TriggerRules::Capture{
+                  .reason = "Console lost", .at = start, .from = start - 30s, .until = start + 5s});
+    }
+
+    SECTION("Level")
+    {
+        sacnlogger::TriggerRules rules(1, {{.event = TriggerEvent::Level,
+                                            .universe = 1,
+                                            .address = 101,
+                                            .level = 0,
+                                            .pre = 30,
+                                            .post = 5}});
+        Universe universe(rules);
+        // Already at the level when logging starts.
+        CHECK_FALSE(universe.check(0s));
+        universe.setLevel(101, 255);
+        CHECK_FALSE(universe.check(1s));
+        universe.setLevel(1, 10);
+        CHECK_FALSE(universe.check(2s));
+        universe.setLevel(101, 0);
+        CHECK(universe.check(3s) == sacnlogger::TriggerRules::Capture{.reason = "address 101 went to 0",
+                                                                       .at = start + 3s,
+                                                                       .from = start - 27s,
+                                                                       .until = start + 8s});
+        // Staying at the level doesn't fire again.
+        universe.setLevel(1, 20);
+        CHECK_FALSE(universe.check(4s));
+    }
+
+    SECTION("Owner")
+    {
+        sacnlogger::TriggerRules rules(1, {{.event = TriggerEvent::OwnerChange, .address = 10, .pre = 10, .post = 1},
+                                           {.event = TriggerEvent::OwnerChange, .pre = 20, .post = 2}});
+        Universe universe(rules);
+        universe.setOwner(1, 7);
+        universe.setOwner(10, 7);
+        // Sources that are there when logging starts don't fire.
+        CHECK_FALSE(universe.check(0s));
+        universe.setLevel(10, 255);
+        CHECK_FALSE(universe.check(1s));
+
+        universe.setOwner(5, 8);
+        CHECK(universe.check(2s) ==
+              sacnlogger::TriggerRules::Capture{.reason = "owner of 1 addresses changed, starting at 5",
+                                                .at = start + 2s,
+                                                .from = start - 18s,
+                                                .until = start + 4s});
+
+        // Both rules fire, and the capture covers both.
+        universe.setOwner(10, 8);
+        universe.setOwner(11, 8);
+        CHECK(universe.check(3s) == sacnlogger::TriggerRules::Capture{.reason = "owner of address 10 changed",
+                                                                       .at = start + 3s,
+                                                                       .from = start - 17s,
+                                                                       .until = start + 5s});
+    }
+
+    SECTION("Owner Outside Range")
+    {
+        sacnlogger::TriggerRules rules(1, {{.event = TriggerEvent::OwnerChange, .address = 20, .pre = 10, .post = 1},
+                                           {.event = TriggerEvent::OwnerChange, .address = 30, .pre = 10, .post = 1}});
+        Universe universe(rules);
+        // Handle 0 is a real source.
+        universe.setOwner(20, 0);
+        universe.setLevel(30, 50);
+        CHECK_FALSE(universe.check(0s));
+
+        // Address 20 loses its owner, and address 30 never had one.
+        universe.setAddressCount(10);
+        const auto capture = universe.check(1s);
+        REQUIRE(capture);
+        CHECK(capture->reason == "owner of address 20 changed");
+    }
+}
@@ -0,0 +1,92 @@
+/**
+ * @file ZstdStreamTest.cpp
+ *
+ * @author Dan Keenan
+ * @date 10/17/26
+ * @copyright GPL-3.0-or-later
+ * Copyright (C) 2024-2026 Dan Keenan
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <fmt/format.h>
+#include <fstream>
+#include "TempDir.h"
+#include "sacnloggerlib/ZstdStream.h"
+
+TEST_CASE("Zstd Stream")
+{
+    const TempDir tempDir;
+    const auto path = tempDir.path / "test.zst";
+    std::string text;
+    for (unsigned int line = 0; line < 100000; ++line)
+    {
+        text += fmt::format("{},100,\"A\"\n", line % 256);
+    }
+
+    std::vector<char> compressed;
+    sacnlogger::ZstdCompressor compressor;
+    std::vector<std::size_t> flushedAt;
+    for (std::size_t pos = 0; pos < text.size(); pos += 4096)
+    {
+        compressor.compress(std::string_view(text).substr(pos, 4096), compressed);
+        flushedAt.push_back(compressed.size());
+    }
+    compressor.endFrame(compressed);
+    CHECK(compressed.size() * 10 < text.size());
+    // More than one frame.
+    const std::string_view kMagic("\x28\xB5\x2F\xFD", 4);
+    const std::string_view compressedView(compressed.data(), compressed.size());
+    CHECK(compressedView.find(kMagic, 1) != std::string_view::npos);
+
+    const auto writeFile = [&path](std::string_view contents)
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+    };
+    const auto decompressed = [&path]()
+    {
+        const auto r = sacnlogger::decompressFile(path);
+        return std::string(r.begin(), r.end());
+    };
+
+    SECTION("Round trip")
+    {
+        writeFile(compressedView);
+        CHECK(decompressed() == text);
+    }
+
+    SECTION("Cut short")
+    {
+        // Everything up to the last flush can be read.
+        writeFile(compressedView.substr(0, flushedAt[10] + 3));
+        const auto contents = decompressed();
+        CHECK(contents.size() >= 10 * 4096);
+        CHECK(text.starts_with(contents));
+    }
+
+    SECTION("Damaged")
+    {
+        auto damaged = compressed;
+        for (std::size_t pos = 100; pos < 200; ++pos)
+        {
+            damaged[pos] = 0;
+        }
+        writeFile({damaged.data(), damaged.size()});
+        // Reading starts again with the next frame.
+        const auto contents = decompressed();
+        CHECK(text.ends_with(contents.substr(contents.size() - 4096)));
+        CHECK(contents.size() < text.size());
+    }
+}